@@ -27,6 +27,7 @@
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
 #include "kernel/log.h"
+#include "kernel/coi.h"
 #include <string>
 
 USING_YOSYS_NAMESPACE
@@ -1229,10 +1230,18 @@ struct BtorBackend : public Backend {
 		log("  -s\n");
 		log("    Output only a single bad property for all asserts\n");
 		log("\n");
+		log("  -coi\n");
+		log("    Only output the sequential cone of influence of the selected $assert,\n");
+		log("    $assume, $cover, $live and $fair cells (see write_smt2 -coi)\n");
+		log("\n");
+		log("  -coi-map <filename>\n");
+		log("    Implies -coi. Write the list of kept and dropped cells and wires\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
 	{
-		bool verbose = false, single_bad = false;
+		bool verbose = false, single_bad = false, coimode = false;
+		std::string coi_map_file;
 
 		log_header(design, "Executing BTOR backend.\n");
 
@@ -1247,10 +1256,28 @@ struct BtorBackend : public Backend {
 				single_bad = true;
 				continue;
 			}
+			if (args[argidx] == "-coi") {
+				coimode = true;
+				continue;
+			}
+			if (args[argidx] == "-coi-map" && argidx+1 < args.size()) {
+				coimode = true;
+				coi_map_file = args[++argidx];
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
 
+		std::unique_ptr<CoiSlice> slice;
+		if (coimode) {
+			slice.reset(new CoiSlice(design));
+			slice->log_stats();
+			if (!coi_map_file.empty())
+				slice->write_map(coi_map_file);
+			design = slice->design;
+		}
+
 		RTLIL::Module *topmod = design->top_module();
 
 		if (topmod == nullptr)
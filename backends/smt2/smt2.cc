@@ -22,20 +22,85 @@
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
 #include "kernel/log.h"
+#include "kernel/coi.h"
+#include "passes/sat/sim_state_worker.h"
 #include <string>
 
+#ifndef _WIN32
+#  include <errno.h>
+#  include <unistd.h>
+#  include <poll.h>
+#  include <sys/wait.h>
+#endif
+
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
+// All SMT2 writers share one emitter. The encodings only differ in how the
+// next state and the state symbols are written.
+enum Smt2Encoding
+{
+	// |<mod>_t| equates the D inputs with the register values in next_state
+	SMT2_PLAIN,
+	// plain encoding with structural hashing and inlining (see -share), and
+	// the D inputs of $dff cells taken from the symbolic simulator
+	SMT2_SIMPLIFIED,
+	// next-state functions |<mod>_x <cell>| per register, used by |<mod>_t|
+	SMT2_DEFINE_NEXT,
+	// plain encoding where |<mod>_t| also holds the value of each undriven
+	// state bit (input) across the transition
+	SMT2_TRANS
+};
+
+// The Z3 simplifier may use internal operators (e.g. bvudiv_i) that are not
+// part of SMT-LIBv2 and can't be written to the output.
+static bool is_smtlib_expr(const z3::expr &expr)
+{
+	pool<int> seen;
+	std::vector<z3::expr> queue = {expr};
+	while (!queue.empty())
+	{
+		z3::expr e = queue.back();
+		queue.pop_back();
+		if (!seen.insert(e.id()).second || !e.is_app())
+			continue;
+		switch (e.decl().decl_kind()) {
+			case Z3_OP_BSDIV0: case Z3_OP_BUDIV0: case Z3_OP_BSREM0: case Z3_OP_BUREM0: case Z3_OP_BSMOD0:
+			case Z3_OP_BSDIV_I: case Z3_OP_BUDIV_I: case Z3_OP_BSREM_I: case Z3_OP_BUREM_I: case Z3_OP_BSMOD_I:
+				return false;
+			default:
+				break;
+		}
+		for (unsigned int i = 0; i < e.num_args(); i++)
+			queue.push_back(e.arg(i));
+	}
+	return true;
+}
+
 struct Smt2Worker
 {
 	CellTypes ct;
 	SigMap sigmap;
 	RTLIL::Module *module;
-	bool bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode;
+	bool bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, sharemode;
+	Smt2Encoding encoding;
 	dict<IdString, int> &mod_stbv_width;
 	int idcounter = 0, statebv_width = 0;
 
+	// -symbol: state bits of these wires are bound to global constants
+	// (only with -stbv), and the constants this module declares
+	dict<std::string, std::string> symbolic_names;
+	std::map<std::string, int> symbol_decls;
+
+	// undriven state bits
+	vector<SigBit> input_bits;
+
+	// -encoding simplified: the module settled by the symbolic simulator from
+	// a symbolic initial state, and the nets its initial values are named after
+	SimStateWorker *sim = nullptr;
+	dict<std::string, SigBit> sim_inputs;
+	int num_sim_regs = 0;
+
 	std::vector<std::string> decls, trans, hier, dtmembers;
 	std::map<RTLIL::SigBit, RTLIL::Cell*> bit_driver;
 	std::set<RTLIL::Cell*> exported_cells, hiercells, hiercells_queue;
@@ -49,6 +114,16 @@ struct Smt2Worker
 	std::map<int, int> bvsizes;
 	dict<IdString, char*> ids;
 
+	// -share: cell definitions by "<sort> <expr>", and the parts of their
+	// define-fun so that single-use definitions can be substituted later
+	struct def_t {
+		int decl_idx, depth;
+		std::string head, body, tail;
+	};
+	dict<std::string, int> def_cache;
+	std::map<int, def_t> defs;
+	int num_shared_defs = 0;
+
 	const char *get_id(IdString n)
 	{
 		if (ids.count(n) == 0) {
@@ -71,7 +146,16 @@ struct Smt2Worker
 	{
 		std::string decl_str;
 
-		if (statebv)
+		if (statebv && symbolic_names.count(comment))
+		{
+			std::string symbol = symbolic_names.at(comment);
+			symbol_decls[symbol] = width;
+			if (width == 0)
+				decl_str = stringf("(define-fun |%s| ((state |%s_s|)) Bool %s)", name.c_str(), get_id(module), symbol.c_str());
+			else
+				decl_str = stringf("(define-fun |%s| ((state |%s_s|)) (_ BitVec %d) %s)", name.c_str(), get_id(module), width, symbol.c_str());
+		}
+		else if (statebv)
 		{
 			if (width == 0) {
 				decl_str = stringf("(define-fun |%s| ((state |%s_s|)) Bool (= ((_ extract %d %d) state) #b1))", name.c_str(), get_id(module), statebv_width, statebv_width);
@@ -108,9 +192,12 @@ struct Smt2Worker
 	}
 
 	Smt2Worker(RTLIL::Module *module, bool bvmode, bool memmode, bool wiresmode, bool verbose, bool statebv, bool statedt, bool forallmode,
+			bool sharemode, Smt2Encoding encoding, const dict<std::string, std::string> &symbolic_names,
 			dict<IdString, int> &mod_stbv_width, dict<IdString, dict<IdString, pair<bool, bool>>> &mod_clk_cache) :
 			ct(module->design), sigmap(module), module(module), bvmode(bvmode), memmode(memmode), wiresmode(wiresmode),
-			verbose(verbose), statebv(statebv), statedt(statedt), forallmode(forallmode), mod_stbv_width(mod_stbv_width)
+			verbose(verbose), statebv(statebv), statedt(statedt), forallmode(forallmode),
+			sharemode(sharemode || encoding == SMT2_SIMPLIFIED), encoding(encoding), mod_stbv_width(mod_stbv_width),
+			symbolic_names(symbolic_names)
 	{
 		pool<SigBit> noclock;
 
@@ -202,6 +289,7 @@ struct Smt2Worker
 		for (auto &it : ids)
 			free(it.second);
 		ids.clear();
+		delete sim;
 	}
 
 	const char *get_id(Module *m)
@@ -274,6 +362,7 @@ struct Smt2Worker
 			if (verbose) log("%*s-> external bool: %s\n", 2+2*GetSize(recursive_cells), "",
 					log_signal(bit));
 			makebits(stringf("%s#%d", get_id(module), idcounter), 0, log_signal(bit));
+			input_bits.push_back(bit);
 			register_bool(bit, idcounter++);
 		}
 
@@ -349,6 +438,8 @@ struct Smt2Worker
 				log_assert(bit_driver.count(bit) == 0);
 			makebits(stringf("%s#%d", get_id(module), idcounter), j, log_signal(sig.extract(i, j)));
 			subexpr.push_back(stringf("(|%s#%d| %s)", get_id(module), idcounter, state_name));
+			for (auto bit : sig.extract(i, j))
+				input_bits.push_back(bit);
 			register_bv(sig.extract(i, j), idcounter++);
 		}
 
@@ -365,6 +456,128 @@ struct Smt2Worker
 		}
 	}
 
+	// Define the function for the output of a combinational cell. 'type' is
+	// 'g' for a Bool, 'b' for a Bool that drives the LSB of sig only, and 'v'
+	// for a BitVec. With -share an expression that already has a definition
+	// is not defined again, sig becomes an alias of the existing function.
+	void export_def(RTLIL::SigSpec sig, char type, const std::string &expr)
+	{
+		sigmap.apply(sig);
+		std::string sort = type == 'v' ? stringf("(_ BitVec %d)", GetSize(sig)) : "Bool";
+
+		if (sharemode)
+		{
+			std::string key = sort + " " + expr;
+			auto it = def_cache.find(key);
+			if (it != def_cache.end()) {
+				int id = it->second;
+				num_shared_defs++;
+				if (verbose) log("%*s-> shared with %s#%d: %s\n", 2+2*GetSize(recursive_cells), "",
+						get_id(module), id, log_signal(sig));
+				if (type == 'v') {
+					for (int i = 0; i < GetSize(sig); i++) {
+						log_assert(fcache.count(sig[i]) == 0);
+						fcache[sig[i]] = std::pair<int, int>(id, i);
+					}
+				} else if (type == 'b') {
+					register_boolvec(sig, id);
+				} else {
+					register_bool(sig.as_bit(), id);
+				}
+				return;
+			}
+			def_cache[key] = idcounter;
+
+			def_t &def = defs[idcounter];
+			def.decl_idx = GetSize(decls);
+			def.depth = 0;
+			def.head = stringf("(define-fun |%s#%d| ((state |%s_s|)) %s ", get_id(module), idcounter, get_id(module), sort.c_str());
+			def.body = expr;
+			def.tail = stringf(") ; %s\n", log_signal(sig));
+		}
+
+		decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) %s %s) ; %s\n",
+				get_id(module), idcounter, get_id(module), sort.c_str(), expr.c_str(), log_signal(sig)));
+
+		if (type == 'v')
+			register_bv(sig, idcounter++);
+		else if (type == 'b')
+			register_boolvec(sig, idcounter++);
+		else
+			register_bool(sig.as_bit(), idcounter++);
+	}
+
+	// Substitute the -share definitions that are used exactly once into
+	// their user. Definitions only reference earlier ones, so going through
+	// them in order moves whole single-fanout cones into one expression.
+	void inline_defs()
+	{
+		const int max_depth = 32;
+		std::string prefix = stringf("|%s#", get_id(module));
+
+		dict<int, int> num_refs;
+		// id -> (decl index, or -1-index for trans) of a reference with the
+		// current state as argument
+		dict<int, int> ref_loc;
+		dict<int, int> decl_def;
+		for (auto &it : defs)
+			decl_def[it.second.decl_idx] = it.first;
+
+		auto scan = [&](const std::string &str, int loc) {
+			for (size_t pos = str.find(prefix); pos != std::string::npos; pos = str.find(prefix, pos + 1)) {
+				size_t end = pos + prefix.size();
+				while (end < str.size() && isdigit(str[end]))
+					end++;
+				if (end == pos + prefix.size() || end >= str.size() || str[end] != '|')
+					continue;
+				if (pos >= 12 && str.compare(pos - 12, 12, "(define-fun ") == 0)
+					continue;
+				int id = atoi(str.c_str() + pos + prefix.size());
+				num_refs[id]++;
+				if (pos > 0 && str[pos-1] == '(' && str.compare(end, 8, "| state)") == 0)
+					ref_loc[id] = loc;
+			}
+		};
+		for (int i = 0; i < GetSize(decls); i++)
+			scan(decls[i], i);
+		for (int i = 0; i < GetSize(trans); i++)
+			scan(trans[i], -1-i);
+
+		int num_inlined = 0;
+		for (auto &it : defs)
+		{
+			int id = it.first;
+			def_t &def = it.second;
+			if (num_refs[id] != 1 || ref_loc.count(id) == 0 || def.depth >= max_depth)
+				continue;
+
+			std::string ref = stringf("(|%s#%d| state)", get_id(module), id);
+			int loc = ref_loc.at(id);
+			std::string *target;
+			if (loc >= 0 && decl_def.count(loc)) {
+				def_t &user = defs.at(decl_def.at(loc));
+				user.depth = max(user.depth, def.depth + 1);
+				target = &user.body;
+			} else {
+				target = loc >= 0 ? &decls[loc] : &trans[-1-loc];
+			}
+
+			size_t pos = target->find(ref);
+			log_assert(pos != std::string::npos);
+			target->replace(pos, ref.size(), def.body);
+			decls[def.decl_idx].clear();
+			def.decl_idx = -1;
+			num_inlined++;
+		}
+
+		for (auto &it : defs)
+			if (it.second.decl_idx >= 0)
+				decls[it.second.decl_idx] = it.second.head + it.second.body + it.second.tail;
+
+		if (verbose) log("=> %d cell definitions shared, %d of %d remaining ones inlined in %s.\n",
+				num_shared_defs, num_inlined, GetSize(defs), log_id(module));
+	}
+
 	void export_gate(RTLIL::Cell *cell, std::string expr)
 	{
 		RTLIL::SigBit bit = sigmap(cell->getPort("\\Y").as_bit());
@@ -382,9 +595,7 @@ struct Smt2Worker
 		if (verbose)
 			log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-		decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) Bool %s) ; %s\n",
-				get_id(module), idcounter, get_id(module), processed_expr.c_str(), log_signal(bit)));
-		register_bool(bit, idcounter++);
+		export_def(bit, 'g', processed_expr);
 		recursive_cells.erase(cell);
 	}
 
@@ -428,16 +639,7 @@ struct Smt2Worker
 		if (verbose)
 			log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-		if (type == 'b') {
-			decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) Bool %s) ; %s\n",
-					get_id(module), idcounter, get_id(module), processed_expr.c_str(), log_signal(sig_y)));
-			register_boolvec(sig_y, idcounter++);
-		} else {
-			decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) (_ BitVec %d) %s) ; %s\n",
-					get_id(module), idcounter, get_id(module), GetSize(sig_y), processed_expr.c_str(), log_signal(sig_y)));
-			register_bv(sig_y, idcounter++);
-		}
-
+		export_def(sig_y, type == 'b' ? 'b' : 'v', processed_expr);
 		recursive_cells.erase(cell);
 	}
 
@@ -459,12 +661,23 @@ struct Smt2Worker
 		if (verbose)
 			log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-		decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) Bool %s) ; %s\n",
-				get_id(module), idcounter, get_id(module), processed_expr.c_str(), log_signal(sig_y)));
-		register_boolvec(sig_y, idcounter++);
+		export_def(sig_y, 'b', processed_expr);
 		recursive_cells.erase(cell);
 	}
 
+	// With SMT2_DEFINE_NEXT the next value of a register gets its own
+	// function of the current state, otherwise expr_d is used directly.
+	std::string define_next(RTLIL::Cell *cell, const std::string &expr_d, const std::string &sort)
+	{
+		if (encoding != SMT2_DEFINE_NEXT)
+			return expr_d;
+
+		decls.push_back(stringf("(define-fun |%s_x %s| ((state |%s_s|)) %s %s) ; %s\n",
+				get_id(module), get_id(cell), get_id(module), sort.c_str(), expr_d.c_str(),
+				log_signal(cell->getPort("\\Q"))));
+		return stringf("(|%s_x %s| state)", get_id(module), get_id(cell));
+	}
+
 	void export_cell(RTLIL::Cell *cell)
 	{
 		if (verbose)
@@ -618,10 +831,7 @@ struct Smt2Worker
 				if (verbose)
 					log("%*s-> import cell: %s\n", 2+2*GetSize(recursive_cells), "", log_id(cell));
 
-				RTLIL::SigSpec sig = sigmap(cell->getPort("\\Y"));
-				decls.push_back(stringf("(define-fun |%s#%d| ((state |%s_s|)) (_ BitVec %d) %s) ; %s\n",
-						get_id(module), idcounter, get_id(module), width, processed_expr.c_str(), log_signal(sig)));
-				register_bv(sig, idcounter++);
+				export_def(cell->getPort("\\Y"), 'v', processed_expr);
 				recursive_cells.erase(cell);
 				return;
 			}
@@ -787,8 +997,104 @@ struct Smt2Worker
 				log_id(cell->type), log_id(module), log_id(cell));
 	}
 
+	// Settle the combinational logic of the module with the symbolic simulator,
+	// starting from a symbolic value for every net. Modules with cells that
+	// the simulator does not handle keep the plain encoding.
+	void setup_sim()
+	{
+		if (!bvmode)
+			return;
+
+		for (auto cell : module->cells()) {
+			// memories are not handled: the simulator would read their initial
+			// contents, not the contents in the current state
+			if (cell->type.in("$dff", "$assert", "$assume", "$cover"))
+				continue;
+			if (!yosys_celltypes.cell_evaluable(cell->type)) {
+				log("Not simplifying module %s, cell %s (%s) is not supported by the symbolic simulator.\n",
+						log_id(module), log_id(cell), log_id(cell->type));
+				return;
+			}
+		}
+
+		sim = new SimStateWorker;
+		SymSession::Scope scope(*sim->session);
+		sim->build(module);
+		for (auto cell : module->cells())
+			sim->top->dirty_cells.insert(cell);
+		sim->top->update_ph1();
+
+		for (auto &it : sim->top->init_state_nets)
+			sim_inputs[log_signal(it.first)] = it.first;
+	}
+
+	// The symbolic simulator term for the initial value of a net bit, as a
+	// 1-bit vector over the functions of this module.
+	z3::expr sim_bit(RTLIL::SigBit bit)
+	{
+		z3::context &ctx = sim->session->ctx;
+		get_bv(bit);
+		sigmap.apply(bit);
+		if (bit.wire == nullptr)
+			return ctx.bv_val(bit == RTLIL::State::S1 ? 1 : 0, 1);
+
+		auto f = fcache.at(bit);
+		z3::sort state_sort = ctx.uninterpreted_sort(stringf("%s_s", get_id(module)).c_str());
+		z3::expr state = ctx.constant("state", state_sort);
+		std::string name = stringf("%s#%d", get_id(module), f.first);
+		if (f.second < 0)
+			return z3::ite(ctx.function(name.c_str(), state_sort, ctx.bool_sort())(state), ctx.bv_val(1, 1), ctx.bv_val(0, 1));
+		return ctx.function(name.c_str(), state_sort, ctx.bv_sort(bvsizes.at(f.first)))(state).extract(f.second, f.second);
+	}
+
+	// The settled value of sig as an SMT2 expression in terms of state, or
+	// an empty string if it depends on something that is not a net of this
+	// module (e.g. a fresh symbol the simulator created for an x bit).
+	std::string sim_next(RTLIL::SigSpec sig)
+	{
+		SymSession::Scope scope(*sim->session);
+		z3::context &ctx = sim->session->ctx;
+		z3::expr value = sim->top->get_state(sig).to_expr();
+
+		z3::expr_vector src(ctx), dst(ctx);
+		pool<int> seen;
+		std::vector<z3::expr> queue = {value};
+		while (!queue.empty())
+		{
+			z3::expr e = queue.back();
+			queue.pop_back();
+			if (!seen.insert(e.id()).second)
+				continue;
+			if (!e.is_app())
+				return std::string();
+			if (e.num_args() == 0 && e.decl().decl_kind() == Z3_OP_UNINTERPRETED) {
+				auto it = sim_inputs.find(e.decl().name().str());
+				if (it == sim_inputs.end() || !e.is_bv() || e.get_sort().bv_size() != 1)
+					return std::string();
+				src.push_back(e);
+				dst.push_back(sim_bit(it->second));
+				continue;
+			}
+			for (unsigned int i = 0; i < e.num_args(); i++)
+				queue.push_back(e.arg(i));
+		}
+
+		if (!src.empty())
+			value = value.substitute(src, dst);
+
+		z3::expr simplified = value.simplify();
+		if (is_smtlib_expr(simplified))
+			return simplified.to_string();
+		if (is_smtlib_expr(value))
+			return value.to_string();
+		return std::string();
+	}
+
 	void run()
 	{
+		if (encoding == SMT2_SIMPLIFIED)
+			setup_sim();
+
 		if (verbose) log("=> export logic driving outputs\n");
 
 		pool<SigBit> reg_bits;
@@ -959,7 +1265,7 @@ struct Smt2Worker
 			{
 				if (cell->type.in("$_FF_", "$_DFF_P_", "$_DFF_N_"))
 				{
-					std::string expr_d = get_bool(cell->getPort("\\D"));
+					std::string expr_d = define_next(cell, get_bool(cell->getPort("\\D")), "Bool");
 					std::string expr_q = get_bool(cell->getPort("\\Q"), "next_state");
 					trans.push_back(stringf("  (= %s %s) ; %s %s\n", expr_d.c_str(), expr_q.c_str(), get_id(cell), log_signal(cell->getPort("\\Q"))));
 					ex_state_eq.push_back(stringf("(= %s %s)", get_bool(cell->getPort("\\Q")).c_str(), get_bool(cell->getPort("\\Q"), "other_state").c_str()));
@@ -967,7 +1273,14 @@ struct Smt2Worker
 
 				if (cell->type.in("$ff", "$dff"))
 				{
-					std::string expr_d = get_bv(cell->getPort("\\D"));
+					std::string expr_d;
+					if (sim != nullptr && cell->type == "$dff")
+						expr_d = sim_next(cell->getPort("\\D"));
+					if (expr_d.empty())
+						expr_d = get_bv(cell->getPort("\\D"));
+					else
+						num_sim_regs++;
+					expr_d = define_next(cell, expr_d, stringf("(_ BitVec %d)", GetSize(cell->getPort("\\D"))));
 					std::string expr_q = get_bv(cell->getPort("\\Q"), "next_state");
 					trans.push_back(stringf("  (= %s %s) ; %s %s\n", expr_d.c_str(), expr_q.c_str(), get_id(cell), log_signal(cell->getPort("\\Q"))));
 					ex_state_eq.push_back(stringf("(= %s %s)", get_bv(cell->getPort("\\Q")).c_str(), get_bv(cell->getPort("\\Q"), "other_state").c_str()));
@@ -1132,6 +1445,15 @@ struct Smt2Worker
 			}
 		}
 
+		if (sim != nullptr)
+			log("Took the next state of %d $dff cells in module %s from the symbolic simulator.\n",
+					num_sim_regs, log_id(module));
+
+		if (encoding == SMT2_TRANS)
+			for (auto bit : input_bits)
+				trans.push_back(stringf("  (= %s %s) ; auto_init ; %s\n", get_bool(bit).c_str(),
+						get_bool(bit, "next_state").c_str(), log_signal(bit)));
+
 		if (verbose) log("=> finalizing SMT2 representation of %s.\n", log_id(module));
 
 		for (auto c : hiercells) {
@@ -1212,6 +1534,9 @@ struct Smt2Worker
 		}
 		decls.push_back(stringf("(define-fun |%s_i| ((state |%s_s|)) Bool %s)\n",
 				get_id(module), get_id(module), init_expr.c_str()));
+
+		if (sharemode)
+			inline_defs();
 	}
 
 	void write(std::ostream &f)
@@ -1260,11 +1585,237 @@ struct Smt2Worker
 	}
 };
 
+static const char *encoding_name(Smt2Encoding encoding)
+{
+	switch (encoding) {
+		case SMT2_SIMPLIFIED: return "simplified";
+		case SMT2_DEFINE_NEXT: return "next";
+		case SMT2_TRANS: return "trans";
+		default: return "plain";
+	}
+}
+
+// Output of one Smt2Worker, kept until the modules are written in order
+struct Smt2Result
+{
+	std::string id, text;
+	int stbv_width = 0;
+	std::map<std::string, int> symbols;
+	dict<IdString, pair<bool, bool>> clocks;
+};
+
+// Emit the modules in child processes. The modules of one level of the
+// hierarchy only depend on lower levels (through the state widths and clock
+// flags of the modules they instantiate), so each level is split across up
+// to 'jobs' processes that send their results back through a pipe. If a
+// process fails, its modules are emitted again here so that the error is
+// reported as usual.
+static void emit_parallel(RTLIL::Design *design, const std::vector<RTLIL::Module*> &modules, int jobs,
+		const std::function<void(RTLIL::Module*, Smt2Result&)> &emit, dict<RTLIL::Module*, Smt2Result> &results,
+		dict<IdString, int> &mod_stbv_width, dict<IdString, dict<IdString, pair<bool, bool>>> &mod_clk_cache)
+{
+#ifdef _WIN32
+	log_warning("Option -j is not supported on Windows, emitting modules sequentially.\n");
+#else
+	dict<RTLIL::Module*, int> levels;
+	int max_level = 0;
+	for (auto module : modules) {
+		int level = 0;
+		for (auto cell : module->cells()) {
+			RTLIL::Module *child = design->module(cell->type);
+			if (child != nullptr && levels.count(child))
+				level = std::max(level, levels.at(child) + 1);
+		}
+		levels[module] = level;
+		max_level = std::max(max_level, level);
+	}
+
+	for (int level = 0; level <= max_level; level++)
+	{
+		std::vector<RTLIL::Module*> level_modules;
+		for (auto module : modules)
+			if (levels.at(module) == level) {
+				log("Creating SMT-LIBv2 representation of module %s.\n", log_id(module));
+				level_modules.push_back(module);
+			}
+
+		int nproc = std::min(jobs, GetSize(level_modules));
+		std::vector<pid_t> pids(nproc);
+		std::vector<int> fds(nproc);
+		std::vector<std::string> data(nproc);
+
+		log_flush();
+		for (int k = 0; k < nproc; k++)
+		{
+			int pipefd[2];
+			if (pipe(pipefd) != 0)
+				log_error("Can't create pipe: %s\n", strerror(errno));
+
+			pid_t pid = fork();
+			if (pid < 0)
+				log_error("Can't fork: %s\n", strerror(errno));
+
+			if (pid == 0) {
+				// a child that fails exits with a non-zero status, the parent
+				// then emits its modules again and reports the error. Nothing
+				// may unwind into the copy of the pass stack of the parent.
+				close(pipefd[0]);
+				log_files.clear();
+				log_streams.clear();
+				log_errfile = nullptr;
+				log_error_atexit = nullptr;
+
+				std::string buf;
+				try {
+					for (int i = k; i < GetSize(level_modules); i += nproc) {
+						Smt2Result result;
+						emit(level_modules[i], result);
+						buf += stringf("%d %d %d %d %d %s\n", i, result.stbv_width, GetSize(result.symbols),
+								GetSize(result.clocks), GetSize(result.text), result.id.c_str());
+						for (auto &it : result.symbols)
+							buf += stringf("%d %s\n", it.second, it.first.c_str());
+						for (auto &it : result.clocks)
+							buf += stringf("%d %d %s\n", it.second.first, it.second.second, it.first.c_str());
+						buf += result.text;
+					}
+				} catch (...) {
+					_exit(1);
+				}
+
+				for (size_t pos = 0; pos < buf.size();) {
+					ssize_t n = write(pipefd[1], buf.data() + pos, buf.size() - pos);
+					if (n < 0 && errno != EINTR)
+						_exit(1);
+					if (n > 0)
+						pos += n;
+				}
+				_exit(0);
+			}
+
+			close(pipefd[1]);
+			pids[k] = pid;
+			fds[k] = pipefd[0];
+		}
+
+		for (int open_fds = nproc; open_fds > 0;)
+		{
+			std::vector<pollfd> pfds;
+			std::vector<int> pfd_procs;
+			for (int k = 0; k < nproc; k++)
+				if (fds[k] >= 0) {
+					pfds.push_back(pollfd{fds[k], POLLIN, 0});
+					pfd_procs.push_back(k);
+				}
+
+			if (poll(pfds.data(), pfds.size(), -1) < 0) {
+				if (errno == EINTR)
+					continue;
+				log_error("poll() failed: %s\n", strerror(errno));
+			}
+
+			for (int i = 0; i < GetSize(pfds); i++) {
+				if (pfds[i].revents == 0)
+					continue;
+				int k = pfd_procs[i];
+				char buf[65536];
+				ssize_t n = read(fds[k], buf, sizeof(buf));
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n > 0) {
+					data[k].append(buf, n);
+					continue;
+				}
+				close(fds[k]);
+				fds[k] = -1;
+				open_fds--;
+			}
+		}
+
+		for (int k = 0; k < nproc; k++)
+		{
+			int status = 0;
+			while (waitpid(pids[k], &status, 0) < 0 && errno == EINTR) { }
+
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+				for (int i = k; i < GetSize(level_modules); i += nproc)
+					emit(level_modules[i], results[level_modules[i]]);
+				continue;
+			}
+
+			const std::string &d = data[k];
+			for (size_t pos = 0; pos < d.size();)
+			{
+				size_t eol = d.find('\n', pos);
+				int idx, stbv_width, num_symbols, num_clocks, text_len, id_offset;
+				if (eol == std::string::npos || sscanf(d.c_str() + pos, "%d %d %d %d %d %n",
+						&idx, &stbv_width, &num_symbols, &num_clocks, &text_len, &id_offset) != 5)
+					log_error("Malformed output from SMT2 worker process.\n");
+
+				Smt2Result &result = results[level_modules.at(idx)];
+				result.id = d.substr(pos + id_offset, eol - pos - id_offset);
+				result.stbv_width = stbv_width;
+				pos = eol + 1;
+
+				for (int i = 0; i < num_symbols; i++) {
+					eol = d.find('\n', pos);
+					size_t sep = d.find(' ', pos);
+					log_assert(eol != std::string::npos && sep < eol);
+					result.symbols[d.substr(sep + 1, eol - sep - 1)] = atoi(d.c_str() + pos);
+					pos = eol + 1;
+				}
+
+				for (int i = 0; i < num_clocks; i++) {
+					eol = d.find('\n', pos);
+					int posedge, negedge, name_offset;
+					log_assert(eol != std::string::npos && sscanf(d.c_str() + pos, "%d %d %n", &posedge, &negedge, &name_offset) == 2);
+					result.clocks[d.substr(pos + name_offset, eol - pos - name_offset)] = pair<bool, bool>(posedge, negedge);
+					pos = eol + 1;
+				}
+
+				result.text = d.substr(pos, text_len);
+				pos += text_len;
+			}
+
+			// the next level reads the state widths and clocks of this one
+			for (int i = k; i < GetSize(level_modules); i += nproc) {
+				Smt2Result &result = results.at(level_modules[i]);
+				mod_stbv_width[level_modules[i]->name] = result.stbv_width;
+				if (!result.clocks.empty())
+					mod_clk_cache[level_modules[i]->name] = result.clocks;
+			}
+		}
+	}
+#endif
+}
+
 struct Smt2Backend : public Backend {
-	Smt2Backend() : Backend("smt2", "write design to SMT-LIBv2 file") { }
+	Smt2Encoding default_encoding;
+	Smt2Backend(const char *name, Smt2Encoding default_encoding) :
+			Backend(name, "write design to SMT-LIBv2 file"), default_encoding(default_encoding) { }
 	void help() YS_OVERRIDE
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		if (default_encoding != SMT2_PLAIN) {
+			log("\n");
+			log("    %s [options] [filename]\n", pass_name.c_str());
+			log("\n");
+			log("This is an alias for 'write_smt2 -encoding %s'. See 'help write_smt2'.\n",
+					encoding_name(default_encoding));
+			log("\n");
+			if (default_encoding == SMT2_SIMPLIFIED) {
+				log("The options -clock <portname> and -clockn <portname> of the former\n");
+				log("stand-alone write_smt2-simplified are still accepted, but are ignored and\n");
+				log("will be removed in the future. The clocks are taken from the design.\n");
+				log("\n");
+			}
+			if (default_encoding == SMT2_TRANS) {
+				log("The option -autoinit of the former stand-alone write_smt2_trans is still\n");
+				log("accepted, but is ignored and will be removed in the future. The 'trans'\n");
+				log("encoding always keeps the values of undriven signals unchanged.\n");
+				log("\n");
+			}
+			return;
+		}
 		log("\n");
 		log("    write_smt2 [options] [filename]\n");
 		log("\n");
@@ -1339,6 +1890,49 @@ struct Smt2Backend : public Backend {
 		log("    -verbose\n");
 		log("        this will print the recursive walk used to export the modules.\n");
 		log("\n");
+		log("    -j <N>\n");
+		log("        Emit up to N modules at the same time in separate processes.\n");
+		log("        Modules are started in topological order, so with -stbv a module is\n");
+		log("        only emitted after the modules it instantiates. The output is the\n");
+		log("        same as without this option. Not available on Windows.\n");
+		log("\n");
+		log("    -share\n");
+		log("        Define cells that compute the same expression on the same signals\n");
+		log("        only once, and substitute definitions that are used only once into\n");
+		log("        their user instead of emitting a separate define-fun for them.\n");
+		log("\n");
+		log("    -encoding plain|simplified|next|trans\n");
+		log("        Select how the next state is encoded. 'plain' is the default.\n");
+		log("        'simplified' implies -share, and runs the symbolic simulator of\n");
+		log("        sim_state on each module from a symbolic initial state. The next\n");
+		log("        value of each $dff cell is then written as the settled value of its\n");
+		log("        D input in terms of the registers and inputs. Modules with cells the\n");
+		log("        simulator does not handle (e.g. memories) are written as with -share.\n");
+		log("        'next' adds a function |<mod>_x <cell>| with the next value of each\n");
+		log("        register, and |<mod>_t| compares the next state with it. 'trans'\n");
+		log("        additionally keeps the value of each undriven signal bit (input)\n");
+		log("        unchanged in |<mod>_t|, one equation per bit. The commands\n");
+		log("        write_smt2-simplified, write_smt2_next and write_smt2_trans select\n");
+		log("        the respective encoding by default.\n");
+		log("\n");
+		log("    -coi\n");
+		log("        Only write the sequential cone of influence of the selected $assert,\n");
+		log("        $assume, $cover, $live and $fair cells. Registers, memories and\n");
+		log("        logic that none of them depends on are left out. Unselected\n");
+		log("        properties are dropped. The names are not changed.\n");
+		log("\n");
+		log("    -coi-map <filename>\n");
+		log("        Implies -coi. List the cells and wires of the original design that\n");
+		log("        were kept and dropped in the given file.\n");
+		log("\n");
+		log("    -symbol <wire> <symbol>\n");
+		log("        In -stbv mode, bind the state bits of the given wire to a global\n");
+		log("        constant <symbol> instead of a slice of the state.\n");
+		log("\n");
+		log("    -symbolfile <filename>\n");
+		log("        Like -symbol for every wire named in the file, using the wire\n");
+		log("        name as symbol.\n");
+		log("\n");
 		log("    -stbv\n");
 		log("        Use a BitVec sort to represent a state instead of an uninterpreted\n");
 		log("        sort. As a side-effect this will prevent use of arrays to model\n");
@@ -1422,7 +2016,12 @@ struct Smt2Backend : public Backend {
 	{
 		std::ifstream template_f;
 		bool bvmode = true, memmode = true, wiresmode = false, verbose = false, statebv = false, statedt = false;
-		bool forallmode = false;
+		bool forallmode = false, sharemode = false;
+		Smt2Encoding encoding = default_encoding;
+		dict<std::string, std::string> symbolic_names;
+		int jobs = 1;
+		bool coimode = false;
+		std::string coi_map_file;
 
 		log_header(design, "Executing SMT2 backend.\n");
 
@@ -1439,6 +2038,15 @@ struct Smt2Backend : public Backend {
 				log_warning("Options -bv and -mem are now the default. Support for -bv and -mem will be removed in the future.\n");
 				continue;
 			}
+			if ((args[argidx] == "-clock" || args[argidx] == "-clockn") && argidx+1 < args.size()) {
+				log_warning("Option %s is ignored, the clocks are taken from the design. Support for -clock and -clockn will be removed in the future.\n", args[argidx].c_str());
+				argidx++;
+				continue;
+			}
+			if (args[argidx] == "-autoinit") {
+				log_warning("Option -autoinit is ignored, '-encoding trans' always keeps undriven signals unchanged. Support for -autoinit will be removed in the future.\n");
+				continue;
+			}
 			if (args[argidx] == "-stbv") {
 				statebv = true;
 				statedt = false;
@@ -1466,10 +2074,64 @@ struct Smt2Backend : public Backend {
 				verbose = true;
 				continue;
 			}
+			if (args[argidx] == "-share") {
+				sharemode = true;
+				continue;
+			}
+			if (args[argidx] == "-j" && argidx+1 < args.size()) {
+				jobs = std::max(1, atoi(args[++argidx].c_str()));
+				continue;
+			}
+			if (args[argidx] == "-encoding" && argidx+1 < args.size()) {
+				std::string name = args[++argidx];
+				if (name == "plain")
+					encoding = SMT2_PLAIN;
+				else if (name == "simplified")
+					encoding = SMT2_SIMPLIFIED;
+				else if (name == "next")
+					encoding = SMT2_DEFINE_NEXT;
+				else if (name == "trans")
+					encoding = SMT2_TRANS;
+				else
+					log_cmd_error("Unknown encoding `%s'.\n", name.c_str());
+				continue;
+			}
+			if (args[argidx] == "-symbol" && argidx+2 < args.size()) {
+				std::string wire_name = args[++argidx];
+				symbolic_names["\\" + wire_name] = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-coi") {
+				coimode = true;
+				continue;
+			}
+			if (args[argidx] == "-coi-map" && argidx+1 < args.size()) {
+				coimode = true;
+				coi_map_file = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-symbolfile" && argidx+1 < args.size()) {
+				std::ifstream sym_f(args[++argidx]);
+				if (sym_f.fail())
+					log_error("Can't open symbol file `%s'.\n", args[argidx].c_str());
+				std::string sym_name;
+				while (sym_f >> sym_name)
+					symbolic_names["\\" + sym_name] = sym_name;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
 
+		std::unique_ptr<CoiSlice> slice;
+		if (coimode) {
+			slice.reset(new CoiSlice(design));
+			slice->log_stats();
+			if (!coi_map_file.empty())
+				slice->write_map(coi_map_file);
+			design = slice->design;
+		}
+
 		if (template_f.is_open()) {
 			std::string line;
 			while (std::getline(template_f, line)) {
@@ -1527,6 +2189,7 @@ struct Smt2Backend : public Backend {
 
 		dict<IdString, int> mod_stbv_width;
 		dict<IdString, dict<IdString, pair<bool, bool>>> mod_clk_cache;
+		pool<std::string> declared_symbols;
 		Module *topmod = design->top_module();
 		std::string topmod_id;
 
@@ -1542,19 +2205,57 @@ struct Smt2Backend : public Backend {
 				log_error("Forall-exists problems are only supported in -stbv or -stdt mode.\n");
 		}
 
+		std::vector<RTLIL::Module*> emit_modules;
 		for (auto module : sorted_modules)
 		{
 			if (module->get_blackbox_attribute() || module->has_memories_warn() || module->has_processes_warn())
 				continue;
+			emit_modules.push_back(module);
+		}
 
-			log("Creating SMT-LIBv2 representation of module %s.\n", log_id(module));
-
-			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, mod_stbv_width, mod_clk_cache);
+		auto emit = [&](RTLIL::Module *module, Smt2Result &result)
+		{
+			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, sharemode,
+					encoding, symbolic_names, mod_stbv_width, mod_clk_cache);
 			worker.run();
-			worker.write(*f);
+
+			std::stringstream buf;
+			worker.write(buf);
+			result.id = worker.get_id(module);
+			result.stbv_width = worker.statebv_width;
+			result.symbols = worker.symbol_decls;
+			if (mod_clk_cache.count(module->name))
+				result.clocks = mod_clk_cache.at(module->name);
+			result.text = buf.str();
+		};
+
+		dict<RTLIL::Module*, Smt2Result> results;
+		if (jobs > 1)
+			emit_parallel(design, emit_modules, jobs, emit, results, mod_stbv_width, mod_clk_cache);
+
+		for (auto module : emit_modules)
+		{
+			Smt2Result result;
+			if (results.count(module)) {
+				std::swap(result, results.at(module));
+			} else {
+				log("Creating SMT-LIBv2 representation of module %s.\n", log_id(module));
+				emit(module, result);
+			}
+
+			for (auto &it : result.symbols) {
+				if (declared_symbols.count(it.first))
+					continue;
+				declared_symbols.insert(it.first);
+				if (it.second == 0)
+					*f << stringf("(declare-const %s Bool)\n", it.first.c_str());
+				else
+					*f << stringf("(declare-const %s (_ BitVec %d))\n", it.first.c_str(), it.second);
+			}
+			*f << result.text;
 
 			if (module == topmod)
-				topmod_id = worker.get_id(module);
+				topmod_id = result.id;
 		}
 
 		if (topmod)
@@ -1568,6 +2269,7 @@ struct Smt2Backend : public Backend {
 				*f << line << std::endl;
 		}
 	}
-} Smt2Backend;
+} Smt2Backend("smt2", SMT2_PLAIN), Smt2SimplifiedBackend("smt2-simplified", SMT2_SIMPLIFIED),
+		Smt2NextBackend("smt2_next", SMT2_DEFINE_NEXT), Smt2TransBackend("smt2_trans", SMT2_TRANS);
 
 PRIVATE_NAMESPACE_END
@@ -0,0 +1,315 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "backends/smt2/smt2_z3.h"
+#include "kernel/log.h"
+#include "kernel/register.h"
+#include "kernel/rtlil.h"
+#include <fstream>
+
+YOSYS_NAMESPACE_BEGIN
+PRIVATE_NAMESPACE_BEGIN
+
+// One unrolled time step: fresh copies of the state vectors of the module
+// and the step's instances of the assertions and assumptions.
+struct BmcFrame
+{
+	z3::expr_vector state;
+	z3::expr asserts, assumes;
+
+	BmcFrame(z3::context &ctx) : state(ctx), asserts(ctx.bool_val(true)), assumes(ctx.bool_val(true)) { }
+};
+
+struct Smt2BmcWorker
+{
+	z3::context &ctx;
+	Smt2Z3Trans &trans;
+	z3::solver solver;
+	std::vector<BmcFrame> frames;
+
+	// wires shown in the trace, and the clock edge of the clock inputs
+	std::vector<std::pair<RTLIL::Wire *, z3::expr>> trace_wires;
+	dict<RTLIL::Wire *, std::string> clock_edges;
+
+	Smt2BmcWorker(z3::context &ctx, Smt2Z3Trans &trans) : ctx(ctx), trans(trans), solver(ctx) { }
+
+	void setup_trace()
+	{
+		RTLIL::Module *module = trans.module;
+
+		// like write_smt2, an input that only drives the clock of registers
+		// is shown as a clock that ticks once per step
+		for (auto cell : module->cells()) {
+			if (!cell->type.in("$dff", "$_DFF_P_", "$_DFF_N_"))
+				continue;
+			// $dff names its clock port \CLK, the gates name it \C
+			RTLIL::IdString clk_port = cell->type == "$dff" ? "\\CLK" : "\\C";
+			RTLIL::SigSpec clk = trans.sigmap(cell->getPort(clk_port));
+			if (!clk.is_wire() || !clk.as_wire()->port_input)
+				continue;
+			bool posedge = cell->type == "$_DFF_P_" || (cell->type == "$dff" && cell->getParam("\\CLK_POLARITY").as_bool());
+			std::string &edge = clock_edges[clk.as_wire()];
+			if (!edge.empty() && edge != (posedge ? "posedge" : "negedge"))
+				edge = "event";
+			else
+				edge = posedge ? "posedge" : "negedge";
+		}
+
+		// build the terms before the first frame is created (exporting a wire
+		// can add state vectors for undriven bits), sorted by name like the nets
+		// in the traces of yosys-smtbmc
+		std::vector<std::pair<std::string, RTLIL::Wire *>> wires;
+		for (auto wire : module->wires())
+			if (wire->name[0] == '\\')
+				wires.push_back(std::make_pair(log_id(wire), wire));
+		std::sort(wires.begin(), wires.end());
+		for (auto &it : wires)
+			trace_wires.push_back(std::make_pair(it.second, trans.get_bv(it.second)));
+	}
+
+	z3::expr at(const z3::expr &e, int step)
+	{
+		const z3::expr_vector &st = frames.at(step).state;
+		return trans.instantiate(e, st, st);
+	}
+
+	void add_frame()
+	{
+		int step = GetSize(frames);
+		frames.push_back(BmcFrame(ctx));
+		BmcFrame &frame = frames.back();
+		for (unsigned i = 0; i < trans.state.size(); i++) {
+			std::string name = stringf("s%d %s", step, log_id(trans.state_wires.at(i)));
+			frame.state.push_back(ctx.bv_const(name.c_str(), trans.state[i].get_sort().bv_size()));
+		}
+		frame.asserts = at(trans.asserts, step);
+		frame.assumes = at(trans.assumes, step);
+
+		if (step == 0)
+			solver.add(at(trans.init, 0));
+		else
+			solver.add(trans.instantiate(trans.trans, frames[step - 1].state, frame.state));
+		solver.add(frame.assumes);
+	}
+
+	// Check whether the assertions of the step can fail. The solver keeps
+	// everything it learned for the next step, the failing assertions are
+	// only assumed for this check.
+	bool check_step(int step)
+	{
+		z3::expr fail = ctx.bool_const(stringf("fail %d", step).c_str());
+		solver.add(z3::implies(fail, !frames.at(step).asserts));
+		z3::expr_vector assumptions(ctx);
+		assumptions.push_back(fail);
+		z3::check_result res = solver.check(assumptions);
+		if (res == z3::unknown)
+			log_error("Solver returned unknown in step %d: %s\n", step, solver.reason_unknown().c_str());
+		if (res == z3::sat)
+			return false;
+
+		// later steps may assume that the assertions held here
+		solver.add(!fail);
+		solver.add(frames.at(step).asserts);
+		return true;
+	}
+
+	void report_failed(const z3::model &model, int step)
+	{
+		for (auto &it : trans.assert_list) {
+			z3::expr e = model.eval(at(it.second, step), true);
+			if (!e.is_true())
+				log("Assert failed in %s: %s%s%s\n", log_id(trans.module), log_id(it.first),
+						it.first->attributes.count("\\src") ? " at " : "", it.first->get_src_attribute().c_str());
+		}
+	}
+
+	std::string value(const z3::model &model, const z3::expr &e, int step)
+	{
+		z3::expr v = model.eval(at(e, step), true);
+		int width = e.get_sort().bv_size();
+		std::string bits;
+		if (!v.as_binary(bits))
+			bits = std::string(width, 'x');
+		if (GetSize(bits) < width)
+			bits = std::string(width - GetSize(bits), '0') + bits;
+		return bits;
+	}
+
+	static std::string vcd_name(std::string name)
+	{
+		if (name[0] == '$' || name.find(':') != std::string::npos)
+			return "\\" + name;
+		return name;
+	}
+
+	// Same layout as the traces written by yosys-smtbmc: step t is at time
+	// 10*t, clocks fall at 10*t-5 and rise again at 10*t.
+	void write_vcd(std::ostream &f, const z3::model &model, int num_steps)
+	{
+		f << "$version Generated by Yosys-SMTBMC $end\n";
+		f << "$timescale 1ns $end\n";
+		f << "$var integer 32 t smt_step $end\n";
+		f << "$var event 1 ! smt_clock $end\n";
+		f << stringf("$scope module %s $end\n", vcd_name(log_id(trans.module)).c_str());
+		for (int i = 0; i < GetSize(trace_wires); i++) {
+			RTLIL::Wire *wire = trace_wires[i].first;
+			bool event = clock_edges.count(wire) && clock_edges.at(wire) == "event";
+			f << stringf("$var %s %d n%d %s $end\n", event ? "event" : "wire", event ? 1 : wire->width, i, vcd_name(log_id(wire)).c_str());
+		}
+		f << "$upscope $end\n";
+		f << "$enddefinitions $end\n";
+
+		// the trace ends with the clock edge after the last step
+		for (int step = 0; step <= num_steps; step++) {
+			if (step > 0) {
+				f << stringf("#%d\n", 10 * step - 5);
+				for (int i = 0; i < GetSize(trace_wires); i++) {
+					RTLIL::Wire *wire = trace_wires[i].first;
+					if (!clock_edges.count(wire))
+						continue;
+					if (clock_edges.at(wire) == "posedge")
+						f << stringf("b0 n%d\n", i);
+					else if (clock_edges.at(wire) == "negedge")
+						f << stringf("b1 n%d\n", i);
+				}
+			}
+			f << stringf("#%d\n", 10 * step);
+			f << "1!\n";
+			f << "b" << RTLIL::Const(step, 32).as_string() << " t\n";
+			for (int i = 0; i < GetSize(trace_wires); i++) {
+				RTLIL::Wire *wire = trace_wires[i].first;
+				if (clock_edges.count(wire))
+					f << stringf("b%d n%d\n", clock_edges.at(wire) == "negedge" ? 0 : 1, i);
+				else if (step < num_steps)
+					f << stringf("b%s n%d\n", value(model, trace_wires[i].second, step).c_str(), i);
+			}
+		}
+	}
+};
+
+struct Smt2BmcPass : public Pass {
+	Smt2BmcPass() : Pass("smt2_bmc", "bounded model checking with an embedded solver") { }
+	void help() YS_OVERRIDE
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    smt2_bmc [options] [selection]\n");
+		log("\n");
+		log("Check the assertions of a module for the first N steps, like yosys-smtbmc\n");
+		log("does for a design written with write_smt2. The relations built by smt2_z3 are\n");
+		log("unrolled into one incremental Z3 solver in the same process. Each step adds\n");
+		log("one copy of the transition relation and the assumptions, so everything the\n");
+		log("solver learned for a shorter depth is reused for the next one. Assertions that\n");
+		log("passed are assumed in the later steps.\n");
+		log("\n");
+		log("The module must be flat and free of memories and processes, see smt2_z3. If\n");
+		log("more than one module is selected, the top module is checked.\n");
+		log("\n");
+		log("    -t <N>\n");
+		log("        check the steps 0 to N-1 (default: 20)\n");
+		log("\n");
+		log("    -dump-vcd <filename>\n");
+		log("        write the counterexample as VCD file, in the same format as\n");
+		log("        yosys-smtbmc --dump-vcd\n");
+		log("\n");
+		log("    -fail\n");
+		log("        stop with an error if an assertion can fail\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
+	{
+		int num_steps = 20;
+		std::string vcd_file;
+		bool fail_on_cex = false;
+
+		log_header(design, "Executing SMT2_BMC pass.\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-t" && argidx + 1 < args.size()) {
+				num_steps = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-dump-vcd" && argidx + 1 < args.size()) {
+				vcd_file = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-fail") {
+				fail_on_cex = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		RTLIL::Module *module = nullptr;
+		std::vector<RTLIL::Module *> modules = design->selected_modules();
+		if (GetSize(modules) == 1)
+			module = modules.front();
+		else if (design->top_module() && design->selected(design->top_module()))
+			module = design->top_module();
+		if (module == nullptr)
+			log_cmd_error("Select exactly one module or set a top module.\n");
+		if (num_steps < 1)
+			log_cmd_error("The number of steps must be at least 1.\n");
+
+		Smt2Z3Cache &cache = Smt2Z3Cache::global();
+		bool hit = false;
+		Smt2Z3Trans &trans = cache.get(module, &hit);
+		log("%s relations of module %s: %d state vectors, %d asserts.\n", hit ? "Reusing cached" : "Built",
+				log_id(module), GetSize(trans.state_wires), GetSize(trans.assert_list));
+
+		Smt2BmcWorker worker(cache.ctx, trans);
+		worker.setup_trace();
+
+		int failed_step = -1;
+		for (int step = 0; step < num_steps; step++) {
+			log("Checking assertions in step %d..\n", step);
+			worker.add_frame();
+			if (!worker.check_step(step)) {
+				failed_step = step;
+				break;
+			}
+		}
+
+		if (failed_step < 0) {
+			log("Status: PASSED (%d steps)\n", num_steps);
+			return;
+		}
+
+		log("BMC failed!\n");
+		z3::model model = worker.solver.get_model();
+		worker.report_failed(model, failed_step);
+
+		if (!vcd_file.empty()) {
+			log("Writing trace to VCD file: %s\n", vcd_file.c_str());
+			std::ofstream f(vcd_file.c_str());
+			if (f.fail())
+				log_error("Can't open file `%s' for writing.\n", vcd_file.c_str());
+			worker.write_vcd(f, model, failed_step + 1);
+		}
+
+		if (fail_on_cex)
+			log_error("Assertion failed in step %d.\n", failed_step);
+		log("Status: FAILED (step %d)\n", failed_step);
+	}
+} Smt2BmcPass;
+
+PRIVATE_NAMESPACE_END
+YOSYS_NAMESPACE_END
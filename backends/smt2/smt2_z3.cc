@@ -0,0 +1,618 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "backends/smt2/smt2_z3.h"
+#include "kernel/log.h"
+#include "kernel/register.h"
+#include "kernel/rtlil.h"
+#include <fstream>
+#include <sstream>
+
+#ifdef YOSYS_ENABLE_ZLIB
+#include <zlib.h>
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+static bool is_register(RTLIL::Cell *cell)
+{
+	return cell->type.in("$ff", "$dff", "$_FF_", "$_DFF_P_", "$_DFF_N_");
+}
+
+static bool is_state_cell(RTLIL::Cell *cell)
+{
+	return is_register(cell) || cell->type.in("$anyconst", "$anyseq", "$allconst", "$allseq", "$initstate");
+}
+
+static z3::expr conjunction(z3::context &ctx, const z3::expr_vector &v)
+{
+	if (v.empty())
+		return ctx.bool_val(true);
+	if (v.size() == 1)
+		return v[0];
+	return z3::mk_and(v);
+}
+
+// zero or sign extend (or truncate) a bit-vector term to the given width
+static z3::expr extend(const z3::expr &e, int width, bool is_signed)
+{
+	int w = e.get_sort().bv_size();
+	if (w == width)
+		return e;
+	if (w > width)
+		return e.extract(width - 1, 0);
+	return is_signed ? z3::sext(e, width - w) : z3::zext(e, width - w);
+}
+
+static z3::expr bool_to_bv(const z3::expr &e, int width)
+{
+	z3::context &ctx = e.ctx();
+	return z3::ite(e, ctx.bv_val(1, width), ctx.bv_val(0, width));
+}
+
+Smt2Z3Trans::Smt2Z3Trans(z3::context &ctx, RTLIL::Module *module) :
+		ctx(ctx), module(module), sigmap(module), state(ctx), next_state(ctx), trans(ctx.bool_val(true)),
+		init(ctx.bool_val(true)), asserts(ctx.bool_val(true)), assumes(ctx.bool_val(true)), srcs(ctx), done(false)
+{
+	ct.setup_internals();
+	ct.setup_stdcells();
+}
+
+int Smt2Z3Trans::state_var(RTLIL::Wire *wire)
+{
+	auto it = state_index.find(wire);
+	if (it != state_index.end())
+		return it->second;
+
+	int idx = GetSize(srcs);
+	std::string name = stringf("%s %s", log_id(module), log_id(wire));
+	state_wires.push_back(wire);
+	state.push_back(ctx.bv_const(name.c_str(), wire->width));
+	next_state.push_back(ctx.bv_const((name + "'").c_str(), wire->width));
+	srcs.push_back(state.back());
+	src_state.push_back(GetSize(state) - 1);
+	state_index[wire] = idx;
+	return idx;
+}
+
+void Smt2Z3Trans::register_bv(const RTLIL::SigSpec &sig, const z3::expr &e)
+{
+	RTLIL::SigSpec s = sigmap(sig);
+	log_assert(GetSize(s) == int(e.get_sort().bv_size()));
+	int idx = GetSize(srcs);
+	srcs.push_back(e);
+	src_state.push_back(-1);
+	for (int i = 0; i < GetSize(s); i++)
+		if (s[i].wire != nullptr)
+			bit_src[s[i]] = std::make_pair(idx, i);
+}
+
+z3::expr Smt2Z3Trans::get_bv(const RTLIL::SigSpec &sig_, bool next)
+{
+	RTLIL::SigSpec sig = sigmap(sig_);
+	log_assert(GetSize(sig) > 0);
+
+	// make sure every bit has a source before building the term, exporting
+	// a driver may add further entries to bit_src
+	for (auto bit : sig) {
+		if (bit.wire == nullptr || bit_src.count(bit))
+			continue;
+		auto it = bit_driver.find(bit);
+		if (it != bit_driver.end())
+			export_cell(it->second);
+		else
+			bit_src[bit] = std::make_pair(state_var(bit.wire), bit.offset);
+		log_assert(bit_src.count(bit));
+	}
+
+	z3::expr_vector pieces(ctx);
+	for (int i = 0; i < GetSize(sig);) {
+		if (sig[i].wire == nullptr) {
+			std::vector<bool> bits;
+			while (i < GetSize(sig) && sig[i].wire == nullptr)
+				bits.push_back(sig[i++].data == RTLIL::State::S1);
+			std::unique_ptr<bool[]> buf(new bool[bits.size()]);
+			for (size_t k = 0; k < bits.size(); k++)
+				buf[k] = bits[k];
+			pieces.push_back(ctx.bv_val(bits.size(), buf.get()));
+			continue;
+		}
+
+		// merge consecutive bits of the same source into one extract
+		std::pair<int, int> src = bit_src.at(sig[i]);
+		int j = i + 1;
+		while (j < GetSize(sig) && sig[j].wire != nullptr && bit_src.at(sig[j]) == std::make_pair(src.first, src.second + j - i))
+			j++;
+
+		int st = src_state[src.first];
+		z3::expr e = next && st >= 0 ? next_state[st] : srcs[src.first];
+		if (next && st < 0)
+			e = e.substitute(state, next_state);
+		if (src.second != 0 || j - i != int(e.get_sort().bv_size()))
+			e = e.extract(src.second + j - i - 1, src.second);
+		pieces.push_back(e);
+		i = j;
+	}
+
+	z3::expr result = pieces[0];
+	for (unsigned k = 1; k < pieces.size(); k++)
+		result = z3::concat(pieces[k], result);
+	return result;
+}
+
+z3::expr Smt2Z3Trans::get_bool(const RTLIL::SigSpec &sig, bool next)
+{
+	log_assert(GetSize(sig) == 1);
+	return get_bv(sig, next) == ctx.bv_val(1, 1);
+}
+
+z3::expr Smt2Z3Trans::port(RTLIL::Cell *cell, IdString name, int width, bool is_signed)
+{
+	return extend(get_bv(cell->getPort(name)), width, is_signed);
+}
+
+void Smt2Z3Trans::export_cell(RTLIL::Cell *cell)
+{
+	if (recursive_cells.count(cell))
+		log_error("Found logic loop in module %s! See cell %s.\n", log_id(module), log_id(cell));
+
+	recursive_cells.insert(cell);
+	z3::expr e = export_op(cell);
+	register_bv(cell->getPort("\\Y"), e);
+	recursive_cells.erase(cell);
+}
+
+z3::expr Smt2Z3Trans::export_op(RTLIL::Cell *cell)
+{
+	IdString type = cell->type;
+
+	if (type.in("$_BUF_", "$_NOT_", "$_AND_", "$_NAND_", "$_OR_", "$_NOR_", "$_XOR_", "$_XNOR_", "$_ANDNOT_", "$_ORNOT_",
+			"$_MUX_", "$_NMUX_", "$_AOI3_", "$_OAI3_", "$_AOI4_", "$_OAI4_")) {
+		auto in = [&](const char *name) { return get_bv(cell->getPort(name)); };
+		if (type == "$_BUF_")
+			return in("\\A");
+		if (type == "$_NOT_")
+			return ~in("\\A");
+		if (type == "$_AND_")
+			return in("\\A") & in("\\B");
+		if (type == "$_NAND_")
+			return ~(in("\\A") & in("\\B"));
+		if (type == "$_OR_")
+			return in("\\A") | in("\\B");
+		if (type == "$_NOR_")
+			return ~(in("\\A") | in("\\B"));
+		if (type == "$_XOR_")
+			return in("\\A") ^ in("\\B");
+		if (type == "$_XNOR_")
+			return ~(in("\\A") ^ in("\\B"));
+		if (type == "$_ANDNOT_")
+			return in("\\A") & ~in("\\B");
+		if (type == "$_ORNOT_")
+			return in("\\A") | ~in("\\B");
+		if (type == "$_MUX_")
+			return z3::ite(get_bool(cell->getPort("\\S")), in("\\B"), in("\\A"));
+		if (type == "$_NMUX_")
+			return ~z3::ite(get_bool(cell->getPort("\\S")), in("\\B"), in("\\A"));
+		if (type == "$_AOI3_")
+			return ~((in("\\A") & in("\\B")) | in("\\C"));
+		if (type == "$_OAI3_")
+			return ~((in("\\A") | in("\\B")) & in("\\C"));
+		if (type == "$_AOI4_")
+			return ~((in("\\A") & in("\\B")) | (in("\\C") & in("\\D")));
+		return ~((in("\\A") | in("\\B")) & (in("\\C") | in("\\D")));
+	}
+
+	int width = GetSize(cell->getPort("\\Y"));
+	bool is_signed = cell->hasParam("\\A_SIGNED") && cell->getParam("\\A_SIGNED").as_bool();
+	int a_width = cell->hasPort("\\A") ? GetSize(cell->getPort("\\A")) : 0;
+	int b_width = cell->hasPort("\\B") ? GetSize(cell->getPort("\\B")) : 0;
+
+	if (type.in("$and", "$or", "$xor", "$xnor", "$add", "$sub", "$mul")) {
+		z3::expr a = port(cell, "\\A", width, is_signed);
+		z3::expr b = port(cell, "\\B", width, is_signed);
+		if (type == "$and")
+			return a & b;
+		if (type == "$or")
+			return a | b;
+		if (type == "$xor")
+			return a ^ b;
+		if (type == "$xnor")
+			return ~(a ^ b);
+		if (type == "$add")
+			return a + b;
+		if (type == "$sub")
+			return a - b;
+		return a * b;
+	}
+
+	if (type.in("$not", "$pos", "$neg")) {
+		z3::expr a = port(cell, "\\A", width, is_signed);
+		if (type == "$not")
+			return ~a;
+		if (type == "$neg")
+			return -a;
+		return a;
+	}
+
+	if (type.in("$div", "$mod")) {
+		int w = std::max(width, std::max(a_width, b_width));
+		z3::expr a = port(cell, "\\A", w, is_signed);
+		z3::expr b = port(cell, "\\B", w, is_signed);
+		z3::expr y = type == "$div" ? (is_signed ? a / b : z3::udiv(a, b)) : (is_signed ? z3::srem(a, b) : z3::urem(a, b));
+		return extend(y, width, false);
+	}
+
+	if (type.in("$shl", "$shr", "$sshl", "$sshr", "$shift", "$shiftx")) {
+		// wide enough for the result, the operand and any shift amount
+		int w = std::max(width, std::max(a_width, b_width));
+		bool b_signed = type.in("$shift", "$shiftx") && cell->getParam("\\B_SIGNED").as_bool();
+		z3::expr a = port(cell, "\\A", w, is_signed);
+		z3::expr b = port(cell, "\\B", w, b_signed);
+		z3::expr y = a;
+		if (type.in("$shl", "$sshl"))
+			y = z3::shl(a, b);
+		else if (type == "$sshr" && is_signed)
+			y = z3::ashr(a, b);
+		else if (b_signed)
+			y = z3::ite(b >= 0, z3::lshr(a, b), z3::shl(a, -b));
+		else
+			y = z3::lshr(a, b);
+		return extend(y, width, false);
+	}
+
+	if (type.in("$lt", "$le", "$eq", "$ne", "$eqx", "$nex", "$ge", "$gt")) {
+		int w = std::max(a_width, b_width);
+		z3::expr a = port(cell, "\\A", w, is_signed);
+		z3::expr b = port(cell, "\\B", w, is_signed);
+		z3::expr y = ctx.bool_val(true);
+		if (type.in("$eq", "$eqx"))
+			y = a == b;
+		else if (type.in("$ne", "$nex"))
+			y = a != b;
+		else if (type == "$lt")
+			y = is_signed ? a < b : z3::ult(a, b);
+		else if (type == "$le")
+			y = is_signed ? a <= b : z3::ule(a, b);
+		else if (type == "$ge")
+			y = is_signed ? a >= b : z3::uge(a, b);
+		else
+			y = is_signed ? a > b : z3::ugt(a, b);
+		return bool_to_bv(y, width);
+	}
+
+	if (type.in("$reduce_and", "$reduce_or", "$reduce_bool", "$reduce_xor", "$reduce_xnor", "$logic_not")) {
+		z3::expr a = get_bv(cell->getPort("\\A"));
+		if (type == "$reduce_and")
+			return bool_to_bv(a == ctx.bv_val(-1, a_width), width);
+		if (type.in("$reduce_or", "$reduce_bool"))
+			return bool_to_bv(a != ctx.bv_val(0, a_width), width);
+		if (type == "$logic_not")
+			return bool_to_bv(a == ctx.bv_val(0, a_width), width);
+		z3::expr y = a.extract(0, 0);
+		for (int i = 1; i < a_width; i++)
+			y = y ^ a.extract(i, i);
+		if (type == "$reduce_xnor")
+			y = ~y;
+		return extend(y, width, false);
+	}
+
+	if (type.in("$logic_and", "$logic_or")) {
+		z3::expr a = get_bv(cell->getPort("\\A")) != ctx.bv_val(0, a_width);
+		z3::expr b = get_bv(cell->getPort("\\B")) != ctx.bv_val(0, b_width);
+		return bool_to_bv(type == "$logic_and" ? a && b : a || b, width);
+	}
+
+	if (type.in("$mux", "$pmux")) {
+		z3::expr y = get_bv(cell->getPort("\\A"));
+		RTLIL::SigSpec sig_b = cell->getPort("\\B");
+		RTLIL::SigSpec sig_s = cell->getPort("\\S");
+		for (int i = 0; i < GetSize(sig_s); i++)
+			y = z3::ite(get_bool(sig_s[i]), get_bv(sig_b.extract(i * width, width)), y);
+		return y;
+	}
+
+	if (type == "$slice") {
+		int offset = cell->getParam("\\OFFSET").as_int();
+		return get_bv(cell->getPort("\\A").extract(offset, width));
+	}
+
+	if (type == "$concat")
+		return z3::concat(get_bv(cell->getPort("\\B")), get_bv(cell->getPort("\\A")));
+
+	log_error("Unsupported cell type %s for cell %s.%s.\n", log_id(type), log_id(module), log_id(cell));
+}
+
+void Smt2Z3Trans::run()
+{
+	if (done)
+		return;
+	done = true;
+
+	if (module->has_memories() || module->has_processes())
+		log_error("Module %s contains memories or processes, run memory_map and proc first.\n", log_id(module));
+
+	for (auto cell : module->cells()) {
+		if (module->design && module->design->module(cell->type) != nullptr)
+			log_error("Module %s contains hierarchical cell %s, run flatten first.\n", log_id(module), log_id(cell));
+		if (is_state_cell(cell) || cell->type.in("$assert", "$assume", "$cover"))
+			continue;
+		if (!ct.cell_known(cell->type))
+			log_error("Unsupported cell type %s for cell %s.%s.\n", log_id(cell->type), log_id(module), log_id(cell));
+		for (auto &conn : cell->connections())
+			if (ct.cell_output(cell->type, conn.first))
+				for (auto bit : sigmap(conn.second))
+					if (bit.wire != nullptr)
+						bit_driver[bit] = cell;
+	}
+
+	z3::expr_vector trans_list(ctx), init_list(ctx), assert_exprs(ctx), assume_exprs(ctx);
+
+	for (auto cell : module->cells()) {
+		if (is_register(cell)) {
+			registers.insert(cell);
+			trans_list.push_back(get_bv(cell->getPort("\\Q"), true) == get_bv(cell->getPort("\\D")));
+		} else if (cell->type.in("$anyconst", "$allconst")) {
+			RTLIL::SigSpec sig_y = cell->getPort("\\Y");
+			trans_list.push_back(get_bv(sig_y, true) == get_bv(sig_y));
+		} else if (cell->type == "$initstate") {
+			RTLIL::SigSpec sig_y = cell->getPort("\\Y");
+			init_list.push_back(get_bool(sig_y));
+			trans_list.push_back(!get_bool(sig_y, true));
+		}
+	}
+
+	for (auto wire : module->wires()) {
+		if (!wire->attributes.count("\\init"))
+			continue;
+		RTLIL::SigSpec sig = sigmap(wire);
+		RTLIL::Const val = wire->attributes.at("\\init");
+		val.bits.resize(GetSize(sig), RTLIL::State::Sx);
+		RTLIL::Const mask(RTLIL::State::S1, GetSize(sig));
+		bool use_mask = false, any_defined = false;
+		for (int i = 0; i < GetSize(sig); i++)
+			if (val[i] != RTLIL::State::S0 && val[i] != RTLIL::State::S1) {
+				val[i] = RTLIL::State::S0;
+				mask[i] = RTLIL::State::S0;
+				use_mask = true;
+			} else
+				any_defined = true;
+		if (!any_defined)
+			continue;
+		z3::expr e = get_bv(sig);
+		z3::expr v = get_bv(val);
+		init_list.push_back(use_mask ? (e & get_bv(mask)) == v : e == v);
+	}
+
+	for (auto cell : module->cells()) {
+		if (!cell->type.in("$assert", "$assume"))
+			continue;
+		z3::expr e = get_bool(cell->getPort("\\A")) || !get_bool(cell->getPort("\\EN"));
+		if (cell->type == "$assert") {
+			assert_list.push_back(std::make_pair(cell, e));
+			assert_exprs.push_back(e);
+		} else
+			assume_exprs.push_back(e);
+	}
+
+	trans = conjunction(ctx, trans_list);
+	init = conjunction(ctx, init_list);
+	asserts = conjunction(ctx, assert_exprs);
+	assumes = conjunction(ctx, assume_exprs);
+}
+
+z3::expr Smt2Z3Trans::instantiate(const z3::expr &e, const z3::expr_vector &cur, const z3::expr_vector &nxt)
+{
+	z3::expr_vector from(ctx), to(ctx);
+	for (unsigned i = 0; i < state.size(); i++) {
+		from.push_back(state[i]);
+		to.push_back(cur[i]);
+		from.push_back(next_state[i]);
+		to.push_back(nxt[i]);
+	}
+	return z3::expr(e).substitute(from, to);
+}
+
+void Smt2Z3Trans::dump(std::ostream &f)
+{
+	std::string mod = log_id(module);
+	f << stringf("; yosys-smt2-module %s\n", mod.c_str());
+	for (unsigned i = 0; i < state.size(); i++) {
+		f << "(declare-const " << state[i] << " " << state[i].get_sort() << ")\n";
+		f << "(declare-const " << next_state[i] << " " << next_state[i].get_sort() << ")\n";
+	}
+	f << stringf("(define-fun |%s_t| () Bool\n", mod.c_str()) << trans << ")\n";
+	f << stringf("(define-fun |%s_i| () Bool\n", mod.c_str()) << init << ")\n";
+	f << stringf("(define-fun |%s_a| () Bool\n", mod.c_str()) << asserts << ")\n";
+	f << stringf("(define-fun |%s_u| () Bool\n", mod.c_str()) << assumes << ")\n";
+}
+
+unsigned int Smt2Z3Trans::fingerprint(RTLIL::Module *module)
+{
+	unsigned int h = mkhash_init;
+	for (auto wire : module->wires()) {
+		h = mkhash(h, wire->name.hash());
+		h = mkhash(h, wire->width);
+		if (wire->attributes.count("\\init"))
+			h = mkhash(h, wire->attributes.at("\\init").hash());
+	}
+	for (auto cell : module->cells()) {
+		h = mkhash(h, cell->name.hash());
+		h = mkhash(h, cell->type.hash());
+		for (auto &param : cell->parameters)
+			h = mkhash(h, mkhash(param.first.hash(), param.second.hash()));
+		for (auto &conn : cell->connections())
+			h = mkhash(h, mkhash(conn.first.hash(), conn.second.hash()));
+	}
+	for (auto &conn : module->connections())
+		h = mkhash(h, mkhash(conn.first.hash(), conn.second.hash()));
+	return h;
+}
+
+Smt2Z3Trans &Smt2Z3Cache::get(RTLIL::Module *module, bool *hit)
+{
+	unsigned int fp = Smt2Z3Trans::fingerprint(module);
+	auto it = entries.find(module->name);
+	if (it != entries.end() && it->second.first == fp && it->second.second->module == module) {
+		if (hit)
+			*hit = true;
+		return *it->second.second;
+	}
+
+	if (it != entries.end())
+		delete it->second.second;
+	Smt2Z3Trans *worker = new Smt2Z3Trans(ctx, module);
+	worker->run();
+	entries[module->name] = std::make_pair(fp, worker);
+	if (hit)
+		*hit = false;
+	return *worker;
+}
+
+void Smt2Z3Cache::clear()
+{
+	for (auto &it : entries)
+		delete it.second.second;
+	entries.clear();
+}
+
+Smt2Z3Cache &Smt2Z3Cache::global()
+{
+	static Smt2Z3Cache cache;
+	return cache;
+}
+
+PRIVATE_NAMESPACE_BEGIN
+
+struct Smt2Z3Pass : public Pass {
+	Smt2Z3Pass() : Pass("smt2_z3", "build the SMT2 transition relation in-process") { }
+	void help() YS_OVERRIDE
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    smt2_z3 [options] [selection]\n");
+		log("\n");
+		log("Build the relations exported by write_smt2_trans directly as Z3 terms, without\n");
+		log("writing SMT-LIBv2 text and parsing it again:\n");
+		log("\n");
+		log("    |<mod>_t|    transition relation (next register values)\n");
+		log("    |<mod>_i|    initial state (init attributes, $initstate)\n");
+		log("    |<mod>_a|    all $assert cells hold\n");
+		log("    |<mod>_u|    all $assume cells hold\n");
+		log("\n");
+		log("The state is represented by one bit-vector constant per wire that carries an\n");
+		log("input, register output or $anyconst/$anyseq value, and a primed copy of it\n");
+		log("for the next state. The modules must be flat and free of memories and\n");
+		log("processes. The relations are kept in memory, so later commands reuse them\n");
+		log("for modules that did not change.\n");
+		log("\n");
+		log("    -dump <filename>\n");
+		log("        write the relations as printed by Z3 to the given file. the file is\n");
+		log("        gzip-compressed if the name ends in '.gz'.\n");
+		log("\n");
+		log("    -check\n");
+		log("        check that init and assumptions are satisfiable and whether the\n");
+		log("        assertions hold in the initial state.\n");
+		log("\n");
+		log("    -clear\n");
+		log("        drop all cached relations.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
+	{
+		std::string dump_file;
+		bool check = false;
+
+		log_header(design, "Executing SMT2_Z3 pass.\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-dump" && argidx + 1 < args.size()) {
+				dump_file = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-check") {
+				check = true;
+				continue;
+			}
+			if (args[argidx] == "-clear") {
+				Smt2Z3Cache::global().clear();
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		std::stringstream dump_buf;
+		Smt2Z3Cache &cache = Smt2Z3Cache::global();
+
+		for (auto module : design->selected_modules()) {
+			if (module->get_bool_attribute("\\blackbox"))
+				continue;
+
+			bool hit = false;
+			Smt2Z3Trans &worker = cache.get(module, &hit);
+			log("%s relations of module %s: %d state vectors, %d asserts.\n", hit ? "Reusing cached" : "Built",
+					log_id(module), GetSize(worker.state_wires), GetSize(worker.assert_list));
+
+			if (check) {
+				z3::solver solver(cache.ctx);
+				solver.add(worker.init);
+				solver.add(worker.assumes);
+				if (solver.check() != z3::sat) {
+					log("  init and assumptions of %s are unsatisfiable.\n", log_id(module));
+				} else {
+					solver.add(!worker.asserts);
+					if (solver.check() == z3::sat)
+						log("  assertions of %s can fail in the initial state.\n", log_id(module));
+					else
+						log("  assertions of %s hold in the initial state.\n", log_id(module));
+				}
+			}
+
+			if (!dump_file.empty())
+				worker.dump(dump_buf);
+		}
+
+		if (dump_file.empty())
+			return;
+
+		std::string text = dump_buf.str();
+		if (dump_file.size() > 3 && dump_file.compare(dump_file.size() - 3, 3, ".gz") == 0) {
+#ifdef YOSYS_ENABLE_ZLIB
+			gzFile gz = gzopen(dump_file.c_str(), "wb");
+			if (gz == nullptr)
+				log_error("Can't open file `%s' for writing.\n", dump_file.c_str());
+			if (!text.empty() && gzwrite(gz, text.data(), text.size()) == 0)
+				log_error("Failed to write `%s'.\n", dump_file.c_str());
+			gzclose(gz);
+#else
+			log_error("Yosys was built without zlib, can't write `%s'.\n", dump_file.c_str());
+#endif
+		} else {
+			std::ofstream f(dump_file.c_str());
+			if (f.fail())
+				log_error("Can't open file `%s' for writing.\n", dump_file.c_str());
+			f << text;
+		}
+	}
+} Smt2Z3Pass;
+
+PRIVATE_NAMESPACE_END
+
+YOSYS_NAMESPACE_END
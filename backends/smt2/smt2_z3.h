@@ -0,0 +1,112 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SMT2_Z3_H
+#define SMT2_Z3_H
+
+#include "kernel/celltypes.h"
+#include "kernel/sigtools.h"
+#include "kernel/yosys.h"
+#include "z3++.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// In-memory counterpart of write_smt2_trans: the relations |<mod>_t|,
+// |<mod>_i|, |<mod>_a| and |<mod>_u| of a flat module built directly as Z3
+// terms, without printing and re-parsing SMT-LIBv2 text.
+//
+// There is no state sort. The state is the vector of free bit-vector
+// constants 'state', one per wire that carries an undriven bit (inputs,
+// register outputs, $anyconst/$anyseq and $initstate outputs). 'next_state'
+// holds the primed copy of each of them. The relations are Bool terms over
+// these constants:
+//
+//   trans    |<mod>_t|: next register values equal their D inputs
+//   init     |<mod>_i|: registers hold their init values
+//   asserts  |<mod>_a|: conjunction of all enabled $assert cells
+//   assumes  |<mod>_u|: conjunction of all enabled $assume cells
+//
+// Use instantiate() to rename the state vectors, e.g. to unroll the
+// transition relation for bounded model checking.
+struct Smt2Z3Trans
+{
+	z3::context &ctx;
+	RTLIL::Module *module;
+	SigMap sigmap;
+
+	std::vector<RTLIL::Wire *> state_wires;
+	z3::expr_vector state, next_state;
+	z3::expr trans, init, asserts, assumes;
+	std::vector<std::pair<RTLIL::Cell *, z3::expr>> assert_list;
+
+	Smt2Z3Trans(z3::context &ctx, RTLIL::Module *module);
+
+	// Build the relations. Hierarchical cells, memories, processes and
+	// asynchronous flip-flops are not supported and result in log_error().
+	void run();
+
+	// Value of a signal in the current (or next) state as a bit-vector term.
+	z3::expr get_bv(const RTLIL::SigSpec &sig, bool next = false);
+	z3::expr get_bool(const RTLIL::SigSpec &sig, bool next = false);
+
+	// Replace the state and next-state constants by the given vectors.
+	z3::expr instantiate(const z3::expr &e, const z3::expr_vector &cur, const z3::expr_vector &nxt);
+
+	// Write the relations as SMT-LIBv2 using the Z3 printer, with
+	// declare-const lines for the state vectors.
+	void dump(std::ostream &f);
+
+	// Fingerprint of everything the relations depend on, used by the cache
+	// to notice that a module was modified since it was built.
+	static unsigned int fingerprint(RTLIL::Module *module);
+
+private:
+	CellTypes ct;
+	dict<RTLIL::SigBit, RTLIL::Cell *> bit_driver;
+	dict<RTLIL::SigBit, std::pair<int, int>> bit_src;
+	z3::expr_vector srcs;
+	std::vector<int> src_state;
+	dict<RTLIL::Wire *, int> state_index;
+	pool<RTLIL::Cell *> registers, recursive_cells;
+	bool done;
+
+	int state_var(RTLIL::Wire *wire);
+	void register_bv(const RTLIL::SigSpec &sig, const z3::expr &e);
+	void export_cell(RTLIL::Cell *cell);
+	z3::expr export_op(RTLIL::Cell *cell);
+	z3::expr port(RTLIL::Cell *cell, IdString name, int width, bool is_signed);
+};
+
+// Relations built by the smt2_z3 pass are kept here, so later commands in
+// the same session reuse them as long as the module is unchanged.
+struct Smt2Z3Cache
+{
+	z3::context ctx;
+	dict<IdString, std::pair<unsigned int, Smt2Z3Trans *>> entries;
+
+	~Smt2Z3Cache() { clear(); }
+	Smt2Z3Trans &get(RTLIL::Module *module, bool *hit = nullptr);
+	void clear();
+
+	static Smt2Z3Cache &global();
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
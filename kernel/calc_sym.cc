@@ -28,148 +28,244 @@
 #include "z3.h"
 #include <string>
 YOSYS_NAMESPACE_BEGIN
-z3::context z3_context;
+
+static thread_local SymSession *current_session = nullptr;
+
+SymSession &SymSession::current() {
+  if (current_session != nullptr)
+    return *current_session;
+  static SymSession default_session;
+  return default_session;
+}
+
+SymSession::Scope::Scope(SymSession &session) : prev(current_session) {
+  current_session = &session;
+}
+
+SymSession::Scope::~Scope() { current_session = prev; }
+
+z3::expr SymSession::translate(const z3::expr &e) {
+  if (&e.ctx() == &ctx)
+    return e;
+  return z3::expr(ctx, Z3_translate(e.ctx(), e, ctx));
+}
+
+int SymSession::import(SymSession &from, int lit, dict<int, int> &cache) {
+  if (SymAig::lit_is_const(lit))
+    return lit;
+
+  // nodes of 'from' are topologically ordered, walk the cone with an
+  // explicit stack like SymAig::to_expr()
+  std::vector<int> stack;
+  stack.push_back(SymAig::lit_node(lit));
+  while (!stack.empty()) {
+    int idx = stack.back();
+    if (cache.count(idx)) {
+      stack.pop_back();
+      continue;
+    }
+    const SymAig::Node &n = from.aig.nodes[idx];
+    if (idx == 0) {
+      cache[idx] = SymAig::False;
+    } else if (n.a == -1) {
+      cache[idx] = aig.mk_leaf(translate(from.aig.leaves[n.b]));
+    } else if (n.a == -2) {
+      const SymAig::Slice &sl = from.aig.slices[n.b];
+      cache[idx] = aig.mk_slice(aig.mk_word(translate(from.aig.words[sl.word])),
+                                sl.bit);
+    } else {
+      int ia = SymAig::lit_node(n.a), ib = SymAig::lit_node(n.b);
+      if (!cache.count(ia) || !cache.count(ib)) {
+        if (!cache.count(ia))
+          stack.push_back(ia);
+        if (!cache.count(ib))
+          stack.push_back(ib);
+        continue;
+      }
+      cache[idx] = aig.mk_and(cache.at(ia) ^ (n.a & 1), cache.at(ib) ^ (n.b & 1));
+    }
+    stack.pop_back();
+  }
+  return cache.at(SymAig::lit_node(lit)) ^ (lit & 1);
+}
+
+RTLIL::SymConst SymSession::import(SymSession &from,
+                                   const RTLIL::SymConst &value,
+                                   dict<int, int> &cache) {
+  RTLIL::SymConst ret(value);
+  for (auto &b : ret.bits)
+    b.lit_ = import(from, b.lit_, cache);
+  return ret;
+}
 static z3::expr extend_u0(const z3::expr &e, unsigned width, bool is_signed) {
   unsigned old_width = e.is_bv() ? e.get_sort().bv_size() : 1;
-  if (width < old_width) {
-    std::cerr << width << "," << old_width << e << "\n";
-    return e.extract(width - 1, 0).simplify();
-  }
-  if (width - old_width == 0)
-    return e;
+  if (width < old_width)
+    return e.extract(width - 1, 0);
   z3::expr ee = e;
   if (!e.is_bv()) {
     assert(e.is_bool());
     ee = z3::ite(e, RTLIL::bit_val(1), RTLIL::bit_val(0));
   }
- std::cerr << "extend" << ee << "is_signed=" << is_signed
-            << ", width - old_width" << width - old_width;
-  z3::expr ret = is_signed ? z3::sext(ee, width - old_width).simplify()
-                           : z3::zext(ee, width - old_width).simplify();
-  //std::cerr << "return " << ret;
+  if (width == old_width)
+    return ee;
+  return is_signed ? z3::sext(ee, width - old_width)
+                   : z3::zext(ee, width - old_width);
+}
+
+// Bit-level counterpart of extend_u0() working on sym_aig literals. Bit-wise
+// operators are evaluated directly on the AIG and never touch Z3.
+static std::vector<int> extend_bits(const RTLIL::SymConst &arg, int width,
+                                    bool is_signed) {
+  std::vector<int> lits;
+  lits.reserve(width);
+  for (int i = 0; i < width && i < arg.size(); i++)
+    lits.push_back(arg[i].lit_);
+  int padding = is_signed && arg.size() > 0 ? arg.bits.back().lit_
+                                            : int(SymAig::False);
+  while (GetSize(lits) < width)
+    lits.push_back(padding);
+  return lits;
+}
+
+static RTLIL::SymConst from_lits(const std::vector<int> &lits) {
+  RTLIL::SymConst ret;
+  ret.bits.reserve(lits.size());
+  for (int lit : lits)
+    ret.bits.push_back(RTLIL::StateSym::from_lit(lit));
   return ret;
 }
 
+static int result_width(const RTLIL::SymConst &arg1,
+                        const RTLIL::SymConst &arg2, int result_len) {
+  return result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
+}
+
+static RTLIL::SymConst logic_wrapper(int (SymAig::*logic_func)(int, int),
+                                     const RTLIL::SymConst &arg1,
+                                     const RTLIL::SymConst &arg2, bool signed1,
+                                     bool signed2, int result_len) {
+  int width = result_width(arg1, arg2, result_len);
+  auto a = extend_bits(arg1, width, signed1);
+  auto b = extend_bits(arg2, width, signed2);
+  for (int i = 0; i < width; i++)
+    a[i] = (sym_aig().*logic_func)(a[i], b[i]);
+  return from_lits(a);
+}
+
+static int reduce_and_lit(const RTLIL::SymConst &arg) {
+  int lit = SymAig::True;
+  for (auto &b : arg.bits)
+    lit = sym_aig().mk_and(lit, b.lit_);
+  return lit;
+}
+
+static int reduce_or_lit(const RTLIL::SymConst &arg) {
+  int lit = SymAig::False;
+  for (auto &b : arg.bits)
+    lit = sym_aig().mk_or(lit, b.lit_);
+  return lit;
+}
+
+static int reduce_xor_lit(const RTLIL::SymConst &arg) {
+  int lit = SymAig::False;
+  for (auto &b : arg.bits)
+    lit = sym_aig().mk_xor(lit, b.lit_);
+  return lit;
+}
+
+static RTLIL::SymConst single_bit(int lit, int result_len) {
+  std::vector<int> lits(max(result_len, 1), SymAig::False);
+  lits[0] = lit;
+  return from_lits(lits);
+}
+
 RTLIL::SymConst RTLIL::SymConst_not(const RTLIL::SymConst &arg1,
                                     const RTLIL::SymConst &, bool signed1, bool,
                                     int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  return ~a;
+  if (result_len < 0)
+    result_len = arg1.size();
+  auto a = extend_bits(arg1, result_len, signed1);
+  for (auto &lit : a)
+    lit = SymAig::lit_not(lit);
+  return from_lits(a);
 }
 
 RTLIL::SymConst RTLIL::SymConst_and(const RTLIL::SymConst &arg1,
                                     const RTLIL::SymConst &arg2, bool signed1,
                                     bool signed2, int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  auto b = extend_u0(arg2.to_expr(), result_len, false);
-  return RTLIL::SymConst(a & b);
-  // return logic_wrapper(logic_and, arg1, arg2, signed1, signed2, result_len);
+  return logic_wrapper(&SymAig::mk_and, arg1, arg2, signed1, signed2,
+                       result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_or(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  auto b = extend_u0(arg2.to_expr(), result_len, false);
-  return  RTLIL::SymConst(a | b);
-  // return logic_wrapper(logic_or, arg1, arg2, signed1, signed2, result_len);
+  return logic_wrapper(&SymAig::mk_or, arg1, arg2, signed1, signed2,
+                       result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_xor(const RTLIL::SymConst &arg1,
                                     const RTLIL::SymConst &arg2, bool signed1,
                                     bool signed2, int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  auto b = extend_u0(arg2.to_expr(), result_len, false);
-  return RTLIL::SymConst(a ^ b);
-  // return logic_wrapper(logic_xor, arg1, arg2, signed1, signed2, result_len);
+  return logic_wrapper(&SymAig::mk_xor, arg1, arg2, signed1, signed2,
+                       result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_xnor(const RTLIL::SymConst &arg1,
                                      const RTLIL::SymConst &arg2, bool signed1,
                                      bool signed2, int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  auto b = extend_u0(arg2.to_expr(), result_len, false);
-  return RTLIL::SymConst(z3::xnor(a, b));
-  // return logic_wrapper(logic_xnor, arg1, arg2, signed1, signed2, result_len);
+  return logic_wrapper(&SymAig::mk_xnor, arg1, arg2, signed1, signed2,
+                       result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_reduce_and(const RTLIL::SymConst &arg1,
                                            const RTLIL::SymConst &, bool, bool,
                                            int result_len) {
-  return RTLIL::SymConst(z3::mk_and(arg1.bits));
-  //  return logic_reduce_wrapper(RTLIL::State::S1, logic_and, arg1,
-  //  result_len);
+  return single_bit(reduce_and_lit(arg1), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_reduce_or(const RTLIL::SymConst &arg1,
                                           const RTLIL::SymConst &, bool, bool,
                                           int result_len) {
-  return RTLIL::SymConst(z3::mk_or(arg1.bits));
+  return single_bit(reduce_or_lit(arg1), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_reduce_xor(const RTLIL::SymConst &arg1,
                                            const RTLIL::SymConst &, bool, bool,
                                            int result_len) {
-
-  size_t size = arg1.size();
-  assert(size > 0);
-  z3::expr e = arg1[0].to_expr();
-  for (size_t i = 1; i < size; ++i) {
-    e = (e ^ arg1[i].to_expr()).simplify();
-  }
-  return RTLIL::SymConst(e, 1);
+  return single_bit(reduce_xor_lit(arg1), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_reduce_xnor(const RTLIL::SymConst &arg1,
                                             const RTLIL::SymConst &, bool, bool,
                                             int result_len) {
-  size_t size = arg1.size();
-  assert(size > 0);
-  z3::expr e = arg1[0].to_expr();
-  for (size_t i = 1; i < size; ++i) {
-    e = z3::xnor(e, arg1[i].to_expr()).simplify();
-  }
-  return RTLIL::SymConst(e, 1);
+  return single_bit(SymAig::lit_not(reduce_xor_lit(arg1)), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_reduce_bool(const RTLIL::SymConst &arg1,
                                             const RTLIL::SymConst &, bool, bool,
                                             int result_len) {
-  size_t size = arg1.size();
-  assert(size > 0);
-  z3::expr e = arg1.bits[0];
-  for (size_t i = 1; i < size; ++i) {
-    e = (e | arg1[i].to_expr()).simplify();
-  }
-  return RTLIL::SymConst(e, 1);
+  return single_bit(reduce_or_lit(arg1), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_logic_not(const RTLIL::SymConst &arg1,
-                                          const RTLIL::SymConst &unused,
-                                          bool signed1, bool unused2,
+                                          const RTLIL::SymConst &, bool, bool,
                                           int result_len) {
-  RTLIL::SymConst result =
-      SymConst_reduce_bool(arg1, unused, signed1, unused2, result_len);
-  result.bits[0] = ~result.bits[0];
-  return result;
+  return single_bit(SymAig::lit_not(reduce_or_lit(arg1)), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_logic_and(const RTLIL::SymConst &arg1,
-                                          const RTLIL::SymConst &arg2,
-                                          bool signed1, bool signed2,
-                                          int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  auto b = extend_u0(arg2.to_expr(), result_len, false);
-  return RTLIL::SymConst(a & b);
+                                          const RTLIL::SymConst &arg2, bool,
+                                          bool, int result_len) {
+  return single_bit(sym_aig().mk_and(reduce_or_lit(arg1), reduce_or_lit(arg2)),
+                    result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_logic_or(const RTLIL::SymConst &arg1,
-                                         const RTLIL::SymConst &arg2,
-                                         bool signed1, bool signed2,
-                                         int result_len) {
-  auto a = extend_u0(arg1.to_expr(), result_len, false);
-  auto b = extend_u0(arg2.to_expr(), result_len, false);
-  return RTLIL::SymConst(a | b);
+                                         const RTLIL::SymConst &arg2, bool,
+                                         bool, int result_len) {
+  return single_bit(sym_aig().mk_or(reduce_or_lit(arg1), reduce_or_lit(arg2)),
+                    result_len);
 }
 
 static RTLIL::SymConst SymConst_shift_worker(const RTLIL::SymConst &arg1,
@@ -280,77 +376,84 @@ RTLIL::SymConst RTLIL::SymConst_shiftx(const RTLIL::SymConst &arg1,
                                RTLIL::State::Sx);
 }
 
+static RTLIL::SymConst compare_worker(const RTLIL::SymConst &arg1,
+                                      const RTLIL::SymConst &arg2,
+                                      bool is_signed, bool less, bool equal,
+                                      int result_len) {
+  int width = max(arg1.size(), arg2.size());
+  auto a = extend_u0(arg1.to_expr(), width, is_signed);
+  auto b = extend_u0(arg2.to_expr(), width, is_signed);
+  z3::expr cmp = is_signed ? (less ? (equal ? a <= b : a < b)
+                                   : (equal ? a >= b : a > b))
+                           : (less ? (equal ? z3::ule(a, b) : z3::ult(a, b))
+                                   : (equal ? z3::uge(a, b) : z3::ugt(a, b)));
+  return extend_u0(cmp, max(result_len, 1), false);
+}
+
 RTLIL::SymConst RTLIL::SymConst_lt(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return extend_u0(a < b, result_len, false);
+  return compare_worker(arg1, arg2, signed1 && signed2, true, false,
+                        result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_le(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return extend_u0(a <= b, result_len, false);
+  return compare_worker(arg1, arg2, signed1 && signed2, true, true,
+                        result_len);
+}
+
+static int equal_lit(const RTLIL::SymConst &arg1, const RTLIL::SymConst &arg2,
+                     bool is_signed) {
+  int width = max(arg1.size(), arg2.size());
+  auto a = extend_bits(arg1, width, is_signed);
+  auto b = extend_bits(arg2, width, is_signed);
+  int lit = SymAig::True;
+  for (int i = 0; i < width; i++)
+    lit = sym_aig().mk_and(lit, sym_aig().mk_xnor(a[i], b[i]));
+  return lit;
 }
 
 RTLIL::SymConst RTLIL::SymConst_eq(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, false);
-  auto b = extend_u0(arg2.to_expr(), width, false);
-  return (a == b);
+  return single_bit(equal_lit(arg1, arg2, signed1 && signed2), result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_ne(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return a != b;
+  return single_bit(SymAig::lit_not(equal_lit(arg1, arg2, signed1 && signed2)),
+                    result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_eqx(const RTLIL::SymConst &arg1,
                                     const RTLIL::SymConst &arg2, bool signed1,
                                     bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return a==b;
+  return SymConst_eq(arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_nex(const RTLIL::SymConst &arg1,
                                     const RTLIL::SymConst &arg2, bool signed1,
                                     bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return a != b;
+  return SymConst_ne(arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_ge(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return extend_u0(a >= b, result_len, false);
+  return compare_worker(arg1, arg2, signed1 && signed2, false, true,
+                        result_len);
 }
 
 RTLIL::SymConst RTLIL::SymConst_gt(const RTLIL::SymConst &arg1,
                                    const RTLIL::SymConst &arg2, bool signed1,
                                    bool signed2, int result_len) {
-  int width = result_len >= 0 ? result_len : max(arg1.size(), arg2.size());
-  auto a = extend_u0(arg1.to_expr(), width, signed1 && signed2);
-  auto b = extend_u0(arg2.to_expr(), width, signed1 && signed2);
-  return extend_u0(a > b, result_len, false);
+  return compare_worker(arg1, arg2, signed1 && signed2, false, false,
+                        result_len);
 }
+
 RTLIL::SymConst RTLIL::SymConst_add(const RTLIL::SymConst &arg1,
                                     const RTLIL::SymConst &arg2, bool signed1,
                                     bool signed2, int result_len) {
@@ -419,12 +522,12 @@ RTLIL::SymConst RTLIL::SymConst_neg(const RTLIL::SymConst &arg1,
 }
 
 RTLIL::SymConst::SymConst(std::string str, const RTLIL::SigSpec &_signal)
-    : type_(Type::Bit), bits(z3_context) {
+    : type_(Type::Bit) {
   flags = RTLIL::CONST_FLAG_STRING;
   for (int i = str.size() - 1; i >= 0; i--) {
     unsigned char ch = str[i];
     for (int j = 0; j < 8; j++) {
-      bits.push_back(bit_val((ch & 1) != 0));
+      bits.push_back((ch & 1) != 0 ? RTLIL::State::S1 : RTLIL::State::S0);
       ch = ch >> 1;
     }
   }
@@ -432,103 +535,201 @@ RTLIL::SymConst::SymConst(std::string str, const RTLIL::SigSpec &_signal)
 }
 
 RTLIL::SymConst::SymConst(int val, int width, const RTLIL::SigSpec &_signal)
-    : bits(z3_context) {
+    : type_(Type::Bit) {
   flags = RTLIL::CONST_FLAG_NONE;
   for (int i = 0; i < width; i++) {
-    bits.push_back(bit_val(val));
+    bits.push_back((val & 1) != 0 ? RTLIL::State::S1 : RTLIL::State::S0);
     val = val >> 1;
   }
   signal = _signal;
 }
 
+RTLIL::SymConst::SymConst(RTLIL::State bit, int width,
+                          const RTLIL::SigSpec &_signal)
+    : type_(Type::Bit) {
+  flags = RTLIL::CONST_FLAG_NONE;
+  // undefined bits become free symbols, named after the signal if known
+  bool named = _signal.size() == width;
+  for (int i = 0; i < width; i++)
+    bits.push_back(named ? RTLIL::StateSym(bit, _signal[i])
+                         : RTLIL::StateSym(bit));
+  signal = _signal;
+}
+
 RTLIL::SymConst::SymConst(RTLIL::StateSym bit, int width,
                           const RTLIL::SigSpec &_signal)
-    : bits(z3_context) {
-  // std::cerr << "creat sym const\n";
+    : type_(Type::Bit) {
   flags = RTLIL::CONST_FLAG_NONE;
-  assert(_signal.size() == width);
-  for (int i = 0; i < width; i++) {
-    if (_signal.size() == width) {
-      bit = RTLIL::StateSym(bit.to_state(), _signal[i]);
-    }
-    bits.push_back(bit.val_);
-  }
+  bool named = _signal.size() == width && !bit.is_const();
+  for (int i = 0; i < width; i++)
+    bits.push_back(named ? RTLIL::StateSym(RTLIL::State::Sx, _signal[i]) : bit);
   signal = _signal;
-  //  std::cerr << "end creat sym const\n";
 }
 
 RTLIL::SymConst::SymConst(const std::vector<bool> &vals,
                           const RTLIL::SigSpec &_signal)
-    : bits(z3_context) {
+    : type_(Type::Bit) {
   flags = RTLIL::CONST_FLAG_NONE;
-  for (auto v : vals) {
-    bits.push_back(bit_val(v));
-  }
+  for (auto v : vals)
+    bits.push_back(v ? RTLIL::State::S1 : RTLIL::State::S0);
   signal = _signal;
 }
-/*
-bool RTLIL::SymConst::operator<(const RTLIL::SymConst &other) const {
-  if (bits.size() != other.bits.size())
-    return bits.size() < other.bits.size();
-  for (size_t i = 0; i < bits.size(); i++)
-    if (bits[i] != other.bits[i])
-      return bits[i] < other.bits[i];
-  return false;
-}*/
+
+// Append the bits of a bit-vector term. Constants become constant literals,
+// concatenations and extracts are split into their operands and any other
+// term is kept whole as a word of the AIG, its bits are selected lazily.
+static void append_word_bits(std::vector<RTLIL::StateSym> &bits,
+                             const z3::expr &e) {
+  SymAig &aig = sym_aig();
+  int width = e.get_sort().bv_size();
+
+  if (e.is_numeral()) {
+    std::string msb_first;
+    e.as_binary(msb_first);
+    int n = GetSize(msb_first);
+    for (int i = 0; i < width; i++)
+      bits.push_back(RTLIL::StateSym::from_lit(
+          i < n && msb_first[n - 1 - i] == '1' ? SymAig::True
+                                                : SymAig::False));
+    return;
+  }
+
+  if (e.is_app() && e.decl().decl_kind() == Z3_OP_CONCAT) {
+    for (int k = e.num_args() - 1; k >= 0; k--)
+      append_word_bits(bits, e.arg(k));
+    return;
+  }
+
+  if (e.is_app() && e.decl().decl_kind() == Z3_OP_EXTRACT &&
+      !e.arg(0).is_numeral()) {
+    int word = aig.mk_word(e.arg(0));
+    for (int i = 0; i < width; i++)
+      bits.push_back(RTLIL::StateSym::from_lit(aig.mk_slice(word, e.lo() + i)));
+    return;
+  }
+
+  if (width == 1) {
+    bits.push_back(RTLIL::StateSym::from_lit(aig.from_expr(e)));
+    return;
+  }
+
+  int word = aig.mk_word(e);
+  for (int i = 0; i < width; i++)
+    bits.push_back(RTLIL::StateSym::from_lit(aig.mk_slice(word, i)));
+}
+
+RTLIL::SymConst::SymConst(const z3::expr &ee, int size)
+    : flags(RTLIL::CONST_FLAG_NONE), type_(Type::Bit) {
+  z3::expr e = ee.simplify();
+  if (e.is_bv()) {
+    log_assert(int(e.get_sort().bv_size()) == size);
+    bits.reserve(size);
+    append_word_bits(bits, e);
+  } else {
+    log_assert(size == 1);
+    bits.push_back(RTLIL::StateSym::from_lit(sym_aig().from_expr(e)));
+  }
+}
+
+z3::expr RTLIL::SymConst::to_expr() const {
+  log_assert(!bits.empty());
+  SymAig &aig = sym_aig();
+
+  std::vector<z3::expr> lsb_first;
+  int n = size();
+  for (int i = 0, j; i < n; i = j) {
+    int lit = bits[i].lit_;
+    j = i + 1;
+    if (aig.lit_is_slice(lit)) {
+      // a run of consecutive bits of one word, all with the same polarity
+      // ($not of a word gives complemented slices)
+      SymAig::Slice sl = aig.lit_slice(lit);
+      bool compl_run = SymAig::lit_is_compl(lit);
+      while (j < n && aig.lit_is_slice(bits[j].lit_) &&
+             SymAig::lit_is_compl(bits[j].lit_) == compl_run &&
+             aig.lit_slice(bits[j].lit_).word == sl.word &&
+             aig.lit_slice(bits[j].lit_).bit == sl.bit + (j - i))
+        j++;
+      z3::expr word = aig.words[sl.word];
+      if (sl.bit != 0 || j - i != aig.word_width(sl.word))
+        word = word.extract(sl.bit + (j - i) - 1, sl.bit);
+      lsb_first.push_back(compl_run ? ~word : word);
+    } else if (SymAig::lit_is_const(lit)) {
+      while (j < n && j - i < 64 && SymAig::lit_is_const(bits[j].lit_))
+        j++;
+      uint64_t val = 0;
+      for (int k = i; k < j; k++)
+        if (bits[k].lit_ == SymAig::True)
+          val |= uint64_t(1) << (k - i);
+      lsb_first.push_back(aig.ctx.bv_val(val, j - i));
+    } else {
+      lsb_first.push_back(aig.to_expr(lit));
+    }
+  }
+
+  if (lsb_first.size() == 1)
+    return lsb_first.front();
+  z3::expr_vector msb_first(aig.ctx);
+  for (auto it = lsb_first.rbegin(); it != lsb_first.rend(); ++it)
+    msb_first.push_back(*it);
+  return z3::concat(msb_first);
+}
+
+RTLIL::SymConst::SymConst(const z3::expr &e)
+    : SymConst(e, e.is_bv() ? e.get_sort().bv_size() : 1) {}
 
 bool RTLIL::SymConst::operator==(const RTLIL::SymConst &other) const {
-  return bits == other.bits;
+  if (bits.size() != other.bits.size())
+    return false;
+  for (size_t i = 0; i < bits.size(); i++)
+    if (bits[i].lit_ != other.bits[i].lit_)
+      return false;
+  return true;
 }
 
 bool RTLIL::SymConst::operator!=(const RTLIL::SymConst &other) const {
-  return bits != other.bits;
+  return !(*this == other);
 }
 
 bool RTLIL::SymConst::as_bool() const {
-  for (size_t i = 0; i < bits.size(); i++)
-    if (is_true(bits[i]))
+  for (auto &b : bits)
+    if (b.lit_ == SymAig::True)
       return true;
   return false;
 }
 
 int RTLIL::SymConst::as_int(bool is_signed) const {
-  z3::expr ret = z3_context.bv_val(0, 32);
+  int32_t ret = 0;
   for (size_t i = 0; i < bits.size() && i < 32; i++)
-    ret = (ret + (bits[i] << i)).simplify();
-  assert(ret.is_app());
+    if (bits[i].lit_ == SymAig::True)
+      ret |= 1 << i;
+  if (is_signed && bits.back().lit_ == SymAig::True)
+    for (size_t i = bits.size(); i < 32; i++)
+      ret |= 1 << i;
   return ret;
 }
 
 std::string RTLIL::SymConst::as_string() const {
-  return this->to_expr().to_string();
-  /*switch (type_) {
-  case Type::Bit:
-    for (size_t i = bits.size(); i > 0; i--)
-      ret += bits[i - 1].str();
-    return ret;
-  case Type::Add:
-    return stringf("(add %s %s)", operands_[0].as_string().c_str(),
-                   operands_[1].as_string().c_str());
-  default:
-    return "UNKNOWN";
-  }*/
+  if (bits.empty())
+    return "";
+  return this->to_expr().simplify().to_string();
 }
 
 RTLIL::SymConst RTLIL::SymConst::from_string(std::string str) {
-  z3::expr_vector bits(z3_context);
+  RTLIL::SymConst c;
   for (auto it = str.rbegin(); it != str.rend(); it++)
     switch (*it) {
     case '0':
-      bits.push_back(bit_val(0));
+      c.bits.push_back(RTLIL::State::S0);
       break;
     case '1':
-      bits.push_back(bit_val(1));
+      c.bits.push_back(RTLIL::State::S1);
       break;
     default:
-      bits.push_back(bit_const());
+      c.bits.push_back(RTLIL::State::Sx);
       break;
     }
-  return RTLIL::SymConst(bits);
+  return c;
 }
 
 std::string RTLIL::SymConst::decode_string() const {
@@ -549,46 +750,33 @@ std::string RTLIL::SymConst::decode_string() const {
 
 bool RTLIL::SymConst::is_fully_zero() const {
   cover("kernel.rtlil.const.is_fully_zero");
-  for (unsigned i = 0; i < size(); ++i) {
-    auto bit = bits[i];
-    if (is_false(bit.simplify()))
+  for (auto &b : bits)
+    if (b.lit_ != SymAig::False)
       return false;
-  }
   return true;
 }
 
 bool RTLIL::SymConst::is_fully_ones() const {
   cover("kernel.rtlil.const.is_fully_ones");
-
-  for (unsigned i = 0; i < size(); ++i) {
-    auto bit = bits[i];
-    if (is_true(bit.simplify()))
+  for (auto &b : bits)
+    if (b.lit_ != SymAig::True)
       return false;
-  }
-
   return true;
 }
 
 bool RTLIL::SymConst::is_fully_def() const {
   cover("kernel.rtlil.const.is_fully_def");
-
-  for (unsigned i = 0; i < size(); ++i) {
-    auto bit = bits[i];
-    if (!is_false(bit.simplify()) && !is_true(bit.simplify()))
+  for (auto &b : bits)
+    if (!b.is_const())
       return false;
-  }
-
   return true;
 }
 
 bool RTLIL::SymConst::is_fully_undef() const {
   cover("kernel.rtlil.const.is_fully_undef");
-
-  for (unsigned i = 0; i < size(); ++i) {
-    auto bit = bits[i];
-    if (is_false(bit.simplify()) || is_true(bit.simplify()))
+  for (auto &b : bits)
+    if (b.is_const())
       return false;
-  }
   return true;
 }
 
@@ -1,4 +1,5 @@
 #include "kernel/rtlil.h"
+#include "kernel/sym_aig.h"
 #include "kernel/yosys.h"
 #include "z3++.h"
 #include <assert.h>
@@ -7,51 +8,62 @@
 #define CAL_SYM_H
 
 YOSYS_NAMESPACE_BEGIN
-extern z3::context z3_context;
-static int name_index = 0;
 namespace RTLIL {
-class SymConst;
-static bool prove(const z3::expr &e) {
+struct SymConst;
+}
+
+// A symbolic simulation session owns the Z3 context, the AIG node table and
+// the counter used to name fresh symbols. StateSym/SymConst values are only
+// meaningful inside the session that created them. Operations on them use
+// the current session of the calling thread, which is a process-wide
+// default unless a SymSession::Scope selects another one. Each thread that
+// simulates in parallel must use its own session.
+struct SymSession {
+  z3::context ctx;
+  SymAig aig;
+  int name_index;
+
+  SymSession() : aig(ctx), name_index(0) {}
+  SymSession(const SymSession &) = delete;
+  SymSession &operator=(const SymSession &) = delete;
+
+  std::string fresh_name() { return stringf("auto#%d", name_index++); }
+
+  // Translation path between sessions: copy the cone of a literal (or the
+  // bits of a value) created in session 'from' into this session. 'cache'
+  // maps nodes of 'from' to literals of this session and can be shared by
+  // consecutive calls to translate larger states incrementally.
+  z3::expr translate(const z3::expr &e);
+  int import(SymSession &from, int lit, dict<int, int> &cache);
+  RTLIL::SymConst import(SymSession &from, const RTLIL::SymConst &value,
+                         dict<int, int> &cache);
+
+  static SymSession &current();
+
+  struct Scope {
+    SymSession *prev;
+    Scope(SymSession &session);
+    ~Scope();
+  };
+};
+
+static inline SymAig &sym_aig() { return SymSession::current().aig; }
+static inline z3::context &sym_context() { return SymSession::current().ctx; }
+
+namespace RTLIL {
+static inline bool prove(const z3::expr &e) {
   // log("prove\n");
   z3::context &c = e.ctx();
   z3::solver s(c);
   s.add(!e);
   return (s.check() == z3::unsat);
 }
-static z3::expr bit_const(const char *name) {
-  return z3_context.bv_const(name, 1);
-}
-static z3::expr bit_const() {
-  return z3_context.bv_const(stringf("auto#%d", name_index++).c_str(), 1);
-}
-static z3::expr bit_val(bool val) { return z3_context.bv_val(1, &val); }
-static bool is_false(z3::expr val) {
-  //  std::cerr << "is_f";
-  if (val.is_bv() && val.is_app() && val.is_numeral()) {
-    //    std::cerr << "is_ffinish";
-    return val.get_numeral_int() == 0;
-  }
-  //  std::cerr << "is_F finish";
-  return false;
-}
-static bool is_true(z3::expr val) {
-  bool ret = false;
-  //  std::cerr << "is_true";
-  if (val.is_bv() && val.is_app() && val.is_numeral()) {
-    //  std::cerr << "is_true finish1 " << val << "\n";
-    ret = val.get_numeral_int() == 1;
-    //  std::cerr << "is_true finish11";
-    return ret;
-  }
-  //  std::cerr << "is_true finish2";
-  return false;
+static inline z3::expr bit_val(bool val) {
+  return sym_context().bv_val(1, &val);
 }
 class StateSym {
   friend SymConst;
 
-private:
-  RTLIL::SigBit bit_;
-
 public:
   enum Type : unsigned char {
     Const = 0,
@@ -65,118 +77,82 @@ public:
     Eq = 8,
     Mux = 9
   };
-  z3::expr val_;
-  Type op_;
-  vector<StateSym> operands_;
-  void SetBit(const RTLIL::SigBit &b) {
-    bit_ = b;
-    if (op_ == Type::Sym) {
-      val_ = bit_const(log_signal(b));
-    }
-  }
-  std::string to_string() const { return val_.simplify().to_string(); }
-  const z3::expr &to_expr() const { return val_.simplify(); }
+  // literal in the AIG of the current SymSession
+  int lit_;
 
+  z3::expr to_expr() const { return sym_aig().to_expr(lit_); }
+  std::string to_string() const { return to_expr().simplify().to_string(); }
   std::string str() const { return to_string(); }
-  StateSym(const State &state, const SigBit &b) : val_(bit_val(0)) {
-    op_ = Type::Const;
+
+  StateSym(const State &state, const SigBit &b) {
     switch (state) {
     case RTLIL::State::S0:
     case RTLIL::State::S1:
-      op_ = Type::Const;
-      val_ = bit_val(state == RTLIL::State::S1);
+      lit_ = state == RTLIL::State::S1 ? SymAig::True : SymAig::False;
       break;
     default:
-      op_ = Type::Sym;
-      val_ = bit_const(log_signal(b));
+      lit_ = sym_aig().mk_input(log_signal(b));
       break;
     }
   }
-  StateSym(const z3::expr &e) : val_(bit_val(0)) {
-    assert(e.get_sort().bv_size() == 1);
-    val_ = e;
-  }
-  StateSym(const State &state) : val_(bit_val(0)) {
-    SigBit b;
-    op_ = Type::Const;
+  StateSym(const z3::expr &e) : lit_(sym_aig().from_expr(e)) {}
+  StateSym(const State &state) {
     switch (state) {
     case RTLIL::State::S0:
     case RTLIL::State::S1:
-      op_ = Type::Const;
-      val_ = bit_val(state == RTLIL::State::S1);
+      lit_ = state == RTLIL::State::S1 ? SymAig::True : SymAig::False;
       break;
     default:
-      op_ = Type::Sym;
-      val_ = bit_const(stringf("auto#%d", name_index++).c_str());
+      lit_ = sym_aig().mk_input(SymSession::current().fresh_name());
       break;
     }
   }
-  StateSym(const StateSym &state) : val_(bit_val(0)) {
-    op_ = state.op_;
-    val_ = state.val_;
-    operands_ = state.operands_;
-    bit_ = state.bit_;
+  StateSym(const StateSym &state) : lit_(state.lit_) {}
+  StateSym() : lit_(sym_aig().mk_input(SymSession::current().fresh_name())) {}
+  static StateSym from_lit(int lit) {
+    StateSym s(State::S0);
+    s.lit_ = lit;
+    return s;
   }
-  StateSym() : val_(bit_val(0)) {
-    op_ = Type::Sym;
-    val_ = bit_const(stringf("auto#%d", name_index++).c_str());
+  StateSym &operator=(const StateSym &other) {
+    lit_ = other.lit_;
+    return *this;
   }
+
   static StateSym CreateStateSymByOp(Type op, const vector<StateSym> &a) {
-    /*std::cerr << stringf("add op %d", op);
-    for (auto aa : a) {
-      std::cerr << stringf(" %s", aa.val_.to_string().c_str());
-    }*/
-    StateSym state_sym;
-    // state_sym.op_ = op;
-    state_sym.operands_ = a;
-    switch (state_sym.op_) {
+    switch (op) {
     case Type::And:
-      assert(a.size() == 2);
-      state_sym.val_ = a[0].val_ & a[1].val_;
-      break;
+      log_assert(a.size() == 2);
+      return from_lit(sym_aig().mk_and(a[0].lit_, a[1].lit_));
     case Type::Or:
-      assert(a.size() == 2);
-      state_sym.val_ = a[0].val_ | a[1].val_;
-      break;
+      log_assert(a.size() == 2);
+      return from_lit(sym_aig().mk_or(a[0].lit_, a[1].lit_));
     case Type::Xor:
-      assert(a.size() == 2);
-      state_sym.val_ = a[0].val_ ^ a[1].val_;
-      break;
+      log_assert(a.size() == 2);
+      return from_lit(sym_aig().mk_xor(a[0].lit_, a[1].lit_));
     case Type::Not:
-      assert(a.size() == 1);
-      state_sym.val_ = ~a[0].val_;
-      break;
+      log_assert(a.size() == 1);
+      return from_lit(SymAig::lit_not(a[0].lit_));
     case Type::Lt:
-      assert(a.size() == 2);
-      state_sym.val_ = a[0].val_ < a[1].val_;
-      break;
+      log_assert(a.size() == 2);
+      return from_lit(sym_aig().mk_and(SymAig::lit_not(a[0].lit_), a[1].lit_));
     case Type::Gt:
-      assert(a.size() == 2);
-      state_sym.val_ = a[0].val_ > a[1].val_;
-      break;
+      log_assert(a.size() == 2);
+      return from_lit(sym_aig().mk_and(a[0].lit_, SymAig::lit_not(a[1].lit_)));
     case Type::Eq:
-      assert(a.size() == 2);
-      state_sym.val_ = a[0].val_ == a[1].val_;
-      break;
+      log_assert(a.size() == 2);
+      return from_lit(sym_aig().mk_xnor(a[0].lit_, a[1].lit_));
     case Type::Mux:
-      assert(a.size() == 3);
-      state_sym.val_ = z3::ite(a[2].val_ == 1, a[1].val_, a[0].val_);
-      break;
+      log_assert(a.size() == 3);
+      return from_lit(sym_aig().mk_mux(a[0].lit_, a[1].lit_, a[2].lit_));
     default:
-      assert(false);
-      state_sym.val_ = bit_val(0);
+      log_abort();
     }
-    state_sym.val_ = state_sym.val_.simplify();
-
-    return state_sym;
   }
   RTLIL::State to_state() const {
-    //    std::cerr << "to state start";
-    RTLIL::State s =
-        is_true(val_) ? State::S1 : (is_false(val_) ? State::S0 : State::Sx);
-
-    //    std::cerr << "to state finish";
-    return s;
+    return lit_ == SymAig::True
+               ? State::S1
+               : (lit_ == SymAig::False ? State::S0 : State::Sx);
   }
 #define CreateOp(_OP, _TYPE)                                                   \
   static StateSym Create##_OP(const vector<StateSym> &a) {                     \
@@ -193,7 +169,6 @@ public:
 
   static StateSym CreateMux(const StateSym &a, const StateSym &b,
                             const StateSym &s) {
-    // log("create Mux\n");
     return CreateStateSymByOp(Type::Mux, vector<StateSym>({a, b, s}));
   }
 
@@ -205,107 +180,85 @@ public:
   CreateOp(Lt, Type::Lt);
   CreateOp2(Eq, Type::Eq);
   CreateOpSingle(Not, Type::Not);
+  // Compares constant values only: a StateSym is never equal to x, z or
+  // any other non-binary State. Use is_const() to tell symbolic values
+  // apart.
   bool operator==(const State &other) const {
-    //  std::cerr << "==" << val_ << "\n";
-    if (val_.is_bv() && val_.is_app()) {
-      if (other == State::S0)
-        return is_false(val_);
-      return is_true(val_);
-    } else {
-      return false;
-    }
+    if (other == State::S0)
+      return lit_ == SymAig::False;
+    if (other == State::S1)
+      return lit_ == SymAig::True;
+    return false;
   }
-  bool operator==(const StateSym &other) const {
-    return prove(other.val_ == val_);
+  bool operator!=(const State &other) const { return !(*this == other); }
+  // Structural comparison: the AIG is hash-consed, so this is exact for
+  // constants and for values built the same way. Use equivalent() when
+  // semantically equal but structurally different values must match.
+  bool operator==(const StateSym &other) const { return lit_ == other.lit_; }
+  bool equivalent(const StateSym &other) const {
+    if (lit_ == other.lit_)
+      return true;
+    if (is_const() && other.is_const())
+      return false;
+    if (lit_ == SymAig::lit_not(other.lit_))
+      return false;
+    return prove(other.to_expr() == to_expr());
   }
   bool operator!=(const StateSym &other) const { return !(other == *this); }
-  bool is_const() const { return val_.is_bv() && val_.is_app(); }
+  bool is_const() const { return SymAig::lit_is_const(lit_); }
 }; // namespace RTLIL
 
 struct SymConst {
   int flags;
-  z3::expr_vector bits;
+  std::vector<StateSym> bits;
   RTLIL::SigSpec signal;
   enum Type : unsigned char { Bit, Add };
   Type type_;
-  size_t size() const { return bits.size(); }
-  z3::expr_vector reversed_bits() const {
-    z3::expr_vector new_bits(z3_context);
-    int size = bits.size();
-    for (int i = 0; i < size; ++i) {
-      new_bits.push_back(bits[size - i-1]);
-    }
-    return new_bits;
-  }
-  z3::expr to_expr() const {
-  //  std::cerr<<"\n"<<z3::concat(bits).simplify()<<"\n"<<z3::concat(reversed_bits()).simplify();
-  //  assert(bits.size()==1);
-    return z3::concat(reversed_bits()).simplify();
-  }
+  int size() const { return GetSize(bits); }
+  // Lower to a single bit-vector term. Runs of bits selected from the same
+  // word and runs of constant bits are lowered as one piece, so word-level
+  // results pass through unchanged instead of being re-concatenated bit by
+  // bit.
+  z3::expr to_expr() const;
 
-  SymConst() : bits(z3_context) {}
+  SymConst() : flags(CONST_FLAG_NONE), type_(Type::Bit) {}
   SymConst(std::string str, const RTLIL::SigSpec &sig = RTLIL::SigSpec());
   SymConst(int val, int width = 1,
            const RTLIL::SigSpec &sig = RTLIL::SigSpec());
+  SymConst(RTLIL::State bit, int width = 1,
+           const RTLIL::SigSpec &sig = RTLIL::SigSpec());
   SymConst(RTLIL::StateSym bit, int width = 1,
            const RTLIL::SigSpec &sig = RTLIL::SigSpec());
-  SymConst(const RTLIL::SigSpec &sig) : type_(Type::Bit), bits(z3_context) {}
+  SymConst(const RTLIL::SigSpec &sig)
+      : flags(CONST_FLAG_NONE), type_(Type::Bit) {}
   SymConst(RTLIL::Const c, const RTLIL::SigSpec &sig = RTLIL::SigSpec())
-      : type_(Type::Bit), bits(z3_context) {
+      : flags(CONST_FLAG_NONE), signal(sig), type_(Type::Bit) {
     for (auto b : c.bits)
-      bits.push_back(StateSym(b).val_);
-    signal = sig;
+      bits.push_back(StateSym(b));
   };
-  SymConst(const RTLIL::SymConst &c) : type_(Type::Bit), bits(z3_context) {
+  SymConst(const RTLIL::SymConst &c)
+      : flags(c.flags), bits(c.bits), signal(c.signal), type_(Type::Bit) {}
+  SymConst &operator=(const RTLIL::SymConst &c) {
     flags = c.flags;
     bits = c.bits;
     signal = c.signal;
-  };
-  SymConst(const std::vector<RTLIL::StateSym> &_bits,
-           const RTLIL::SigSpec &sig = RTLIL::SigSpec())
-      : bits(z3_context), signal(sig) {
-    flags = CONST_FLAG_NONE;
-    for (auto b : _bits)
-      bits.push_back(b.val_.simplify());
+    type_ = c.type_;
+    return *this;
   }
-  SymConst(const z3::expr_vector &_bits,
+  SymConst(const std::vector<RTLIL::StateSym> &_bits,
            const RTLIL::SigSpec &sig = RTLIL::SigSpec())
-      : bits(_bits), signal(sig) {}
+      : flags(CONST_FLAG_NONE), bits(_bits), signal(sig), type_(Type::Bit) {}
   SymConst(const std::vector<bool> &bits,
            const RTLIL::SigSpec &sig = RTLIL::SigSpec());
+  SymConst(const z3::expr &e, int size);
+  SymConst(const z3::expr &e);
 
-  SymConst(const z3::expr &ee, int size) : bits(z3_context) {
-    z3::expr e = ee.simplify();
-    if (e.is_bv()) {
-      assert(e.get_sort().bv_size() == size);
-      for (int i = 0; i < size; ++i) {
-        bits.push_back(e.extract(size-i-1, size-i-1).simplify());
-      }
-    } else {
-      assert(size == 1);
-      bits.push_back(z3::ite(e, bit_val(1), bit_val(0)).simplify());
-    }
-  }
-  SymConst(const z3::expr &e) : bits(z3_context) {
-    if (e.is_bv()) {
-      int size = e.get_sort().bv_size();
-      for (int i = 0; i < size; ++i) {
-        bits.push_back(e.extract(size-i-1, size-i-1));
-      }
-    } else {
-      bits.push_back(z3::ite(e, bit_val(1), bit_val(0)));
-    }
-  }
-  void push_back(const StateSym &s) { bits.push_back(s.val_); }
-  RTLIL::Const to_const() {
+  void push_back(const StateSym &s) { bits.push_back(s); }
+  RTLIL::Const to_const() const {
     RTLIL::Const c;
-    for (int i = 0; i < size(); ++i) {
-      auto b = bits[i];
-      if (is_true(b) || is_false(b))
-        c.bits.push_back(is_true(b) ? State::S1 : State::S1);
-      else
-        c.bits.push_back(RTLIL::Sx);
-    }
+    for (auto &b : bits)
+      c.bits.push_back(b.to_state());
+    return c;
   }
   bool operator==(const RTLIL::SymConst &other) const;
   bool operator!=(const RTLIL::SymConst &other) const;
@@ -324,31 +277,17 @@ struct SymConst {
   inline RTLIL::SymConst
   extract(int offset, int len = 1,
           RTLIL::StateSym padding = RTLIL::State::S0) const {
-    // bits is ordered from big to little
-    z3::expr_vector e(z3_context);
-    int size = this->size();
-    for (int i = 0; i < len; ++i) {
-      int pos = offset + len - i-1;
-      if (pos >= size) {
-        e.push_back(padding.to_expr());
-      } else
-        e.push_back(bits[pos]);
-    }
-    return z3::concat(e).simplify();
-    // return SymConst(to_expr().extract(offset + len - 1, offset).simplify());
-    /*
+    RTLIL::SymConst ret;
     ret.bits.reserve(len);
     for (int i = offset; i < offset + len; i++)
       ret.bits.push_back(i < GetSize(bits) ? bits[i] : padding);
-    */
+    return ret;
   }
 
   inline unsigned int hash() const {
     unsigned int h = mkhash_init;
-    for (int i = 0; i < size(); ++i) {
-      auto b = bits[i];
-      mkhash(h, b.id());
-    }
+    for (auto &b : bits)
+      h = mkhash(h, b.lit_);
     return h;
   }
 }; // namespace RTLIL
@@ -0,0 +1,242 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/coi.h"
+#include "kernel/modtools.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+static bool is_property_cell(RTLIL::Cell *cell)
+{
+	return cell->type.in("$assert", "$assume", "$cover", "$live", "$fair");
+}
+
+CoiSlice::CoiSlice(RTLIL::Design *orig) : orig(orig)
+{
+	design = new RTLIL::Design;
+
+	pool<RTLIL::IdString> instantiated, prop_modules;
+	for (auto module : orig->modules())
+		for (auto cell : module->cells()) {
+			if (orig->module(cell->type) != nullptr)
+				instantiated.insert(cell->type);
+			if (is_property_cell(cell) && orig->selected(module, cell))
+				prop_modules.insert(module->name);
+		}
+
+	// a module containing an instance of a module with properties has
+	// properties as well
+	for (bool did_something = true; did_something;) {
+		did_something = false;
+		for (auto module : orig->modules()) {
+			if (prop_modules.count(module->name))
+				continue;
+			for (auto cell : module->cells())
+				if (prop_modules.count(cell->type)) {
+					prop_modules.insert(module->name);
+					did_something = true;
+					break;
+				}
+		}
+	}
+
+	for (auto module : orig->modules())
+		slice_module(module, instantiated.count(module->name) != 0, prop_modules);
+}
+
+CoiSlice::~CoiSlice()
+{
+	delete design;
+}
+
+void CoiSlice::slice_module(RTLIL::Module *module, bool is_instantiated, const pool<RTLIL::IdString> &prop_modules)
+{
+	if (module->get_blackbox_attribute()) {
+		design->add(module->clone());
+		return;
+	}
+
+	ModWalker walker(orig, module);
+	pool<RTLIL::SigBit> cone_bits;
+	pool<RTLIL::Cell*> cone_cells;
+	pool<RTLIL::IdString> cone_memids;
+	std::vector<RTLIL::SigBit> todo;
+
+	dict<RTLIL::IdString, std::vector<RTLIL::Cell*>> memory_cells;
+	for (auto cell : module->cells())
+		if (cell->type.in("$memrd", "$memwr", "$meminit"))
+			memory_cells[cell->getParam("\\MEMID").decode_string()].push_back(cell);
+
+	std::function<void(RTLIL::Cell*)> add_cell = [&](RTLIL::Cell *cell)
+	{
+		if (cone_cells.count(cell))
+			return;
+		cone_cells.insert(cell);
+		if (walker.cell_inputs.count(cell))
+			for (auto bit : walker.cell_inputs.at(cell))
+				todo.push_back(bit);
+
+		// the write ports of a memory have no outputs, they are part of
+		// the cone when one of its read ports is
+		if (cell->type == "$memrd") {
+			RTLIL::IdString memid = cell->getParam("\\MEMID").decode_string();
+			if (!cone_memids.count(memid)) {
+				cone_memids.insert(memid);
+				for (auto c : memory_cells.at(memid))
+					add_cell(c);
+			}
+		}
+	};
+
+	for (auto cell : module->cells())
+		if ((is_property_cell(cell) && orig->selected(module, cell)) || prop_modules.count(cell->type))
+			add_cell(cell);
+
+	if (is_instantiated)
+		for (auto bit : walker.signal_outputs)
+			todo.push_back(bit);
+
+	while (!todo.empty())
+	{
+		RTLIL::SigBit bit = todo.back();
+		todo.pop_back();
+
+		if (cone_bits.count(bit))
+			continue;
+		cone_bits.insert(bit);
+
+		if (walker.signal_drivers.count(bit))
+			for (auto &pbit : walker.signal_drivers.at(bit))
+				add_cell(pbit.cell);
+	}
+
+	RTLIL::Module *new_mod = module->clone();
+	design->add(new_mod);
+
+	pool<RTLIL::IdString> used_wires;
+	auto mark_used = [&](const RTLIL::SigSpec &sig) {
+		for (auto &chunk : sig.chunks())
+			if (chunk.wire != nullptr)
+				used_wires.insert(chunk.wire->name);
+	};
+
+	for (auto cell : module->cells())
+		if (cone_cells.count(cell)) {
+			kept_cells[module->name].insert(cell->name);
+			for (auto &conn : cell->connections())
+				mark_used(conn.second);
+		} else {
+			dropped_cells[module->name].insert(cell->name);
+			new_mod->remove(new_mod->cell(cell->name));
+		}
+
+	std::vector<RTLIL::SigSig> new_connections;
+	const std::vector<RTLIL::SigSig> &old_connections = module->connections();
+	for (int i = 0; i < GetSize(old_connections); i++) {
+		bool keep = false;
+		for (auto bit : walker.sigmap(old_connections[i].first))
+			if (cone_bits.count(bit))
+				keep = true;
+		if (!keep)
+			continue;
+		mark_used(old_connections[i].first);
+		mark_used(old_connections[i].second);
+		new_connections.push_back(new_mod->connections().at(i));
+	}
+	new_mod->new_connections(new_connections);
+
+	pool<RTLIL::Wire*> remove_wires;
+	for (auto wire : module->wires())
+		if (wire->port_id != 0 || used_wires.count(wire->name)) {
+			kept_wires[module->name].insert(wire->name);
+		} else {
+			dropped_wires[module->name].insert(wire->name);
+			remove_wires.insert(new_mod->wire(wire->name));
+		}
+	new_mod->remove(remove_wires);
+
+	// memories without any cells left are dropped as well
+	for (auto &it : module->memories)
+		if (!cone_memids.count(it.first) && memory_cells.count(it.first)) {
+			delete new_mod->memories.at(it.first);
+			new_mod->memories.erase(it.first);
+		}
+}
+
+void CoiSlice::write_map(const std::string &filename) const
+{
+	std::ofstream f(filename.c_str());
+	if (f.fail())
+		log_error("Can't open file `%s' for writing.\n", filename.c_str());
+
+	f << "# cone of influence slice: kept and dropped objects of the original design\n";
+
+	auto write_names = [&](const char *what, const dict<RTLIL::IdString, pool<RTLIL::IdString>> &names,
+			RTLIL::IdString modname, bool is_cell)
+	{
+		if (!names.count(modname))
+			return;
+		std::vector<RTLIL::IdString> sorted(names.at(modname).begin(), names.at(modname).end());
+		std::sort(sorted.begin(), sorted.end(), RTLIL::sort_by_id_str());
+		RTLIL::Module *module = orig->module(modname);
+		for (auto name : sorted) {
+			if (is_cell) {
+				RTLIL::Cell *cell = module->cell(name);
+				f << stringf("%s cell %s %s", what, name.c_str(), cell->type.c_str());
+				if (cell->attributes.count("\\src"))
+					f << " " << cell->get_src_attribute();
+			} else {
+				RTLIL::Wire *wire = module->wire(name);
+				f << stringf("%s wire %s %d", what, name.c_str(), wire->width);
+				if (wire->attributes.count("\\src"))
+					f << " " << wire->get_src_attribute();
+			}
+			f << "\n";
+		}
+	};
+
+	std::vector<RTLIL::IdString> modnames;
+	for (auto module : orig->modules())
+		if (!module->get_blackbox_attribute())
+			modnames.push_back(module->name);
+	std::sort(modnames.begin(), modnames.end(), RTLIL::sort_by_id_str());
+
+	for (auto modname : modnames) {
+		f << stringf("module %s\n", modname.c_str());
+		write_names("keep", kept_cells, modname, true);
+		write_names("keep", kept_wires, modname, false);
+		write_names("drop", dropped_cells, modname, true);
+		write_names("drop", dropped_wires, modname, false);
+	}
+}
+
+void CoiSlice::log_stats() const
+{
+	for (auto module : orig->modules()) {
+		if (module->get_blackbox_attribute())
+			continue;
+		auto count = [&](const dict<RTLIL::IdString, pool<RTLIL::IdString>> &names) {
+			return names.count(module->name) ? GetSize(names.at(module->name)) : 0;
+		};
+		log("Cone of influence of module %s: %d of %d cells, %d of %d wires.\n", log_id(module),
+				count(kept_cells), GetSize(module->cells()), count(kept_wires), GetSize(module->wires()));
+	}
+}
+
+YOSYS_NAMESPACE_END
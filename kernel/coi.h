@@ -0,0 +1,61 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef COI_H
+#define COI_H
+
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Sequential cone of influence of the selected property cells ($assert,
+// $assume, $cover, $live and $fair) of a design, for the backends that
+// write model checking problems.
+//
+// The cone is followed backwards from the inputs of the property cells
+// through all cells, including registers and memories, until it reaches
+// primary inputs. Output ports of modules that are instantiated elsewhere
+// and instances of modules containing properties are roots as well, so
+// the hierarchy keeps working. Unselected property cells are not roots and
+// are dropped unless they are in the cone.
+//
+// The slice is a copy of the design that only contains the cells,
+// connections and wires of the cone (and all ports). Names are unchanged,
+// so the output for the slice can be read with the names of the original
+// design. write_map() lists what was kept and what was dropped.
+struct CoiSlice
+{
+	RTLIL::Design *design;
+	dict<RTLIL::IdString, pool<RTLIL::IdString>> kept_cells, kept_wires;
+	dict<RTLIL::IdString, pool<RTLIL::IdString>> dropped_cells, dropped_wires;
+
+	CoiSlice(RTLIL::Design *orig);
+	~CoiSlice();
+
+	void write_map(const std::string &filename) const;
+	void log_stats() const;
+
+private:
+	RTLIL::Design *orig;
+	void slice_module(RTLIL::Module *module, bool is_instantiated, const pool<RTLIL::IdString> &prop_modules);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
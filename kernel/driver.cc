@@ -298,6 +298,14 @@ int main(int argc, char **argv)
 		printf("    -g\n");
 		printf("        globally enable debug log messages\n");
 		printf("\n");
+		printf("    -x <channel>\n");
+		printf("        enable the given trace channel, '*' enables all of them. see\n");
+		printf("        'help trace_channel' for a list of channels.\n");
+		printf("\n");
+		printf("    -j <N>\n");
+		printf("        run module-local passes on up to N threads, one module per thread\n");
+		printf("        at a time. the log output is the same as for a serial run.\n");
+		printf("\n");
 		printf("    -V\n");
 		printf("        print version information and exit\n");
 		printf("\n");
@@ -318,7 +326,7 @@ int main(int argc, char **argv)
 	}
 
 	int opt;
-	while ((opt = getopt(argc, argv, "MXAQTVSgm:f:Hh:b:o:p:l:L:qv:tds:c:W:w:e:D:P:E:")) != -1)
+	while ((opt = getopt(argc, argv, "MXAQTVSgm:f:Hh:b:o:p:l:L:qv:tds:c:W:w:e:D:P:E:x:j:")) != -1)
 	{
 		switch (opt)
 		{
@@ -346,6 +354,16 @@ int main(int argc, char **argv)
 		case 'g':
 			log_force_debug++;
 			break;
+		case 'x':
+			log_trace_enable(optarg);
+			break;
+		case 'j':
+			yosys_threads = atoi(optarg);
+			if (yosys_threads < 1) {
+				fprintf(stderr, "Invalid number of threads for -j.\n");
+				exit(1);
+			}
+			break;
 		case 'm':
 			plugin_filenames.push_back(optarg);
 			break;
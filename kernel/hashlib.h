@@ -17,6 +17,11 @@
 #include <string>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define HASHLIB_FLAT_SSE2
+#  include <emmintrin.h>
+#endif
+
 namespace hashlib {
 
 const int hashtable_size_trigger = 2;
@@ -195,6 +200,8 @@ template<typename K, typename T, typename OPS = hash_ops<K>> class dict;
 template<typename K, int offset = 0, typename OPS = hash_ops<K>> class idict;
 template<typename K, typename OPS = hash_ops<K>> class pool;
 template<typename K, typename OPS = hash_ops<K>> class mfp;
+template<typename K, typename T, typename OPS = hash_ops<K>> class flat_dict;
+template<typename K, typename OPS = hash_ops<K>> class flat_pool;
 
 template<typename K, typename T, typename OPS>
 class dict
@@ -1060,6 +1067,767 @@ public:
 	const_iterator end() const { return database.end(); }
 };
 
+// -------------------------------------------------------
+// flat_dict<K, T> and flat_pool<K>
+// -------------------------------------------------------
+//
+// Drop-in variants of dict<K, T> and pool<K> with the same interface and the
+// same iteration order, so a user can switch with a typedef. The entries are
+// kept in the same insertion-ordered vector, only the index is different: an
+// open addressing table with a power-of-two number of cache line sized slot
+// groups. Each slot has a control byte that holds 7 bits of the hash, so a
+// probe checks a whole group at once (with SSE2 where available) and only
+// compares the keys of entries with a matching tag. The full hash is stored
+// with each entry, so growing the table does not hash the keys again.
+//
+// Which one is faster depends on the key distribution and access pattern,
+// use the test_hashlib pass to compare them on a real design before switching.
+
+class flat_index
+{
+	enum : unsigned char {
+		group_slots = 12,
+		ctrl_empty = 0x80,
+		ctrl_deleted = 0xfe
+	};
+
+	// One cache line per group: 16 control bytes (only the first 12 are used,
+	// so a group can be loaded with one SSE2 instruction) and 12 entry indices.
+	// Full slots have a control byte in 0x00..0x7f, free slots have the msb set.
+	struct group_t {
+		unsigned char ctrl[16];
+		int slots[group_slots];
+	};
+
+	std::vector<char> storage;
+	group_t *groups = nullptr;
+	int group_mask = -1;
+	int used_slots = 0;
+
+	static inline unsigned int mix(unsigned int h) {
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	// Most hashes in this code base are small sequential numbers (object ids
+	// and wire bit offsets), so the group is picked from the hash itself to
+	// keep neighbouring keys in neighbouring groups. The shifts mix in higher
+	// bits for aligned pointers. The tag comes from the mixed hash.
+	static inline unsigned int home(unsigned int h) {
+		return h ^ (h >> 7) ^ (h >> 16);
+	}
+
+	static inline int lowest_bit(unsigned int mask) {
+#if defined(__GNUC__)
+		return __builtin_ctz(mask);
+#else
+		int i = 0;
+		while (!(mask & 1))
+			mask >>= 1, i++;
+		return i;
+#endif
+	}
+
+	static inline unsigned int match_byte(const group_t &g, unsigned char value) {
+#ifdef HASHLIB_FLAT_SSE2
+		__m128i bytes = _mm_load_si128((const __m128i*)g.ctrl);
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)value))) & ((1u << group_slots) - 1);
+#else
+		unsigned int mask = 0;
+		for (int i = 0; i < group_slots; i++)
+			if (g.ctrl[i] == value)
+				mask |= 1u << i;
+		return mask;
+#endif
+	}
+
+	static inline unsigned int match_free(const group_t &g) {
+#ifdef HASHLIB_FLAT_SSE2
+		return _mm_movemask_epi8(_mm_load_si128((const __m128i*)g.ctrl)) & ((1u << group_slots) - 1);
+#else
+		unsigned int mask = 0;
+		for (int i = 0; i < group_slots; i++)
+			if (g.ctrl[i] & 0x80)
+				mask |= 1u << i;
+		return mask;
+#endif
+	}
+
+	void find_slot(unsigned int hash, int index, group_t *&g, int &i)
+	{
+		unsigned char tag = mix(hash) >> 25;
+		int group = home(hash) & group_mask;
+
+		for (int step = 1;; step++) {
+			g = &groups[group];
+			for (unsigned int mask = match_byte(*g, tag); mask; mask &= mask - 1) {
+				i = lowest_bit(mask);
+				if (g->slots[i] == index)
+					return;
+			}
+			if (match_byte(*g, ctrl_empty))
+				throw std::runtime_error("flat_index: entry not found.");
+			group = (group + step) & group_mask;
+		}
+	}
+
+	void place(unsigned int hash, int index)
+	{
+		unsigned char tag = mix(hash) >> 25;
+		int group = home(hash) & group_mask;
+
+		for (int step = 1;; step++) {
+			group_t &g = groups[group];
+			unsigned int mask = match_free(g);
+			if (mask) {
+				int i = lowest_bit(mask);
+				if (g.ctrl[i] == ctrl_empty)
+					used_slots++;
+				g.ctrl[i] = tag;
+				g.slots[i] = index;
+				return;
+			}
+			group = (group + step) & group_mask;
+		}
+	}
+
+public:
+	flat_index() { }
+	flat_index(const flat_index &) = delete;
+	flat_index &operator=(const flat_index &) = delete;
+
+	// entry index of the first entry with this hash for which match(index) is true, or -1
+	template<typename Match>
+	int lookup(unsigned int hash, const Match &match) const
+	{
+		if (groups == nullptr)
+			return -1;
+
+		unsigned char tag = mix(hash) >> 25;
+		int group = home(hash) & group_mask;
+
+		for (int step = 1;; step++) {
+			const group_t &g = groups[group];
+			for (unsigned int mask = match_byte(g, tag); mask; mask &= mask - 1) {
+				int index = g.slots[lowest_bit(mask)];
+				if (match(index))
+					return index;
+			}
+			if (match_byte(g, ctrl_empty))
+				return -1;
+			group = (group + step) & group_mask;
+		}
+	}
+
+	// true if one more entry can't be added without rebuilding the index
+	bool full() const {
+		return (used_slots + 1) * 4 > capacity() * 3;
+	}
+
+	void insert(unsigned int hash, int index) {
+		place(hash, index);
+	}
+
+	void erase(unsigned int hash, int index) {
+		group_t *g;
+		int i;
+		find_slot(hash, index, g, i);
+		g->ctrl[i] = ctrl_deleted;
+	}
+
+	void renumber(unsigned int hash, int old_index, int new_index) {
+		group_t *g;
+		int i;
+		find_slot(hash, old_index, g, i);
+		g->slots[i] = new_index;
+	}
+
+	// rebuild for at least min_entries entries, get_hash(i) returns the hash of entry i < count
+	template<typename GetHash>
+	void rebuild(int min_entries, int count, const GetHash &get_hash)
+	{
+		int num_groups = 1;
+		while (num_groups * group_slots < 2 * min_entries)
+			num_groups *= 2;
+
+		storage.clear();
+		storage.resize((num_groups + 1) * sizeof(group_t));
+		size_t offset = (sizeof(group_t) - size_t(storage.data()) % sizeof(group_t)) % sizeof(group_t);
+		groups = reinterpret_cast<group_t*>(storage.data() + offset);
+		group_mask = num_groups - 1;
+		used_slots = 0;
+
+		for (int i = 0; i < num_groups; i++)
+			for (int j = 0; j < 16; j++)
+				groups[i].ctrl[j] = ctrl_empty;
+
+		for (int i = 0; i < count; i++)
+			place(get_hash(i), i);
+	}
+
+	int capacity() const { return (group_mask + 1) * group_slots; }
+
+	void clear() {
+		std::vector<char>().swap(storage);
+		groups = nullptr;
+		group_mask = -1;
+		used_slots = 0;
+	}
+
+	void swap(flat_index &other) {
+		storage.swap(other.storage);
+		std::swap(groups, other.groups);
+		std::swap(group_mask, other.group_mask);
+		std::swap(used_slots, other.used_slots);
+	}
+};
+
+template<typename K, typename T, typename OPS>
+class flat_dict
+{
+	struct entry_t
+	{
+		std::pair<K, T> udata;
+		unsigned int hash;
+
+		entry_t() { }
+		entry_t(const std::pair<K, T> &udata, unsigned int hash) : udata(udata), hash(hash) { }
+		entry_t(std::pair<K, T> &&udata, unsigned int hash) : udata(std::move(udata)), hash(hash) { }
+	};
+
+	flat_index index;
+	std::vector<entry_t> entries;
+	OPS ops;
+
+	unsigned int do_hash(const K &key) const
+	{
+		return ops.hash(key);
+	}
+
+	void do_rehash(int min_entries)
+	{
+		index.rebuild(min_entries, entries.size(), [this](int i) { return entries[i].hash; });
+	}
+
+	int do_lookup(const K &key, unsigned int hash) const
+	{
+		return index.lookup(hash, [&](int i) { return entries[i].hash == hash && ops.cmp(entries[i].udata.first, key); });
+	}
+
+	int do_insert(std::pair<K, T> &&value, unsigned int hash)
+	{
+		if (index.full())
+			do_rehash(entries.size() + 1);
+		entries.push_back(entry_t(std::move(value), hash));
+		index.insert(hash, entries.size() - 1);
+		return entries.size() - 1;
+	}
+
+	int do_erase(int i)
+	{
+		if (i < 0)
+			return 0;
+
+		index.erase(entries[i].hash, i);
+
+		int back_idx = entries.size()-1;
+		if (i != back_idx) {
+			index.renumber(entries[back_idx].hash, back_idx, i);
+			entries[i] = std::move(entries[back_idx]);
+		}
+
+		entries.pop_back();
+
+		if (entries.empty())
+			index.clear();
+
+		return 1;
+	}
+
+public:
+	class const_iterator : public std::iterator<std::forward_iterator_tag, std::pair<K, T>>
+	{
+		friend class flat_dict;
+	protected:
+		const flat_dict *ptr;
+		int index;
+		const_iterator(const flat_dict *ptr, int index) : ptr(ptr), index(index) { }
+	public:
+		const_iterator() { }
+		const_iterator operator++() { index--; return *this; }
+		bool operator<(const const_iterator &other) const { return index > other.index; }
+		bool operator==(const const_iterator &other) const { return index == other.index; }
+		bool operator!=(const const_iterator &other) const { return index != other.index; }
+		const std::pair<K, T> &operator*() const { return ptr->entries[index].udata; }
+		const std::pair<K, T> *operator->() const { return &ptr->entries[index].udata; }
+	};
+
+	class iterator : public std::iterator<std::forward_iterator_tag, std::pair<K, T>>
+	{
+		friend class flat_dict;
+	protected:
+		flat_dict *ptr;
+		int index;
+		iterator(flat_dict *ptr, int index) : ptr(ptr), index(index) { }
+	public:
+		iterator() { }
+		iterator operator++() { index--; return *this; }
+		bool operator<(const iterator &other) const { return index > other.index; }
+		bool operator==(const iterator &other) const { return index == other.index; }
+		bool operator!=(const iterator &other) const { return index != other.index; }
+		std::pair<K, T> &operator*() { return ptr->entries[index].udata; }
+		std::pair<K, T> *operator->() { return &ptr->entries[index].udata; }
+		const std::pair<K, T> &operator*() const { return ptr->entries[index].udata; }
+		const std::pair<K, T> *operator->() const { return &ptr->entries[index].udata; }
+		operator const_iterator() const { return const_iterator(ptr, index); }
+	};
+
+	flat_dict()
+	{
+	}
+
+	flat_dict(const flat_dict &other)
+	{
+		entries = other.entries;
+		do_rehash(entries.size());
+	}
+
+	flat_dict(flat_dict &&other)
+	{
+		swap(other);
+	}
+
+	flat_dict &operator=(const flat_dict &other) {
+		entries = other.entries;
+		do_rehash(entries.size());
+		return *this;
+	}
+
+	flat_dict &operator=(flat_dict &&other) {
+		clear();
+		swap(other);
+		return *this;
+	}
+
+	flat_dict(const std::initializer_list<std::pair<K, T>> &list)
+	{
+		for (auto &it : list)
+			insert(it);
+	}
+
+	template<class InputIterator>
+	flat_dict(InputIterator first, InputIterator last)
+	{
+		insert(first, last);
+	}
+
+	template<class InputIterator>
+	void insert(InputIterator first, InputIterator last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+
+	std::pair<iterator, bool> insert(const K &key)
+	{
+		unsigned int hash = do_hash(key);
+		int i = do_lookup(key, hash);
+		if (i >= 0)
+			return std::pair<iterator, bool>(iterator(this, i), false);
+		i = do_insert(std::pair<K, T>(key, T()), hash);
+		return std::pair<iterator, bool>(iterator(this, i), true);
+	}
+
+	std::pair<iterator, bool> insert(const std::pair<K, T> &value)
+	{
+		unsigned int hash = do_hash(value.first);
+		int i = do_lookup(value.first, hash);
+		if (i >= 0)
+			return std::pair<iterator, bool>(iterator(this, i), false);
+		i = do_insert(std::pair<K, T>(value), hash);
+		return std::pair<iterator, bool>(iterator(this, i), true);
+	}
+
+	int erase(const K &key)
+	{
+		return do_erase(do_lookup(key, do_hash(key)));
+	}
+
+	iterator erase(iterator it)
+	{
+		do_erase(it.index);
+		return ++it;
+	}
+
+	int count(const K &key) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		return i < 0 ? 0 : 1;
+	}
+
+	int count(const K &key, const_iterator it) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		return i < 0 || i > it.index ? 0 : 1;
+	}
+
+	iterator find(const K &key)
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			return end();
+		return iterator(this, i);
+	}
+
+	const_iterator find(const K &key) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			return end();
+		return const_iterator(this, i);
+	}
+
+	T& at(const K &key)
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			throw std::out_of_range("flat_dict::at()");
+		return entries[i].udata.second;
+	}
+
+	const T& at(const K &key) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			throw std::out_of_range("flat_dict::at()");
+		return entries[i].udata.second;
+	}
+
+	T at(const K &key, const T &defval) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			return defval;
+		return entries[i].udata.second;
+	}
+
+	T& operator[](const K &key)
+	{
+		unsigned int hash = do_hash(key);
+		int i = do_lookup(key, hash);
+		if (i < 0)
+			i = do_insert(std::pair<K, T>(key, T()), hash);
+		return entries[i].udata.second;
+	}
+
+	template<typename Compare = std::less<K>>
+	void sort(Compare comp = Compare())
+	{
+		std::sort(entries.begin(), entries.end(), [comp](const entry_t &a, const entry_t &b){ return comp(b.udata.first, a.udata.first); });
+		do_rehash(entries.size());
+	}
+
+	void swap(flat_dict &other)
+	{
+		index.swap(other.index);
+		entries.swap(other.entries);
+	}
+
+	bool operator==(const flat_dict &other) const {
+		if (size() != other.size())
+			return false;
+		for (auto &it : entries) {
+			auto oit = other.find(it.udata.first);
+			if (oit == other.end() || !(oit->second == it.udata.second))
+				return false;
+		}
+		return true;
+	}
+
+	bool operator!=(const flat_dict &other) const {
+		return !operator==(other);
+	}
+
+	void reserve(size_t n) {
+		entries.reserve(n);
+		if (2 * int(n) > index.capacity())
+			do_rehash(n);
+	}
+
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+	void clear() { index.clear(); entries.clear(); }
+
+	iterator begin() { return iterator(this, int(entries.size())-1); }
+	iterator element(int n) { return iterator(this, int(entries.size())-1-n); }
+	iterator end() { return iterator(nullptr, -1); }
+
+	const_iterator begin() const { return const_iterator(this, int(entries.size())-1); }
+	const_iterator element(int n) const { return const_iterator(this, int(entries.size())-1-n); }
+	const_iterator end() const { return const_iterator(nullptr, -1); }
+};
+
+template<typename K, typename OPS>
+class flat_pool
+{
+	struct entry_t
+	{
+		K udata;
+		unsigned int hash;
+
+		entry_t() { }
+		entry_t(const K &udata, unsigned int hash) : udata(udata), hash(hash) { }
+	};
+
+	flat_index index;
+	std::vector<entry_t> entries;
+	OPS ops;
+
+	unsigned int do_hash(const K &key) const
+	{
+		return ops.hash(key);
+	}
+
+	void do_rehash(int min_entries)
+	{
+		index.rebuild(min_entries, entries.size(), [this](int i) { return entries[i].hash; });
+	}
+
+	int do_lookup(const K &key, unsigned int hash) const
+	{
+		return index.lookup(hash, [&](int i) { return entries[i].hash == hash && ops.cmp(entries[i].udata, key); });
+	}
+
+	int do_insert(const K &value, unsigned int hash)
+	{
+		if (index.full())
+			do_rehash(entries.size() + 1);
+		entries.push_back(entry_t(value, hash));
+		index.insert(hash, entries.size() - 1);
+		return entries.size() - 1;
+	}
+
+	int do_erase(int i)
+	{
+		if (i < 0)
+			return 0;
+
+		index.erase(entries[i].hash, i);
+
+		int back_idx = entries.size()-1;
+		if (i != back_idx) {
+			index.renumber(entries[back_idx].hash, back_idx, i);
+			entries[i] = std::move(entries[back_idx]);
+		}
+
+		entries.pop_back();
+
+		if (entries.empty())
+			index.clear();
+
+		return 1;
+	}
+
+public:
+	class const_iterator : public std::iterator<std::forward_iterator_tag, K>
+	{
+		friend class flat_pool;
+	protected:
+		const flat_pool *ptr;
+		int index;
+		const_iterator(const flat_pool *ptr, int index) : ptr(ptr), index(index) { }
+	public:
+		const_iterator() { }
+		const_iterator operator++() { index--; return *this; }
+		bool operator==(const const_iterator &other) const { return index == other.index; }
+		bool operator!=(const const_iterator &other) const { return index != other.index; }
+		const K &operator*() const { return ptr->entries[index].udata; }
+		const K *operator->() const { return &ptr->entries[index].udata; }
+	};
+
+	class iterator : public std::iterator<std::forward_iterator_tag, K>
+	{
+		friend class flat_pool;
+	protected:
+		flat_pool *ptr;
+		int index;
+		iterator(flat_pool *ptr, int index) : ptr(ptr), index(index) { }
+	public:
+		iterator() { }
+		iterator operator++() { index--; return *this; }
+		bool operator==(const iterator &other) const { return index == other.index; }
+		bool operator!=(const iterator &other) const { return index != other.index; }
+		K &operator*() { return ptr->entries[index].udata; }
+		K *operator->() { return &ptr->entries[index].udata; }
+		const K &operator*() const { return ptr->entries[index].udata; }
+		const K *operator->() const { return &ptr->entries[index].udata; }
+		operator const_iterator() const { return const_iterator(ptr, index); }
+	};
+
+	flat_pool()
+	{
+	}
+
+	flat_pool(const flat_pool &other)
+	{
+		entries = other.entries;
+		do_rehash(entries.size());
+	}
+
+	flat_pool(flat_pool &&other)
+	{
+		swap(other);
+	}
+
+	flat_pool &operator=(const flat_pool &other) {
+		entries = other.entries;
+		do_rehash(entries.size());
+		return *this;
+	}
+
+	flat_pool &operator=(flat_pool &&other) {
+		clear();
+		swap(other);
+		return *this;
+	}
+
+	flat_pool(const std::initializer_list<K> &list)
+	{
+		for (auto &it : list)
+			insert(it);
+	}
+
+	template<class InputIterator>
+	flat_pool(InputIterator first, InputIterator last)
+	{
+		insert(first, last);
+	}
+
+	template<class InputIterator>
+	void insert(InputIterator first, InputIterator last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+
+	std::pair<iterator, bool> insert(const K &value)
+	{
+		unsigned int hash = do_hash(value);
+		int i = do_lookup(value, hash);
+		if (i >= 0)
+			return std::pair<iterator, bool>(iterator(this, i), false);
+		i = do_insert(value, hash);
+		return std::pair<iterator, bool>(iterator(this, i), true);
+	}
+
+	int erase(const K &key)
+	{
+		return do_erase(do_lookup(key, do_hash(key)));
+	}
+
+	iterator erase(iterator it)
+	{
+		do_erase(it.index);
+		return ++it;
+	}
+
+	int count(const K &key) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		return i < 0 ? 0 : 1;
+	}
+
+	int count(const K &key, const_iterator it) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		return i < 0 || i > it.index ? 0 : 1;
+	}
+
+	iterator find(const K &key)
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			return end();
+		return iterator(this, i);
+	}
+
+	const_iterator find(const K &key) const
+	{
+		int i = do_lookup(key, do_hash(key));
+		if (i < 0)
+			return end();
+		return const_iterator(this, i);
+	}
+
+	bool operator[](const K &key)
+	{
+		return do_lookup(key, do_hash(key)) >= 0;
+	}
+
+	template<typename Compare = std::less<K>>
+	void sort(Compare comp = Compare())
+	{
+		std::sort(entries.begin(), entries.end(), [comp](const entry_t &a, const entry_t &b){ return comp(b.udata, a.udata); });
+		do_rehash(entries.size());
+	}
+
+	K pop()
+	{
+		iterator it = begin();
+		K ret = *it;
+		erase(it);
+		return ret;
+	}
+
+	void swap(flat_pool &other)
+	{
+		index.swap(other.index);
+		entries.swap(other.entries);
+	}
+
+	bool operator==(const flat_pool &other) const {
+		if (size() != other.size())
+			return false;
+		for (auto &it : entries)
+			if (!other.count(it.udata))
+				return false;
+		return true;
+	}
+
+	bool operator!=(const flat_pool &other) const {
+		return !operator==(other);
+	}
+
+	unsigned int hash() const {
+		unsigned int hashval = mkhash_init;
+		for (auto &it : entries)
+			hashval ^= it.hash;
+		return hashval;
+	}
+
+	void reserve(size_t n) {
+		entries.reserve(n);
+		if (2 * int(n) > index.capacity())
+			do_rehash(n);
+	}
+
+	size_t size() const { return entries.size(); }
+	bool empty() const { return entries.empty(); }
+	void clear() { index.clear(); entries.clear(); }
+
+	iterator begin() { return iterator(this, int(entries.size())-1); }
+	iterator element(int n) { return iterator(this, int(entries.size())-1-n); }
+	iterator end() { return iterator(nullptr, -1); }
+
+	const_iterator begin() const { return const_iterator(this, int(entries.size())-1); }
+	const_iterator element(int n) const { return const_iterator(this, int(entries.size())-1-n); }
+	const_iterator end() const { return const_iterator(nullptr, -1); }
+};
+
 } /* namespace hashlib */
 
 #endif
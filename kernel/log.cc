@@ -58,7 +58,25 @@ void (*log_error_atexit)() = NULL;
 
 int log_make_debug = 0;
 int log_force_debug = 0;
-int log_debug_suppressed = 0;
+thread_local int log_debug_suppressed = 0;
+
+struct LogTraceRegistry
+{
+	std::multimap<std::string, LogTraceChannel*> channels;
+	std::map<std::string, bool> settings;
+	bool all_enabled = false;
+
+	static LogTraceRegistry &get() {
+		// constructed on first use, channels are created during static init
+		static LogTraceRegistry registry;
+		return registry;
+	}
+
+	bool is_enabled(const std::string &name) const {
+		auto it = settings.find(name);
+		return it != settings.end() ? it->second : all_enabled;
+	}
+};
 
 vector<int> header_count;
 vector<char*> log_id_cache;
@@ -69,6 +87,8 @@ static struct timeval initial_tv = { 0, 0 };
 static bool next_print_log = false;
 static int log_newline_count = 0;
 
+static thread_local LogBuffer *log_buffer = nullptr;
+
 static void log_id_cache_clear()
 {
 	for (auto p : log_id_cache)
@@ -96,21 +116,8 @@ int gettimeofday(struct timeval *tv, struct timezone *tz)
 }
 #endif
 
-void logv(const char *format, va_list ap)
+static void log_write(const std::string &str, bool ends_line)
 {
-	while (format[0] == '\n' && format[1] != 0) {
-		log("\n");
-		format++;
-	}
-
-	if (log_make_debug && !ys_debug(1))
-		return;
-
-	std::string str = vstringf(format, ap);
-
-	if (str.empty())
-		return;
-
 	size_t nnl_pos = str.find_last_not_of('\n');
 	if (nnl_pos == std::string::npos)
 		log_newline_count += GetSize(str);
@@ -139,7 +146,7 @@ void logv(const char *format, va_list ap)
 			time_str += stringf("[%05d.%06d] ", int(tv.tv_sec), int(tv.tv_usec));
 		}
 
-		if (format[0] && format[strlen(format)-1] == '\n')
+		if (ends_line)
 			next_print_log = true;
 
 		for (auto f : log_files)
@@ -182,10 +189,38 @@ void logv(const char *format, va_list ap)
 	}
 }
 
+void logv(const char *format, va_list ap)
+{
+	while (format[0] == '\n' && format[1] != 0) {
+		log("\n");
+		format++;
+	}
+
+	if (log_make_debug && !ys_debug(1))
+		return;
+
+	std::string str = vstringf(format, ap);
+
+	if (str.empty())
+		return;
+
+	if (log_buffer) {
+		log_buffer->entries.push_back({LogBuffer::ENTRY_TEXT, std::string(), str});
+		return;
+	}
+
+	log_write(str, format[0] && format[strlen(format)-1] == '\n');
+}
+
 void logv_header(RTLIL::Design *design, const char *format, va_list ap)
 {
 	bool pop_errfile = false;
 
+	if (log_buffer) {
+		log_buffer->entries.push_back({LogBuffer::ENTRY_HEADER, std::string(), vstringf(format, ap)});
+		return;
+	}
+
 	log_spacer();
 	if (header_count.size() > 0)
 		header_count.back()++;
@@ -221,10 +256,8 @@ void logv_header(RTLIL::Design *design, const char *format, va_list ap)
 		log_files.pop_back();
 }
 
-static void logv_warning_with_prefix(const char *prefix,
-                                     const char *format, va_list ap)
+static void log_warning_with_prefix(const char *prefix, const std::string &message)
 {
-	std::string message = vstringf(format, ap);
 	bool suppressed = false;
 
 	for (auto &re : log_nowarn_regexes)
@@ -268,6 +301,19 @@ static void logv_warning_with_prefix(const char *prefix,
 	}
 }
 
+static void logv_warning_with_prefix(const char *prefix,
+                                     const char *format, va_list ap)
+{
+	std::string message = vstringf(format, ap);
+
+	if (log_buffer) {
+		log_buffer->entries.push_back({LogBuffer::ENTRY_WARNING, prefix, message});
+		return;
+	}
+
+	log_warning_with_prefix(prefix, message);
+}
+
 void logv_warning(const char *format, va_list ap)
 {
 	logv_warning_with_prefix("Warning: ", format, ap);
@@ -301,8 +347,7 @@ void log_file_info(const std::string &filename, int lineno,
 }
 
 YS_ATTRIBUTE(noreturn)
-static void logv_error_with_prefix(const char *prefix,
-                                   const char *format, va_list ap)
+static void log_error_with_prefix(const char *prefix, const std::string &message)
 {
 #ifdef EMSCRIPTEN
 	auto backup_log_files = log_files;
@@ -319,7 +364,7 @@ static void logv_error_with_prefix(const char *prefix,
 			if (f == stdout)
 				f = stderr;
 
-	log_last_error = vstringf(format, ap);
+	log_last_error = message;
 	log("%s%s", prefix, log_last_error.c_str());
 	log_flush();
 
@@ -338,6 +383,20 @@ static void logv_error_with_prefix(const char *prefix,
 #endif
 }
 
+YS_ATTRIBUTE(noreturn)
+static void logv_error_with_prefix(const char *prefix,
+                                   const char *format, va_list ap)
+{
+	std::string message = vstringf(format, ap);
+
+	if (log_buffer) {
+		log_buffer->entries.push_back({LogBuffer::ENTRY_ERROR, prefix, message});
+		throw log_buffer_error_exception();
+	}
+
+	log_error_with_prefix(prefix, message);
+}
+
 void logv_error(const char *format, va_list ap)
 {
 	logv_error_with_prefix("ERROR: ", format, ap);
@@ -397,6 +456,11 @@ void log_cmd_error(const char *format, ...)
 	va_list ap;
 	va_start(ap, format);
 
+	if (log_buffer) {
+		log_buffer->entries.push_back({LogBuffer::ENTRY_CMD_ERROR, std::string(), vstringf(format, ap)});
+		throw log_buffer_error_exception();
+	}
+
 	if (log_cmd_error_throw) {
 		log_last_error = vstringf(format, ap);
 		log("ERROR: %s", log_last_error.c_str());
@@ -407,19 +471,134 @@ void log_cmd_error(const char *format, ...)
 	logv_error(format, ap);
 }
 
+LogTraceChannel::LogTraceChannel(const char *name) : name(name)
+{
+	LogTraceRegistry &registry = LogTraceRegistry::get();
+	enabled = registry.is_enabled(name);
+	registry.channels.insert(std::make_pair(std::string(name), this));
+}
+
+LogTraceChannel::~LogTraceChannel()
+{
+	auto &channels = LogTraceRegistry::get().channels;
+	auto range = channels.equal_range(name);
+	for (auto it = range.first; it != range.second; ++it)
+		if (it->second == this) {
+			channels.erase(it);
+			break;
+		}
+}
+
+void log_trace_enable(const std::string &name, bool enable)
+{
+	LogTraceRegistry &registry = LogTraceRegistry::get();
+	if (name == "*") {
+		registry.settings.clear();
+		registry.all_enabled = enable;
+	} else
+		registry.settings[name] = enable;
+	for (auto &it : registry.channels)
+		it.second->enabled = registry.is_enabled(it.first);
+}
+
+bool log_trace_enabled(const std::string &name)
+{
+	return LogTraceRegistry::get().is_enabled(name);
+}
+
+std::vector<std::string> log_trace_channel_names()
+{
+	std::vector<std::string> names;
+	for (auto &it : LogTraceRegistry::get().channels)
+		if (names.empty() || names.back() != it.first)
+			names.push_back(it.first);
+	return names;
+}
+
+LogBuffer::~LogBuffer()
+{
+	clear_caches();
+}
+
+void LogBuffer::clear_caches()
+{
+	for (auto p : id_cache)
+		free(p);
+	id_cache.clear();
+	string_buf.clear();
+	string_buf_index = -1;
+}
+
+void log_buffer_begin(LogBuffer *buffer)
+{
+	log_assert(log_buffer == nullptr);
+	log_buffer = buffer;
+	log_debug_suppressed = 0;
+}
+
+void log_buffer_end()
+{
+	log_buffer->debug_suppressed += log_debug_suppressed;
+	log_debug_suppressed = 0;
+	log_buffer = nullptr;
+}
+
+bool log_buffer_active()
+{
+	return log_buffer != nullptr;
+}
+
+void log_buffer_replay(LogBuffer &buffer)
+{
+	log_assert(log_buffer == nullptr);
+	log_debug_suppressed += buffer.debug_suppressed;
+
+	for (auto &entry : buffer.entries)
+		switch (entry.type)
+		{
+		case LogBuffer::ENTRY_TEXT:
+			log_write(entry.text, entry.text.back() == '\n');
+			break;
+		case LogBuffer::ENTRY_HEADER:
+			log_header(nullptr, "%s", entry.text.c_str());
+			break;
+		case LogBuffer::ENTRY_SPACER:
+			log_spacer();
+			break;
+		case LogBuffer::ENTRY_WARNING:
+			log_warning_with_prefix(entry.prefix.c_str(), entry.text);
+			break;
+		case LogBuffer::ENTRY_ERROR:
+			log_error_with_prefix(entry.prefix.c_str(), entry.text);
+		case LogBuffer::ENTRY_CMD_ERROR:
+			log_cmd_error("%s", entry.text.c_str());
+		}
+}
+
 void log_spacer()
 {
+	if (log_buffer) {
+		log_buffer->entries.push_back({LogBuffer::ENTRY_SPACER, std::string(), std::string()});
+		return;
+	}
+
 	if (log_newline_count < 2) log("\n");
 	if (log_newline_count < 2) log("\n");
 }
 
 void log_push()
 {
+	if (log_buffer)
+		return;
 	header_count.push_back(0);
 }
 
 void log_pop()
 {
+	if (log_buffer) {
+		log_buffer->clear_caches();
+		return;
+	}
 	header_count.pop_back();
 	log_id_cache_clear();
 	string_buf.clear();
@@ -536,6 +715,9 @@ void log_reset_stack()
 
 void log_flush()
 {
+	if (log_buffer)
+		return;
+
 	for (auto f : log_files)
 		fflush(f);
 
@@ -555,44 +737,43 @@ void log_dump_val_worker(RTLIL::State v) {
 	log("%s", log_signal(v));
 }
 
-const char *log_signal(const RTLIL::SigSpec &sig, bool autoint)
+static const char *log_str_buf(const std::string &str)
 {
-	std::stringstream buf;
-	ILANG_BACKEND::dump_sigspec(buf, sig, autoint);
+	vector<shared_str> &buf = log_buffer ? log_buffer->string_buf : string_buf;
+	int &buf_index = log_buffer ? log_buffer->string_buf_index : string_buf_index;
 
-	if (string_buf.size() < 100) {
-		string_buf.push_back(buf.str());
-		return string_buf.back().c_str();
+	if (buf.size() < 100) {
+		buf.push_back(str);
+		return buf.back().c_str();
 	} else {
-		if (++string_buf_index == 100)
-			string_buf_index = 0;
-		string_buf[string_buf_index] = buf.str();
-		return string_buf[string_buf_index].c_str();
+		if (++buf_index == 100)
+			buf_index = 0;
+		buf[buf_index] = str;
+		return buf[buf_index].c_str();
 	}
 }
 
+const char *log_signal(const RTLIL::SigSpec &sig, bool autoint)
+{
+	std::stringstream buf;
+	ILANG_BACKEND::dump_sigspec(buf, sig, autoint);
+	return log_str_buf(buf.str());
+}
+
 const char *log_const(const RTLIL::Const &value, bool autoint)
 {
 	if ((value.flags & RTLIL::CONST_FLAG_STRING) == 0)
 		return log_signal(value, autoint);
 
 	std::string str = "\"" + value.decode_string() + "\"";
-
-	if (string_buf.size() < 100) {
-		string_buf.push_back(str);
-		return string_buf.back().c_str();
-	} else {
-		if (++string_buf_index == 100)
-			string_buf_index = 0;
-		string_buf[string_buf_index] = str;
-		return string_buf[string_buf_index].c_str();
-	}
+	return log_str_buf(str);
 }
 
 const char *log_id(RTLIL::IdString str)
 {
-	log_id_cache.push_back(strdup(str.c_str()));
-	const char *p = log_id_cache.back();
+	vector<char*> &cache = log_buffer ? log_buffer->id_cache : log_id_cache;
+	cache.push_back(strdup(str.c_str()));
+	const char *p = cache.back();
 	if (p[0] != '\\')
 		return p;
 	if (p[1] == '$' || p[1] == '\\' || p[1] == 0)
@@ -66,7 +66,7 @@ extern void (*log_error_atexit)();
 
 extern int log_make_debug;
 extern int log_force_debug;
-extern int log_debug_suppressed;
+extern thread_local int log_debug_suppressed;
 
 void logv(const char *format, va_list ap);
 void logv_header(RTLIL::Design *design, const char *format, va_list ap);
@@ -126,6 +126,66 @@ struct LogMakeDebugHdl {
 	}
 };
 
+// Trace channels are named debug outputs for hot loops. A channel is defined
+// with YS_TRACE_CHANNEL(name) at file scope and written with
+// log_trace(name, ...). Channels are off by default and are switched on with
+// 'yosys -x <name>' or the 'trace_channel' command. While a channel is off,
+// log_trace() is one predictable branch and its arguments are not evaluated.
+
+struct LogTraceChannel
+{
+	const char *name;
+	bool enabled;
+	LogTraceChannel(const char *name);
+	~LogTraceChannel();
+};
+
+// Switch a channel on or off, "*" matches all channels. The setting also
+// applies to channels that are only defined later, e.g. by a plugin.
+void log_trace_enable(const std::string &name, bool enable = true);
+bool log_trace_enabled(const std::string &name);
+std::vector<std::string> log_trace_channel_names();
+
+#define YS_TRACE_CHANNEL(_name) \
+	static YOSYS_NAMESPACE_PREFIX LogTraceChannel log_trace_channel_##_name(#_name)
+#define log_trace(_name, ...) \
+	do { if (log_trace_channel_##_name.enabled) YOSYS_NAMESPACE_PREFIX log(__VA_ARGS__); } while (0)
+
+// While a module-local pass runs on worker threads (see ModulePass in
+// register.h), each worker logs into its own LogBuffer. The main thread
+// replays the buffers in module order afterwards, so the log reads as if the
+// modules had been processed one after the other. log_error() and
+// log_cmd_error() on a worker record the error and unwind the worker with a
+// log_buffer_error_exception, the error is raised again by the replay.
+
+struct log_buffer_error_exception { };
+
+struct LogBuffer
+{
+	enum entry_type_t { ENTRY_TEXT, ENTRY_HEADER, ENTRY_SPACER, ENTRY_WARNING, ENTRY_ERROR, ENTRY_CMD_ERROR };
+
+	struct entry_t {
+		entry_type_t type;
+		std::string prefix, text;
+	};
+
+	std::vector<entry_t> entries;
+	int debug_suppressed = 0;
+
+	// storage for log_id() and log_signal() results on this thread
+	std::vector<char*> id_cache;
+	std::vector<shared_str> string_buf;
+	int string_buf_index = -1;
+
+	~LogBuffer();
+	void clear_caches();
+};
+
+void log_buffer_begin(LogBuffer *buffer);
+void log_buffer_end();
+bool log_buffer_active();
+void log_buffer_replay(LogBuffer &buffer);
+
 void log_spacer();
 void log_push();
 void log_pop();
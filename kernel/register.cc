@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <thread>
+#include <exception>
 
 #ifdef YOSYS_ENABLE_ZLIB
 #include <zlib.h>
@@ -289,6 +291,9 @@ void Pass::call(RTLIL::Design *design, std::vector<std::string> args)
 	if (pass_register.count(args[0]) == 0)
 		log_cmd_error("No such command: %s (type 'help' for a command overview)\n", args[0].c_str());
 
+	if (log_buffer_active())
+		log_error("Command `%s' called from a module-local pass running on a worker thread.\n", args[0].c_str());
+
 	size_t orig_sel_stack_pos = design->selection_stack.size();
 	auto state = pass_register[args[0]]->pre_execute();
 	pass_register[args[0]]->execute(args, design);
@@ -403,6 +408,80 @@ void ScriptPass::help_script()
 	script();
 }
 
+void ModulePass::finish(RTLIL::Design*)
+{
+}
+
+void ModulePass::execute(std::vector<std::string> args, RTLIL::Design *design)
+{
+	std::vector<RTLIL::Module*> modules = setup(args, design);
+	int threads = std::min(yosys_threads, GetSize(modules));
+
+	if (threads <= 1) {
+		for (auto module : modules)
+			execute_module(module);
+		finish(design);
+		return;
+	}
+
+	enum { NOT_STARTED, DONE, FAILED };
+	std::vector<LogBuffer> buffers(modules.size());
+	std::vector<int> status(modules.size(), NOT_STARTED);
+	std::vector<std::exception_ptr> exceptions(modules.size());
+	std::atomic<int> next_module(0);
+	std::atomic<bool> failed(false);
+
+	auto worker = [&]() {
+		while (!failed) {
+			int idx = next_module++;
+			if (idx >= GetSize(modules))
+				break;
+			log_buffer_begin(&buffers[idx]);
+			try {
+				execute_module(modules[idx]);
+				status[idx] = DONE;
+			} catch (log_buffer_error_exception&) {
+				status[idx] = FAILED;
+				failed = true;
+			} catch (...) {
+				exceptions[idx] = std::current_exception();
+				status[idx] = FAILED;
+				failed = true;
+			}
+			log_buffer_end();
+		}
+	};
+
+	{
+		RTLIL::IdString::threads_guard_t ids_guard;
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; i++)
+			workers.emplace_back(worker);
+		for (auto &it : workers)
+			it.join();
+	}
+
+	// the logs of all modules that completed are replayed first, also those
+	// after a failed module, then the first failure in module order is raised
+	// again: a log_error() by the replay of the buffer that recorded it, any
+	// other exception by rethrowing it after its partial log
+	int first_failed = -1;
+	for (int i = 0; i < GetSize(modules); i++) {
+		if (status[i] == DONE)
+			log_buffer_replay(buffers[i]);
+		else if (status[i] == FAILED && first_failed < 0)
+			first_failed = i;
+	}
+
+	if (first_failed >= 0) {
+		log_buffer_replay(buffers[first_failed]);
+		if (exceptions[first_failed])
+			std::rethrow_exception(exceptions[first_failed]);
+	}
+
+	finish(design);
+}
+
 Frontend::Frontend(std::string name, std::string short_help) :
 		Pass(name.rfind("=", 0) == 0 ? name.substr(1) : "read_" + name, short_help),
 		frontend_name(name.rfind("=", 0) == 0 ? name.substr(1) : name)
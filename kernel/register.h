@@ -80,6 +80,28 @@ struct ScriptPass : Pass
 	void help_script();
 };
 
+// A module-local pass only reads and changes the module it is working on.
+// It parses its arguments in setup(), which returns the modules to work on,
+// and then execute_module() is called for each of them. With 'yosys -j N'
+// the modules are processed by up to N threads, the log output of each
+// module is buffered and written out in module order.
+//
+// execute_module() must not touch other modules or the design (other than
+// reading the selection), must not call other passes and must not change
+// pass members. Use NEW_ID for new names, plain autoidx++ isn't thread-safe.
+// finish() is called on the main thread once all modules are done.
+
+struct ModulePass : Pass
+{
+	ModulePass(std::string name, std::string short_help = "** document me **") : Pass(name, short_help) { }
+
+	virtual std::vector<RTLIL::Module*> setup(std::vector<std::string> args, RTLIL::Design *design) = 0;
+	virtual void execute_module(RTLIL::Module *module) = 0;
+	virtual void finish(RTLIL::Design *design);
+
+	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE YS_FINAL;
+};
+
 struct Frontend : Pass
 {
 	// for reading of here documents
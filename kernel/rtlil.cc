@@ -28,18 +28,94 @@
 
 YOSYS_NAMESPACE_BEGIN
 
-RTLIL::IdString::destruct_guard_t RTLIL::IdString::destruct_guard;
-std::vector<char*> RTLIL::IdString::global_id_storage_;
-dict<char*, int, hash_cstr_ops> RTLIL::IdString::global_id_index_;
+constexpr int RTLIL::IdString::storage_chunk_bits;
+constexpr int RTLIL::IdString::storage_max_chunks;
+constexpr int RTLIL::IdString::index_shards;
+
+std::atomic<RTLIL::IdString::storage_entry_t*> RTLIL::IdString::global_id_storage_[RTLIL::IdString::storage_max_chunks];
+RTLIL::IdString::index_shard_t RTLIL::IdString::global_id_index_[RTLIL::IdString::index_shards];
+std::mutex RTLIL::IdString::global_id_alloc_mutex_;
+std::atomic<int> RTLIL::IdString::global_threads_guards_;
+int RTLIL::IdString::global_id_count_;
 #ifndef YOSYS_NO_IDS_REFCNT
-std::vector<int> RTLIL::IdString::global_refcount_storage_;
 std::vector<int> RTLIL::IdString::global_free_idx_list_;
 #endif
+RTLIL::IdString::destruct_guard_t RTLIL::IdString::destruct_guard;
 #ifdef YOSYS_USE_STICKY_IDS
 int RTLIL::IdString::last_created_idx_[8];
 int RTLIL::IdString::last_created_idx_ptr_;
 #endif
 
+RTLIL::IdString::destruct_guard_t::destruct_guard_t()
+{
+	// index 0 is the empty string, it is never looked up or freed
+	new_index();
+	storage(0).str = (char*)"";
+	ok = true;
+}
+
+int RTLIL::IdString::new_index()
+{
+	auto lock = lock_if_threaded(global_id_alloc_mutex_);
+
+#ifndef YOSYS_NO_IDS_REFCNT
+	if (!global_free_idx_list_.empty()) {
+		int idx = global_free_idx_list_.back();
+		global_free_idx_list_.pop_back();
+		return idx;
+	}
+#endif
+
+	log_assert(global_id_count_ < 0x40000000);
+	int idx = global_id_count_++;
+
+	std::atomic<storage_entry_t*> &chunk = global_id_storage_[idx >> storage_chunk_bits];
+	if (chunk.load(std::memory_order_relaxed) == nullptr)
+		chunk.store(new storage_entry_t[1 << storage_chunk_bits](), std::memory_order_release);
+	return idx;
+}
+
+#ifndef YOSYS_NO_IDS_REFCNT
+void RTLIL::IdString::free_index(int idx)
+{
+	storage_entry_t &entry = storage(idx);
+	char *str = entry.str;
+
+	{
+		index_shard_t &shard = index_shard(str);
+		auto lock = lock_if_threaded(shard.mutex);
+
+		// the name may have been looked up again since the refcount was checked
+		int refcount = entry.refcount.fetch_sub(1, std::memory_order_acq_rel);
+		if (refcount > 1)
+			return;
+
+		log_assert(refcount == 1);
+
+		if (yosys_xtrace) {
+			log("#X# Removed IdString '%s' with index %d.\n", str, idx);
+			log_backtrace("-X- ", yosys_xtrace-1);
+		}
+
+		shard.index.erase(str);
+		entry.str = nullptr;
+	}
+
+	free(str);
+
+	auto lock = lock_if_threaded(global_id_alloc_mutex_);
+	global_free_idx_list_.push_back(idx);
+}
+#endif
+
+// objects may be created by module-local passes running on worker threads
+static unsigned int next_hashidx(std::atomic<unsigned int> &hashidx_count)
+{
+	unsigned int hashidx = hashidx_count.load(std::memory_order_relaxed);
+	while (!hashidx_count.compare_exchange_weak(hashidx, mkhash_xorshift(hashidx), std::memory_order_relaxed)) { }
+	return mkhash_xorshift(hashidx);
+}
+
 IdString RTLIL::ID::A;
 IdString RTLIL::ID::B;
 IdString RTLIL::ID::Y;
@@ -379,9 +455,8 @@ void RTLIL::Selection::optimize(RTLIL::Design *design)
 
 RTLIL::Design::Design()
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static std::atomic<unsigned int> hashidx_count(123456789);
+	hashidx_ = next_hashidx(hashidx_count);
 
 	refcount_modules_ = 0;
 	selection_stack.push_back(RTLIL::Selection());
@@ -660,9 +735,8 @@ std::vector<RTLIL::Module*> RTLIL::Design::selected_whole_modules_warn() const
 
 RTLIL::Module::Module()
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static std::atomic<unsigned int> hashidx_count(123456789);
+	hashidx_ = next_hashidx(hashidx_count);
 
 	design = nullptr;
 	refcount_wires_ = 0;
@@ -676,11 +750,11 @@ RTLIL::Module::Module()
 RTLIL::Module::~Module()
 {
 	for (auto it = wires_.begin(); it != wires_.end(); ++it)
-		delete it->second;
+		destroy(it->second);
 	for (auto it = memories.begin(); it != memories.end(); ++it)
 		delete it->second;
 	for (auto it = cells_.begin(); it != cells_.end(); ++it)
-		delete it->second;
+		destroy(it->second);
 	for (auto it = processes.begin(); it != processes.end(); ++it)
 		delete it->second;
 #ifdef WITH_PYTHON
@@ -709,7 +783,7 @@ void RTLIL::Module::makeblackbox()
 	memories.clear();
 
 	for (auto it = cells_.begin(); it != cells_.end(); ++it)
-		delete it->second;
+		destroy(it->second);
 	cells_.clear();
 
 	for (auto it = processes.begin(); it != processes.end(); ++it)
@@ -1571,6 +1645,18 @@ void RTLIL::Module::add(RTLIL::Cell *cell)
 	cell->module = this;
 }
 
+void RTLIL::Module::destroy(RTLIL::Wire *wire)
+{
+	wire->~Wire();
+	wire_pool_.release(wire);
+}
+
+void RTLIL::Module::destroy(RTLIL::Cell *cell)
+{
+	cell->~Cell();
+	cell_pool_.release(cell);
+}
+
 void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 {
 	log_assert(refcount_wires_ == 0);
@@ -1616,7 +1702,7 @@ void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 	for (auto &it : wires) {
 		log_assert(wires_.count(it->name) != 0);
 		wires_.erase(it->name);
-		delete it;
+		destroy(it);
 	}
 }
 
@@ -1628,7 +1714,7 @@ void RTLIL::Module::remove(RTLIL::Cell *cell)
 	log_assert(cells_.count(cell->name) != 0);
 	log_assert(refcount_cells_ == 0);
 	cells_.erase(cell->name);
-	delete cell;
+	destroy(cell);
 }
 
 void RTLIL::Module::rename(RTLIL::Wire *wire, RTLIL::IdString new_name)
@@ -1805,7 +1891,7 @@ void RTLIL::Module::fixup_ports()
 
 RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, int width)
 {
-	RTLIL::Wire *wire = new RTLIL::Wire;
+	RTLIL::Wire *wire = new (wire_pool_.allocate()) RTLIL::Wire;
 	wire->name = name;
 	wire->width = width;
 	add(wire);
@@ -1827,7 +1913,7 @@ RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, const RTLIL::Wire *oth
 
 RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, RTLIL::IdString type)
 {
-	RTLIL::Cell *cell = new RTLIL::Cell;
+	RTLIL::Cell *cell = new (cell_pool_.allocate()) RTLIL::Cell;
 	cell->name = name;
 	cell->type = type;
 	add(cell);
@@ -2372,9 +2458,8 @@ RTLIL::SigSpec RTLIL::Module::Initstate(RTLIL::IdString name, const std::string
 
 RTLIL::Wire::Wire()
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static std::atomic<unsigned int> hashidx_count(123456789);
+	hashidx_ = next_hashidx(hashidx_count);
 
 	module = nullptr;
 	width = 1;
@@ -2406,9 +2491,8 @@ std::map<unsigned int, RTLIL::Wire*> *RTLIL::Wire::get_all_wires(void)
 
 RTLIL::Memory::Memory()
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static std::atomic<unsigned int> hashidx_count(123456789);
+	hashidx_ = next_hashidx(hashidx_count);
 
 	width = 1;
 	start_offset = 0;
@@ -2420,9 +2504,8 @@ RTLIL::Memory::Memory()
 
 RTLIL::Cell::Cell() : module(nullptr)
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static std::atomic<unsigned int> hashidx_count(123456789);
+	hashidx_ = next_hashidx(hashidx_count);
 
 	// log("#memtrace# %p\n", this);
 	memhasher();
@@ -2970,6 +3053,15 @@ void RTLIL::SigSpec::pack() const
 	std::vector<RTLIL::SigBit> old_bits;
 	old_bits.swap(that->bits_);
 
+	// size the chunk vector exactly, a SigSpec is often stored packed for a long time
+	int num_chunks = 0;
+	for (int i = 0; i < GetSize(old_bits); i++) {
+		const RTLIL::SigBit &bit = old_bits[i];
+		if (i == 0 || bit.wire != old_bits[i-1].wire || (bit.wire != NULL && bit.offset != old_bits[i-1].offset + 1))
+			num_chunks++;
+	}
+	that->chunks_.reserve(num_chunks);
+
 	RTLIL::SigChunk *last = NULL;
 	int last_end_offset = 0;
 
@@ -3008,10 +3100,19 @@ void RTLIL::SigSpec::unpack() const
 		for (int i = 0; i < c.width; i++)
 			that->bits_.push_back(RTLIL::SigBit(c, i));
 
-	that->chunks_.clear();
+	// release the chunk storage instead of keeping both representations allocated
+	std::vector<RTLIL::SigChunk>().swap(that->chunks_);
 	that->hash_ = 0;
 }
 
+size_t RTLIL::SigSpec::alloc_bytes() const
+{
+	size_t bytes = chunks_.capacity() * sizeof(RTLIL::SigChunk) + bits_.capacity() * sizeof(RTLIL::SigBit);
+	for (auto &c : chunks_)
+		bytes += c.data.capacity() * sizeof(RTLIL::State);
+	return bytes;
+}
+
 void RTLIL::SigSpec::updhash() const
 {
 	RTLIL::SigSpec *that = (RTLIL::SigSpec*)this;
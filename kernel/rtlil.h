@@ -58,6 +58,7 @@ namespace RTLIL
 	struct Selection;
 	struct Monitor;
 	struct Design;
+	template<typename T> struct ObjectPool;
 	struct Module;
 	struct Wire;
 	struct Memory;
@@ -82,17 +83,44 @@ namespace RTLIL
 		#undef YOSYS_NO_IDS_REFCNT
 
 		// the global id string cache
+		//
+		// The cache may be used from several threads at once. Names and
+		// refcounts are stored in chunks that are never moved or freed, so an
+		// index stays valid and c_str() and copying an IdString that is
+		// already held need no lock. Looking up a name locks one shard of the
+		// name index, selected by the hash of the name, and dropping the last
+		// reference to a name locks the same shard to remove it. The locks are
+		// only taken while a threads_guard_t exists, code that starts threads
+		// using IdStrings must hold one until they are joined.
 
 		static struct destruct_guard_t {
 			bool ok; // POD, will be initialized to zero
-			destruct_guard_t() { ok = true; }
+			destruct_guard_t();
 			~destruct_guard_t() { ok = false; }
 		} destruct_guard;
 
-		static std::vector<char*> global_id_storage_;
-		static dict<char*, int, hash_cstr_ops> global_id_index_;
+		struct storage_entry_t {
+			char *str;
+		#ifndef YOSYS_NO_IDS_REFCNT
+			std::atomic<int> refcount;
+		#endif
+		};
+
+		static constexpr int storage_chunk_bits = 14;
+		static constexpr int storage_max_chunks = 0x40000000 >> storage_chunk_bits;
+		static constexpr int index_shards = 64;
+
+		struct index_shard_t {
+			std::mutex mutex;
+			dict<char*, int, hash_cstr_ops> index;
+		};
+
+		static std::atomic<storage_entry_t*> global_id_storage_[storage_max_chunks];
+		static index_shard_t global_id_index_[index_shards];
+		static std::mutex global_id_alloc_mutex_;
+		static std::atomic<int> global_threads_guards_;
+		static int global_id_count_;
 	#ifndef YOSYS_NO_IDS_REFCNT
-		static std::vector<int> global_refcount_storage_;
 		static std::vector<int> global_free_idx_list_;
 	#endif
 
@@ -101,15 +129,44 @@ namespace RTLIL
 		static int last_created_idx_[8];
 	#endif
 
+		static inline storage_entry_t &storage(int idx)
+		{
+			storage_entry_t *chunk = global_id_storage_[idx >> storage_chunk_bits].load(std::memory_order_acquire);
+			return chunk[idx & ((1 << storage_chunk_bits) - 1)];
+		}
+
+		static inline index_shard_t &index_shard(const char *p)
+		{
+			return global_id_index_[hash_cstr_ops::hash(p) % index_shards];
+		}
+
+		struct threads_guard_t {
+			threads_guard_t() { global_threads_guards_++; }
+			~threads_guard_t() { global_threads_guards_--; }
+		};
+
+		// starting and joining the threads orders this load with the
+		// changes of the counter
+		static inline std::unique_lock<std::mutex> lock_if_threaded(std::mutex &mutex)
+		{
+			std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+			if (global_threads_guards_.load(std::memory_order_relaxed) != 0)
+				lock.lock();
+			return lock;
+		}
+
+		static int new_index();
+		static void free_index(int idx);
+
 		static inline void xtrace_db_dump()
 		{
 		#ifdef YOSYS_XTRACE_GET_PUT
-			for (int idx = 0; idx < GetSize(global_id_storage_); idx++)
+			for (int idx = 0; idx < global_id_count_; idx++)
 			{
-				if (global_id_storage_.at(idx) == nullptr)
+				if (storage(idx).str == nullptr)
 					log("#X# DB-DUMP index %d: FREE\n", idx);
 				else
-					log("#X# DB-DUMP index %d: '%s' (ref %d)\n", idx, global_id_storage_.at(idx), global_refcount_storage_.at(idx));
+					log("#X# DB-DUMP index %d: '%s' (ref %d)\n", idx, storage(idx).str, storage(idx).refcount.load());
 			}
 		#endif
 		}
@@ -125,6 +182,7 @@ namespace RTLIL
 			}
 		#endif
 		#ifdef YOSYS_SORT_ID_FREE_LIST
+			auto lock = lock_if_threaded(global_id_alloc_mutex_);
 			std::sort(global_free_idx_list_.begin(), global_free_idx_list_.end(), std::greater<int>());
 		#endif
 		}
@@ -133,11 +191,12 @@ namespace RTLIL
 		{
 			if (idx) {
 		#ifndef YOSYS_NO_IDS_REFCNT
-				global_refcount_storage_[idx]++;
+				// the caller holds a reference, so the name can't be freed concurrently
+				storage(idx).refcount.fetch_add(1, std::memory_order_relaxed);
 		#endif
 		#ifdef YOSYS_XTRACE_GET_PUT
 				if (yosys_xtrace)
-					log("#X# GET-BY-INDEX '%s' (index %d, refcount %d)\n", global_id_storage_.at(idx), idx, global_refcount_storage_.at(idx));
+					log("#X# GET-BY-INDEX '%s' (index %d, refcount %d)\n", storage(idx).str, idx, storage(idx).refcount.load());
 		#endif
 			}
 			return idx;
@@ -153,45 +212,30 @@ namespace RTLIL
 			log_assert(p[0] == '$' || p[0] == '\\');
 			log_assert(p[1] != 0);
 
-			auto it = global_id_index_.find((char*)p);
-			if (it != global_id_index_.end()) {
+			int idx;
+			{
+				index_shard_t &shard = index_shard(p);
+				auto lock = lock_if_threaded(shard.mutex);
+
+				auto it = shard.index.find((char*)p);
+				if (it != shard.index.end()) {
 		#ifndef YOSYS_NO_IDS_REFCNT
-				global_refcount_storage_.at(it->second)++;
+					storage(it->second).refcount.fetch_add(1, std::memory_order_relaxed);
 		#endif
 		#ifdef YOSYS_XTRACE_GET_PUT
-				if (yosys_xtrace)
-					log("#X# GET-BY-NAME '%s' (index %d, refcount %d)\n", global_id_storage_.at(it->second), it->second, global_refcount_storage_.at(it->second));
+					if (yosys_xtrace)
+						log("#X# GET-BY-NAME '%s' (index %d, refcount %d)\n", storage(it->second).str, it->second, storage(it->second).refcount.load());
 		#endif
-				return it->second;
-			}
-
-		#ifndef YOSYS_NO_IDS_REFCNT
-			if (global_free_idx_list_.empty()) {
-				if (global_id_storage_.empty()) {
-					global_refcount_storage_.push_back(0);
-					global_id_storage_.push_back((char*)"");
-					global_id_index_[global_id_storage_.back()] = 0;
+					return it->second;
 				}
-				log_assert(global_id_storage_.size() < 0x40000000);
-				global_free_idx_list_.push_back(global_id_storage_.size());
-				global_id_storage_.push_back(nullptr);
-				global_refcount_storage_.push_back(0);
-			}
 
-			int idx = global_free_idx_list_.back();
-			global_free_idx_list_.pop_back();
-			global_id_storage_.at(idx) = strdup(p);
-			global_id_index_[global_id_storage_.at(idx)] = idx;
-			global_refcount_storage_.at(idx)++;
-		#else
-			if (global_id_storage_.empty()) {
-				global_id_storage_.push_back((char*)"");
-				global_id_index_[global_id_storage_.back()] = 0;
-			}
-			int idx = global_id_storage_.size();
-			global_id_storage_.push_back(strdup(p));
-			global_id_index_[global_id_storage_.back()] = idx;
+				idx = new_index();
+				storage(idx).str = strdup(p);
+		#ifndef YOSYS_NO_IDS_REFCNT
+				storage(idx).refcount.store(1, std::memory_order_relaxed);
 		#endif
+				shard.index[storage(idx).str] = idx;
+			}
 
 			if (yosys_xtrace) {
 				log("#X# New IdString '%s' with index %d.\n", p, idx);
@@ -200,7 +244,7 @@ namespace RTLIL
 
 		#ifdef YOSYS_XTRACE_GET_PUT
 			if (yosys_xtrace)
-				log("#X# GET-BY-NAME '%s' (index %d, refcount %d)\n", global_id_storage_.at(idx), idx, global_refcount_storage_.at(idx));
+				log("#X# GET-BY-NAME '%s' (index %d, refcount %d)\n", storage(idx).str, idx, storage(idx).refcount.load());
 		#endif
 
 		#ifdef YOSYS_USE_STICKY_IDS
@@ -219,32 +263,25 @@ namespace RTLIL
 		static inline void put_reference(int idx)
 		{
 			// put_reference() may be called from destructors after the destructor of
-			// global_refcount_storage_ has been run. in this case we simply do nothing.
+			// global_id_index_ has been run. in this case we simply do nothing.
 			if (!destruct_guard.ok || !idx)
 				return;
 
 		#ifdef YOSYS_XTRACE_GET_PUT
 			if (yosys_xtrace) {
-				log("#X# PUT '%s' (index %d, refcount %d)\n", global_id_storage_.at(idx), idx, global_refcount_storage_.at(idx));
+				log("#X# PUT '%s' (index %d, refcount %d)\n", storage(idx).str, idx, storage(idx).refcount.load());
 			}
 		#endif
 
-			int &refcount = global_refcount_storage_[idx];
-
-			if (--refcount > 0)
-				return;
-
-			log_assert(refcount == 0);
-
-			if (yosys_xtrace) {
-				log("#X# Removed IdString '%s' with index %d.\n", global_id_storage_.at(idx), idx);
-				log_backtrace("-X- ", yosys_xtrace-1);
-			}
+			// only the last reference needs the lock, a lookup by name may
+			// take a new reference while it is being dropped
+			std::atomic<int> &refcount = storage(idx).refcount;
+			int count = refcount.load(std::memory_order_relaxed);
+			while (count > 1)
+				if (refcount.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed))
+					return;
 
-			global_id_index_.erase(global_id_storage_.at(idx));
-			free(global_id_storage_.at(idx));
-			global_id_storage_.at(idx) = nullptr;
-			global_free_idx_list_.push_back(idx);
+			free_index(idx);
 		}
 	#else
 		static inline void put_reference(int) { }
@@ -277,11 +314,11 @@ namespace RTLIL
 		}
 
 		inline const char *c_str() const {
-			return global_id_storage_.at(index_);
+			return storage(index_).str;
 		}
 
 		inline std::string str() const {
-			return std::string(global_id_storage_.at(index_));
+			return std::string(storage(index_).str);
 		}
 
 		inline bool operator<(const IdString &rhs) const {
@@ -847,6 +884,9 @@ public:
 	inline const std::vector<RTLIL::SigChunk> &chunks() const { pack(); return chunks_; }
 	inline const std::vector<RTLIL::SigBit> &bits() const { inline_unpack(); return bits_; }
 
+	// heap memory held by this SigSpec, for allocation statistics
+	size_t alloc_bytes() const;
+
 	inline int size() const { return width_; }
 	inline bool empty() const { return width_ == 0; }
 
@@ -1086,6 +1126,72 @@ struct RTLIL::Design
 #endif
 };
 
+// Storage for the wires and cells of one module. Objects are placed in slabs
+// that grow geometrically, and a removed object's slot is reused by the next
+// allocation. All slabs are released together with the module.
+
+template<typename T>
+struct RTLIL::ObjectPool
+{
+	static constexpr int min_slab_slots = 16;
+	static constexpr int max_slab_slots = 16384;
+
+	std::vector<std::pair<char*, int>> slabs;
+	void *free_list = nullptr;
+	int slab_used = 0;
+
+	int live_objects = 0;
+	int64_t total_allocations = 0;
+
+	ObjectPool() { }
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool &operator=(const ObjectPool&) = delete;
+
+	~ObjectPool() {
+		for (auto &slab : slabs)
+			::operator delete(slab.first);
+	}
+
+	static constexpr size_t slot_size() {
+		return ((sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*)) + alignof(T) - 1) / alignof(T) * alignof(T);
+	}
+
+	void *allocate() {
+		live_objects++;
+		total_allocations++;
+		if (free_list != nullptr) {
+			void *p = free_list;
+			free_list = *(void**)p;
+			return p;
+		}
+		if (slabs.empty() || slab_used == slabs.back().second) {
+			int slots = slabs.empty() ? min_slab_slots : 2 * slabs.back().second;
+			if (slots > max_slab_slots)
+				slots = max_slab_slots;
+			slabs.push_back(std::make_pair((char*)::operator new(slots * slot_size()), slots));
+			slab_used = 0;
+		}
+		return slabs.back().first + slot_size() * slab_used++;
+	}
+
+	void release(void *p) {
+		*(void**)p = free_list;
+		free_list = p;
+		live_objects--;
+	}
+
+	int capacity() const {
+		int slots = 0;
+		for (auto &slab : slabs)
+			slots += slab.second;
+		return slots;
+	}
+
+	size_t bytes() const {
+		return capacity() * slot_size();
+	}
+};
+
 struct RTLIL::Module : public RTLIL::AttrObject
 {
 	unsigned int hashidx_;
@@ -1094,6 +1200,8 @@ struct RTLIL::Module : public RTLIL::AttrObject
 protected:
 	void add(RTLIL::Wire *wire);
 	void add(RTLIL::Cell *cell);
+	void destroy(RTLIL::Wire *wire);
+	void destroy(RTLIL::Cell *cell);
 
 public:
 	RTLIL::Design *design;
@@ -1106,6 +1214,9 @@ public:
 	dict<RTLIL::IdString, RTLIL::Cell*> cells_;
 	std::vector<RTLIL::SigSig> connections_;
 
+	RTLIL::ObjectPool<RTLIL::Wire> wire_pool_;
+	RTLIL::ObjectPool<RTLIL::Cell> cell_pool_;
+
 	RTLIL::IdString name;
 	pool<RTLIL::IdString> avail_parameters;
 	dict<RTLIL::IdString, RTLIL::Memory*> memories;
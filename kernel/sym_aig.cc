@@ -0,0 +1,284 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/sym_aig.h"
+#include "z3.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+const int SymAig::False;
+const int SymAig::True;
+
+SymAig::SymAig(z3::context &ctx) : ctx(ctx), leaves(ctx), words(ctx) {
+  // node 0 is the constant false node
+  nodes.push_back(Node{-1, -1});
+  lowered.push_back(ctx.bv_val(0, 1));
+  is_lowered.push_back(true);
+}
+
+int SymAig::new_node(int a, int b) {
+  int idx = GetSize(nodes);
+  nodes.push_back(Node{a, b});
+  lowered.push_back(lowered.front());
+  is_lowered.push_back(false);
+  return idx << 1;
+}
+
+int SymAig::mk_and(int a, int b) {
+  if (a > b)
+    std::swap(a, b);
+
+  // constant propagation and trivial cases
+  if (a == False)
+    return False;
+  if (a == True)
+    return b;
+  if (a == b)
+    return a;
+  if (a == lit_not(b))
+    return False;
+
+  // one-level rewrites against the fanins of AND nodes
+  for (int k = 0; k < 2; k++) {
+    int x = k ? b : a, y = k ? a : b;
+    if (!lit_is_and(x))
+      continue;
+    const Node &n = nodes[lit_node(x)];
+    if (!lit_is_compl(x)) {
+      // (p & q) & p = p & q, (p & q) & ~p = 0
+      if (y == n.a || y == n.b)
+        return x;
+      if (y == lit_not(n.a) || y == lit_not(n.b))
+        return False;
+    } else {
+      // ~(p & q) & ~p = ~p, ~(p & q) & p = p & ~q
+      if (y == lit_not(n.a) || y == lit_not(n.b))
+        return y;
+      if (y == n.a)
+        return mk_and(y, lit_not(n.b));
+      if (y == n.b)
+        return mk_and(y, lit_not(n.a));
+    }
+  }
+
+  if (lit_is_and(a) && lit_is_and(b) && !lit_is_compl(a) && !lit_is_compl(b)) {
+    // (p & q) & (r & s) = 0 if the fanins contradict each other
+    const Node &na = nodes[lit_node(a)], &nb = nodes[lit_node(b)];
+    if (na.a == lit_not(nb.a) || na.a == lit_not(nb.b) ||
+        na.b == lit_not(nb.a) || na.b == lit_not(nb.b))
+      return False;
+  }
+
+  auto key = std::make_pair(a, b);
+  auto it = strash.find(key);
+  if (it != strash.end())
+    return it->second;
+
+  int lit = new_node(a, b);
+  strash[key] = lit;
+  return lit;
+}
+
+int SymAig::mk_xor(int a, int b) {
+  if (a > b)
+    std::swap(a, b);
+
+  if (a == False)
+    return b;
+  if (a == True)
+    return lit_not(b);
+  if (a == b)
+    return False;
+  if (a == lit_not(b))
+    return True;
+
+  // move complements to the output so that a ^ b and ~a ^ ~b share nodes
+  bool compl_out = lit_is_compl(a) != lit_is_compl(b);
+  a &= ~1;
+  b &= ~1;
+
+  int lit = mk_or(mk_and(a, lit_not(b)), mk_and(lit_not(a), b));
+  return compl_out ? lit_not(lit) : lit;
+}
+
+int SymAig::mk_mux(int a, int b, int s) {
+  if (s == False || a == b)
+    return a;
+  if (s == True)
+    return b;
+  if (a == False)
+    return mk_and(s, b);
+  if (b == False)
+    return mk_and(lit_not(s), a);
+  if (a == True)
+    return mk_or(lit_not(s), b);
+  if (b == True)
+    return mk_or(s, a);
+  if (a == lit_not(b))
+    return mk_xor(s, a);
+
+  int sb = mk_and(s, b);
+  if (lit_is_compl(a) && lit_is_and(a)) {
+    // mux(mux(x, b, s), b, s) = mux(x, b, s), i.e. a is ~(~(s & b) & ~(~s & x))
+    const Node &n = nodes[lit_node(a)];
+    int other = n.a == lit_not(sb) ? n.b : n.b == lit_not(sb) ? n.a : -1;
+    if (other >= 0 && lit_is_compl(other) && lit_is_and(other)) {
+      const Node &m = nodes[lit_node(other)];
+      if (m.a == lit_not(s) || m.b == lit_not(s))
+        return a;
+    }
+  }
+  return mk_or(sb, mk_and(lit_not(s), a));
+}
+
+int SymAig::mk_leaf(const z3::expr &e) {
+  auto it = leaf_nodes.find(e.id());
+  if (it != leaf_nodes.end())
+    return it->second;
+
+  int lit = new_node(-1, GetSize(leaves));
+  leaves.push_back(e);
+  leaf_nodes[e.id()] = lit;
+  return lit;
+}
+
+int SymAig::mk_word(const z3::expr &e) {
+  auto it = word_index.find(e.id());
+  if (it != word_index.end())
+    return it->second;
+
+  int idx = GetSize(words);
+  words.push_back(e);
+  word_index[e.id()] = idx;
+  return idx;
+}
+
+int SymAig::mk_slice(int word, int bit) {
+  if (word_width(word) == 1)
+    return mk_leaf(words[word]);
+
+  auto key = std::make_pair(word, bit);
+  auto it = slice_nodes.find(key);
+  if (it != slice_nodes.end())
+    return it->second;
+
+  int lit = new_node(-2, GetSize(slices));
+  slices.push_back(Slice{word, bit});
+  slice_nodes[key] = lit;
+  return lit;
+}
+
+int SymAig::mk_input(const std::string &name) {
+  return mk_leaf(ctx.bv_const(name.c_str(), 1));
+}
+
+int SymAig::import_expr(const z3::expr &e) {
+  if (e.is_numeral())
+    return e.get_numeral_uint() ? True : False;
+
+  if (e.is_app()) {
+    switch (e.decl().decl_kind()) {
+    case Z3_OP_BNOT:
+      return lit_not(import_expr(e.arg(0)));
+    case Z3_OP_EXTRACT:
+      if (e.arg(0).is_numeral())
+        break;
+      return mk_slice(mk_word(e.arg(0)), e.lo());
+    case Z3_OP_BAND:
+    case Z3_OP_BOR:
+    case Z3_OP_BXOR:
+    case Z3_OP_BXNOR: {
+      Z3_decl_kind kind = e.decl().decl_kind();
+      int lit = import_expr(e.arg(0));
+      for (unsigned i = 1; i < e.num_args(); i++) {
+        int arg = import_expr(e.arg(i));
+        if (kind == Z3_OP_BAND)
+          lit = mk_and(lit, arg);
+        else if (kind == Z3_OP_BOR)
+          lit = mk_or(lit, arg);
+        else if (kind == Z3_OP_BXOR)
+          lit = mk_xor(lit, arg);
+        else
+          lit = mk_xnor(lit, arg);
+      }
+      return lit;
+    }
+    default:
+      break;
+    }
+  }
+
+  return mk_leaf(e);
+}
+
+int SymAig::from_expr(const z3::expr &e) {
+  z3::expr ee = e;
+  if (ee.is_bool())
+    ee = z3::ite(ee, ctx.bv_val(1, 1), ctx.bv_val(0, 1));
+  log_assert(ee.is_bv() && ee.get_sort().bv_size() == 1);
+  if (ee.is_numeral())
+    return ee.get_numeral_uint() ? True : False;
+  return import_expr(ee.simplify());
+}
+
+z3::expr SymAig::to_expr(int lit) {
+  // nodes are created after their fanins, so an explicit stack in place of
+  // recursion keeps deep cones from overflowing the C++ stack
+  std::vector<int> stack;
+  stack.push_back(lit_node(lit));
+  while (!stack.empty()) {
+    int idx = stack.back();
+    if (is_lowered[idx]) {
+      stack.pop_back();
+      continue;
+    }
+    const Node &n = nodes[idx];
+    if (n.a < 0) {
+      if (n.a == -1) {
+        lowered[idx] = leaves[n.b];
+      } else {
+        const Slice &sl = slices[n.b];
+        lowered[idx] = words[sl.word].extract(sl.bit, sl.bit);
+      }
+      is_lowered[idx] = true;
+      stack.pop_back();
+      continue;
+    }
+    int ia = lit_node(n.a), ib = lit_node(n.b);
+    if (!is_lowered[ia] || !is_lowered[ib]) {
+      if (!is_lowered[ia])
+        stack.push_back(ia);
+      if (!is_lowered[ib])
+        stack.push_back(ib);
+      continue;
+    }
+    z3::expr ea = lit_is_compl(n.a) ? ~lowered[ia] : lowered[ia];
+    z3::expr eb = lit_is_compl(n.b) ? ~lowered[ib] : lowered[ib];
+    lowered[idx] = ea & eb;
+    is_lowered[idx] = true;
+    stack.pop_back();
+  }
+
+  if (lit == True)
+    return ctx.bv_val(1, 1);
+  const z3::expr &e = lowered[lit_node(lit)];
+  return lit_is_compl(lit) ? ~e : e;
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,105 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SYM_AIG_H
+#define SYM_AIG_H
+
+#include "kernel/yosys.h"
+#include "z3++.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Hash-consed and-inverter graph holding the bit-level values of the
+// symbolic simulator. A literal is (node << 1) | complement. Node 0 is the
+// constant false node, so literal 0 is false and literal 1 is true.
+//
+// Every AND node is structurally hashed and goes through constant
+// propagation and a few one-level rewrites before it is created, so equal
+// functions built the same way end up as the same literal. Leaves wrap
+// arbitrary single-bit Z3 terms (free inputs) or select one bit of a
+// bit-vector term (results of word-level operators). Bit-select leaves keep
+// the word intact, so a value whose bits are consecutive selects of one word
+// can be lowered back to that word; nodes are only lowered to Z3 when a
+// query asks for them.
+struct SymAig {
+  static const int False = 0;
+  static const int True = 1;
+
+  struct Node {
+    // fanin literals of an AND node with a < b, a == -1 marks a leaf whose
+    // term is leaves[b], a == -2 a bit-select leaf described by slices[b]
+    int a, b;
+  };
+
+  struct Slice {
+    // bit 'bit' of words[word]
+    int word, bit;
+  };
+
+  z3::context &ctx;
+  std::vector<Node> nodes;
+  z3::expr_vector leaves;
+  z3::expr_vector words;
+  std::vector<Slice> slices;
+  dict<std::pair<int, int>, int> strash;
+  dict<int, int> leaf_nodes;
+  dict<int, int> word_index;
+  dict<std::pair<int, int>, int> slice_nodes;
+  std::vector<z3::expr> lowered;
+  std::vector<bool> is_lowered;
+
+  SymAig(z3::context &ctx);
+
+  static int lit_not(int a) { return a ^ 1; }
+  static int lit_node(int a) { return a >> 1; }
+  static bool lit_is_compl(int a) { return (a & 1) != 0; }
+  static bool lit_is_const(int a) { return a <= 1; }
+  bool lit_is_and(int a) const { return nodes[a >> 1].a >= 0; }
+  bool lit_is_leaf(int a) const { return a > 1 && nodes[a >> 1].a < 0; }
+  bool lit_is_slice(int a) const { return a > 1 && nodes[a >> 1].a == -2; }
+  const Slice &lit_slice(int a) const { return slices[nodes[a >> 1].b]; }
+
+  int mk_and(int a, int b);
+  int mk_or(int a, int b) { return lit_not(mk_and(lit_not(a), lit_not(b))); }
+  int mk_xor(int a, int b);
+  int mk_xnor(int a, int b) { return lit_not(mk_xor(a, b)); }
+  int mk_mux(int a, int b, int s);
+  int mk_input(const std::string &name);
+  int mk_leaf(const z3::expr &e);
+  // Bit-vector terms are registered once as words, their bits are then
+  // created on demand without building Z3 extract terms.
+  int mk_word(const z3::expr &e);
+  int mk_slice(int word, int bit);
+  int word_width(int word) const { return words[word].get_sort().bv_size(); }
+
+  // Import a single-bit (or Bool) Z3 term. Bit-level operators are rebuilt
+  // as AIG nodes, everything else becomes a leaf.
+  int from_expr(const z3::expr &e);
+  z3::expr to_expr(int lit);
+
+  int size() const { return GetSize(nodes); }
+
+private:
+  int new_node(int a, int b);
+  int import_expr(const z3::expr &e);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
@@ -229,8 +229,9 @@ struct SymCellTypes {
   }
 
   static RTLIL::SymConst eval_not(RTLIL::SymConst v) {
-
-    return (~v.to_expr()).simplify();
+    for (auto &b : v.bits)
+      b = RTLIL::StateSym::CreateNot(b);
+    return v;
   }
 
   static RTLIL::SymConst eval(RTLIL::IdString type, const RTLIL::SymConst &arg1,
@@ -332,7 +333,10 @@ struct SymCellTypes {
     }
 
     if (cell->type == "$concat") {
-      return z3::concat(arg1.to_expr(), arg2.to_expr());
+      RTLIL::SymConst ret = arg1;
+      for (auto &b : arg2.bits)
+        ret.push_back(b);
+      return ret;
     }
 
     if (cell->type == "$lut") {
@@ -418,23 +422,15 @@ struct SymCellTypes {
                               const RTLIL::SymConst &arg3,
                               bool *errp = nullptr) {
     if (cell->type.in("$mux", "$pmux", "$_MUX_")) {
-      z3::expr_vector ret = arg1.bits;
-      size_t result_len = arg1.size();
-      assert(result_len > 0);
-      assert(result_len * arg3.size() == arg2.size());
-      for (int i = 0; i < arg3.size(); ++i) {
-        if (arg3[i].to_state() == State::S1) {
-          return arg2.extract(i * result_len, result_len);
-        }
-        if (arg3[i].to_state() == State::S0)
-          continue;
-        for (int j = 0; j < result_len; ++j) {
-          ret[j] = (arg3[i].to_expr() & arg2[j + i * result_len].to_expr()) |
-                   ((~arg3[i].to_expr()) & arg1[j].to_expr());
-        }
+      RTLIL::SymConst ret = arg1;
+      int result_len = arg1.size();
+      log_assert(result_len * arg3.size() == arg2.size());
+      // lower select bits take priority, so build the chain from the top
+      for (int i = arg3.size() - 1; i >= 0; --i) {
+        for (int j = 0; j < result_len; ++j)
+          ret.bits[j] = RTLIL::StateSym::CreateMux(
+              ret[j], arg2[j + i * result_len], arg3[i]);
       }
-    //  std::cerr << "mux end, ret.to_string=\n";
-      //std::cerr << "=" << ret << "\n";
       return ret;
     }
 
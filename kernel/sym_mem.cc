@@ -0,0 +1,162 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/sym_mem.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+using RTLIL::State;
+using RTLIL::StateSym;
+using RTLIL::SymConst;
+
+SymMemory::SymMemory(const std::string &name, int size, int offset, int abits,
+                     int width, const RTLIL::Const &init, bool zero_undef)
+    : name(name), size(size), offset(offset), abits(abits), width(width),
+      zero_undef(zero_undef) {
+  for (int index = 0; index < size && index * width < GetSize(init); index++) {
+    std::vector<State> bits(width, State::Sx);
+    bool defined = false;
+    for (int i = 0; i < width && index * width + i < GetSize(init); i++) {
+      bits[i] = init.bits[index * width + i];
+      if (bits[i] == State::S0 || bits[i] == State::S1)
+        defined = true;
+    }
+    if (!defined)
+      continue;
+    // undefined bits of a partly initialized word keep their undef value
+    SymConst word = undef_word(address(index));
+    for (int i = 0; i < width; i++)
+      if (bits[i] == State::S0 || bits[i] == State::S1)
+        word.bits[i] = StateSym(bits[i]);
+    words[index] = word;
+  }
+}
+
+SymConst SymMemory::address(int index) const {
+  return SymConst(index + offset, abits);
+}
+
+SymConst SymMemory::undef_word(const SymConst &addr) {
+  if (zero_undef)
+    return SymConst(State::S0, width);
+  z3::context &ctx = sym_context();
+  z3::expr array = ctx.constant(
+      name.c_str(), ctx.array_sort(ctx.bv_sort(abits), ctx.bv_sort(width)));
+  return SymConst(z3::select(array, addr.to_expr()), width);
+}
+
+SymConst SymMemory::known_word(int index) {
+  auto it = words.find(index);
+  if (it != words.end())
+    return it->second;
+  return undef_word(address(index));
+}
+
+int SymMemory::addr_equal(const SymConst &a, const SymConst &b) {
+  auto key = a.hash() <= b.hash() ? std::make_pair(a, b) : std::make_pair(b, a);
+  auto it = addr_equal_cache.find(key);
+  if (it != addr_equal_cache.end())
+    return it->second;
+
+  SymAig &aig = sym_aig();
+  int lit = SymAig::True;
+  for (int i = 0; i < abits && lit != SymAig::False; i++)
+    lit = aig.mk_and(lit, aig.mk_xnor(a[i].lit_, b[i].lit_));
+  addr_equal_cache[key] = lit;
+  return lit;
+}
+
+SymConst SymMemory::read(const SymConst &addr) {
+  SymAig &aig = sym_aig();
+  SymConst value;
+
+  if (addr.is_fully_def()) {
+    int index = addr.as_int() - offset;
+    if (index < 0 || index >= size)
+      return SymConst(State::Sx, width);
+    value = known_word(index);
+  } else {
+    value = undef_word(addr);
+    for (auto &it : words) {
+      int hit = addr_equal(addr, address(it.first));
+      if (hit == SymAig::False)
+        continue;
+      for (int i = 0; i < width; i++)
+        value.bits[i].lit_ =
+            aig.mk_mux(value[i].lit_, it.second[i].lit_, hit);
+    }
+  }
+
+  for (auto &w : writes) {
+    int hit = addr_equal(addr, w.addr);
+    if (hit == SymAig::False)
+      continue;
+    for (int i = 0; i < width; i++)
+      value.bits[i].lit_ = aig.mk_mux(value[i].lit_, w.data[i].lit_,
+                                      aig.mk_and(hit, w.en[i].lit_));
+  }
+  return value;
+}
+
+bool SymMemory::write(const SymConst &addr, const SymConst &data,
+                      const SymConst &en) {
+  if (en.is_fully_zero())
+    return false;
+
+  if (writes.empty() && addr.is_fully_def()) {
+    int index = addr.as_int() - offset;
+    if (index < 0 || index >= size)
+      return false;
+    SymAig &aig = sym_aig();
+    SymConst old_word = known_word(index);
+    SymConst new_word = old_word;
+    for (int i = 0; i < width; i++)
+      new_word.bits[i].lit_ =
+          aig.mk_mux(old_word[i].lit_, data[i].lit_, en[i].lit_);
+    if (new_word == old_word)
+      return false;
+    words[index] = new_word;
+    return true;
+  }
+
+  // the same write repeated (e.g. by an unclocked write port while the
+  // simulator settles) doesn't change anything, as long as no later write
+  // may have hit the same address in between
+  for (int i = GetSize(writes) - 1; i >= 0; i--) {
+    const Write &w = writes[i];
+    if (w.addr == addr && w.data == data && w.en == en)
+      return false;
+    if (addr_equal(addr, w.addr) != SymAig::False)
+      break;
+  }
+
+  writes.push_back(Write{addr, data, en});
+  return true;
+}
+
+SymConst SymMemory::contents() {
+  SymConst value;
+  for (int index = 0; index < size; index++) {
+    SymConst word = read(address(index));
+    value.bits.insert(value.bits.end(), word.bits.begin(), word.bits.end());
+  }
+  return value;
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,69 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SYM_MEM_H
+#define SYM_MEM_H
+
+#include "kernel/calc_sym.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+// Symbolic contents of a $mem cell whose size is independent of the number
+// of words. Known words (initialization and writes to constant addresses)
+// are kept sparsely by index, every other word reads as a select from an
+// unconstrained Z3 array named after the memory (or zero with zero_undef).
+// Writes to symbolic addresses, and every write after the first one of them,
+// go to a write log that read() folds into an ite chain over the address
+// matches, so symbolic reads and writes stay precise without materializing
+// the memory.
+struct SymMemory {
+  std::string name;
+  int size = 0, offset = 0, abits = 0, width = 0;
+  bool zero_undef = false;
+
+  struct Write {
+    RTLIL::SymConst addr, data, en;
+  };
+
+  dict<int, RTLIL::SymConst> words;
+  std::vector<Write> writes;
+  // AIG literal of addr_a == addr_b for address pairs compared before
+  dict<std::pair<RTLIL::SymConst, RTLIL::SymConst>, int> addr_equal_cache;
+
+  SymMemory() {}
+  SymMemory(const std::string &name, int size, int offset, int abits,
+            int width, const RTLIL::Const &init, bool zero_undef = false);
+
+  RTLIL::SymConst read(const RTLIL::SymConst &addr);
+  // Returns true if the contents (may) have changed.
+  bool write(const RTLIL::SymConst &addr, const RTLIL::SymConst &data,
+             const RTLIL::SymConst &en);
+  // Flat SIZE*WIDTH contents, for writing back the INIT parameter.
+  RTLIL::SymConst contents();
+
+private:
+  RTLIL::SymConst address(int index) const;
+  RTLIL::SymConst undef_word(const RTLIL::SymConst &addr);
+  RTLIL::SymConst known_word(int index);
+  int addr_equal(const RTLIL::SymConst &a, const RTLIL::SymConst &b);
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
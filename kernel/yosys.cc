@@ -73,6 +73,7 @@
 YOSYS_NAMESPACE_BEGIN
 
 int autoidx = 1;
+int yosys_threads = 1;
 int yosys_xtrace = 0;
 RTLIL::Design *yosys_design = NULL;
 CellTypes yosys_celltypes;
@@ -594,7 +595,15 @@ RTLIL::IdString new_id(std::string file, int line, std::string func)
 	if (pos != std::string::npos)
 		func = func.substr(pos+1);
 
-	return stringf("$auto$%s:%d:%s$%d", file.c_str(), line, func.c_str(), autoidx++);
+	// NEW_ID may be used by module-local passes running on worker threads
+	static std::mutex autoidx_mutex;
+	int idx;
+	{
+		std::lock_guard<std::mutex> lock(autoidx_mutex);
+		idx = autoidx++;
+	}
+
+	return stringf("$auto$%s:%d:%s$%d", file.c_str(), line, func.c_str(), idx);
 }
 
 RTLIL::Design *yosys_get_design()
@@ -51,6 +51,8 @@
 #include <initializer_list>
 #include <stdexcept>
 #include <memory>
+#include <atomic>
+#include <mutex>
 #include <cmath>
 #include <cstddef>
 
@@ -199,6 +201,8 @@ using hashlib::dict;
 using hashlib::idict;
 using hashlib::pool;
 using hashlib::mfp;
+using hashlib::flat_dict;
+using hashlib::flat_pool;
 
 namespace RTLIL {
 	struct IdString;
@@ -269,6 +273,7 @@ template<typename T> int GetSize(const T &obj) { return obj.size(); }
 int GetSize(RTLIL::Wire *wire);
 
 extern int autoidx;
+extern int yosys_threads;
 extern int yosys_xtrace;
 
 YOSYS_NAMESPACE_END
@@ -286,6 +286,73 @@ void read_liberty_cellarea(dict<IdString, double> &cell_area, string liberty_fil
 	}
 }
 
+struct allocdata_t
+{
+	int64_t wire_allocs = 0, cell_allocs = 0;
+	int wire_slabs = 0, cell_slabs = 0;
+	int live_wires = 0, live_cells = 0;
+	int wire_slots = 0, cell_slots = 0;
+	size_t wire_bytes = 0, cell_bytes = 0;
+	int num_sigspecs = 0;
+	size_t sigspec_bytes = 0;
+
+	allocdata_t() { }
+
+	allocdata_t(RTLIL::Module *mod)
+	{
+		wire_allocs = mod->wire_pool_.total_allocations;
+		wire_slabs = GetSize(mod->wire_pool_.slabs);
+		live_wires = mod->wire_pool_.live_objects;
+		wire_slots = mod->wire_pool_.capacity();
+		wire_bytes = mod->wire_pool_.bytes();
+
+		cell_allocs = mod->cell_pool_.total_allocations;
+		cell_slabs = GetSize(mod->cell_pool_.slabs);
+		live_cells = mod->cell_pool_.live_objects;
+		cell_slots = mod->cell_pool_.capacity();
+		cell_bytes = mod->cell_pool_.bytes();
+
+		for (auto cell : mod->cells())
+			for (auto &conn : cell->connections()) {
+				num_sigspecs++;
+				sigspec_bytes += conn.second.alloc_bytes();
+			}
+
+		for (auto &conn : mod->connections()) {
+			num_sigspecs += 2;
+			sigspec_bytes += conn.first.alloc_bytes() + conn.second.alloc_bytes();
+		}
+	}
+
+	allocdata_t &operator+=(const allocdata_t &other)
+	{
+		wire_allocs += other.wire_allocs;
+		cell_allocs += other.cell_allocs;
+		wire_slabs += other.wire_slabs;
+		cell_slabs += other.cell_slabs;
+		live_wires += other.live_wires;
+		live_cells += other.live_cells;
+		wire_slots += other.wire_slots;
+		cell_slots += other.cell_slots;
+		wire_bytes += other.wire_bytes;
+		cell_bytes += other.cell_bytes;
+		num_sigspecs += other.num_sigspecs;
+		sigspec_bytes += other.sigspec_bytes;
+		return *this;
+	}
+
+	void log_data()
+	{
+		log("   Allocation:\n");
+		log("     Wires      %8d live, %8d slots in %4d slabs, %10llu bytes (%lld allocations)\n",
+				live_wires, wire_slots, wire_slabs, (unsigned long long)wire_bytes, (long long)wire_allocs);
+		log("     Cells      %8d live, %8d slots in %4d slabs, %10llu bytes (%lld allocations)\n",
+				live_cells, cell_slots, cell_slabs, (unsigned long long)cell_bytes, (long long)cell_allocs);
+		log("     SigSpecs   %8d in ports and connections, %10llu bytes of storage\n",
+				num_sigspecs, (unsigned long long)sigspec_bytes);
+	}
+};
+
 struct StatPass : public Pass {
 	StatPass() : Pass("stat", "print some statistics") { }
 	void help() YS_OVERRIDE
@@ -313,12 +380,18 @@ struct StatPass : public Pass {
 		log("        annotate internal cell types with their word width.\n");
 		log("        e.g. $add_8 for an 8 bit wide $add cell.\n");
 		log("\n");
+		log("    -alloc\n");
+		log("        also print memory allocation statistics: the live objects, slots and\n");
+		log("        slabs of the per-module wire and cell pools, and the heap storage\n");
+		log("        held by the SigSpecs in cell ports and connections.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
 	{
 		log_header(design, "Printing statistics.\n");
 
 		bool width_mode = false;
+		bool alloc_mode = false;
 		RTLIL::Module *top_mod = NULL;
 		std::map<RTLIL::IdString, statdata_t> mod_stat;
 		dict<IdString, double> cell_area;
@@ -331,6 +404,10 @@ struct StatPass : public Pass {
 				width_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-alloc") {
+				alloc_mode = true;
+				continue;
+			}
 			if (args[argidx] == "-liberty" && argidx+1 < args.size()) {
 				string liberty_file = args[++argidx];
 				rewrite_filename(liberty_file);
@@ -354,6 +431,9 @@ struct StatPass : public Pass {
 		if (techname != "" && techname != "xilinx" && techname != "cmos")
 			log_cmd_error("Unsupported technology: '%s'\n", techname.c_str());
 
+		allocdata_t alloc_total;
+		int alloc_modules = 0;
+
 		for (auto mod : design->selected_modules())
 		{
 			if (!top_mod && design->full_selection())
@@ -367,6 +447,22 @@ struct StatPass : public Pass {
 			log("=== %s%s ===\n", RTLIL::id2cstr(mod->name), design->selected_whole_module(mod->name) ? "" : " (partially selected)");
 			log("\n");
 			data.log_data(mod->name, false);
+
+			if (alloc_mode) {
+				allocdata_t alloc_data(mod);
+				alloc_total += alloc_data;
+				alloc_modules++;
+				log("\n");
+				alloc_data.log_data();
+			}
+		}
+
+		if (alloc_mode && alloc_modules > 1)
+		{
+			log("\n");
+			log("=== allocation total ===\n");
+			log("\n");
+			alloc_total.log_data();
 		}
 
 		if (top_mod != NULL && GetSize(mod_stat) > 1)
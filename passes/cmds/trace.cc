@@ -128,4 +128,55 @@ struct DebugPass : public Pass {
 	}
 } DebugPass;
 
+struct TraceChannelPass : public Pass {
+	TraceChannelPass() : Pass("trace_channel", "enable or disable trace channels") { }
+	void help() YS_OVERRIDE
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    trace_channel [-off] <channel>...\n");
+		log("\n");
+		log("Enable (or with -off disable) the given trace channels. A trace channel is a\n");
+		log("named debug output in an inner loop of a pass, that is not printed unless it\n");
+		log("is enabled. '*' selects all channels. Channels can also be enabled with the\n");
+		log("'-x' command line option of yosys.\n");
+		log("\n");
+		log("    trace_channel -list\n");
+		log("\n");
+		log("List the available channels and whether they are enabled.\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design*) YS_OVERRIDE
+	{
+		bool enable = true, list = false;
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-off") {
+				enable = false;
+				continue;
+			}
+			if (args[argidx] == "-list") {
+				list = true;
+				continue;
+			}
+			break;
+		}
+
+		if (list) {
+			if (argidx != args.size())
+				cmd_error(args, argidx, "Extra argument with -list.");
+			for (auto &name : log_trace_channel_names())
+				log("%-20s %s\n", name.c_str(), log_trace_enabled(name) ? "on" : "off");
+			return;
+		}
+
+		if (argidx == args.size())
+			cmd_error(args, argidx, "Missing channel name.");
+		for (; argidx < args.size(); argidx++)
+			log_trace_enable(args[argidx], enable);
+	}
+} TraceChannelPass;
+
 PRIVATE_NAMESPACE_END
@@ -480,8 +480,11 @@ struct WreduceWorker
 	}
 };
 
-struct WreducePass : public Pass {
-	WreducePass() : Pass("wreduce", "reduce the word size of operations if possible") { }
+struct WreducePass : public ModulePass {
+	WreduceConfig config;
+	bool opt_memx;
+
+	WreducePass() : ModulePass("wreduce", "reduce the word size of operations if possible") { }
 	void help() YS_OVERRIDE
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -505,10 +508,10 @@ struct WreducePass : public Pass {
 		log("        Do not optimize explicit don't-care values.\n");
 		log("\n");
 	}
-	void execute(std::vector<std::string> args, Design *design) YS_OVERRIDE
+	std::vector<Module*> setup(std::vector<std::string> args, Design *design) YS_OVERRIDE
 	{
-		WreduceConfig config;
-		bool opt_memx = false;
+		config = WreduceConfig();
+		opt_memx = false;
 
 		log_header(design, "Executing WREDUCE pass (reducing word size of cells).\n");
 
@@ -526,81 +529,82 @@ struct WreducePass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
-		for (auto module : design->selected_modules())
+		return design->selected_modules();
+	}
+	void execute_module(Module *module) YS_OVERRIDE
+	{
+		if (module->has_processes_warn())
+			return;
+
+		for (auto c : module->selected_cells())
 		{
-			if (module->has_processes_warn())
-				continue;
+			if (c->type.in(ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor), ID($reduce_bool),
+					ID($lt), ID($le), ID($eq), ID($ne), ID($eqx), ID($nex), ID($ge), ID($gt),
+					ID($logic_not), ID($logic_and), ID($logic_or)) && GetSize(c->getPort(ID::Y)) > 1) {
+				SigSpec sig = c->getPort(ID::Y);
+				if (!sig.has_const()) {
+					c->setPort(ID::Y, sig[0]);
+					c->setParam(ID(Y_WIDTH), 1);
+					sig.remove(0);
+					module->connect(sig, Const(0, GetSize(sig)));
+				}
+			}
 
-			for (auto c : module->selected_cells())
+			if (c->type.in(ID($div), ID($mod), ID($pow)))
 			{
-				if (c->type.in(ID($reduce_and), ID($reduce_or), ID($reduce_xor), ID($reduce_xnor), ID($reduce_bool),
-						ID($lt), ID($le), ID($eq), ID($ne), ID($eqx), ID($nex), ID($ge), ID($gt),
-						ID($logic_not), ID($logic_and), ID($logic_or)) && GetSize(c->getPort(ID::Y)) > 1) {
-					SigSpec sig = c->getPort(ID::Y);
-					if (!sig.has_const()) {
-						c->setPort(ID::Y, sig[0]);
-						c->setParam(ID(Y_WIDTH), 1);
-						sig.remove(0);
-						module->connect(sig, Const(0, GetSize(sig)));
-					}
+				SigSpec A = c->getPort(ID::A);
+				int original_a_width = GetSize(A);
+				if (c->getParam(ID(A_SIGNED)).as_bool()) {
+					while (GetSize(A) > 1 && A[GetSize(A)-1] == State::S0 && A[GetSize(A)-2] == State::S0)
+						A.remove(GetSize(A)-1, 1);
+				} else {
+					while (GetSize(A) > 0 && A[GetSize(A)-1] == State::S0)
+						A.remove(GetSize(A)-1, 1);
+				}
+				if (original_a_width != GetSize(A)) {
+					log("Removed top %d bits (of %d) from port A of cell %s.%s (%s).\n",
+							original_a_width-GetSize(A), original_a_width, log_id(module), log_id(c), log_id(c->type));
+					c->setPort(ID::A, A);
+					c->setParam(ID(A_WIDTH), GetSize(A));
 				}
 
-				if (c->type.in(ID($div), ID($mod), ID($pow)))
-				{
-					SigSpec A = c->getPort(ID::A);
-					int original_a_width = GetSize(A);
-					if (c->getParam(ID(A_SIGNED)).as_bool()) {
-						while (GetSize(A) > 1 && A[GetSize(A)-1] == State::S0 && A[GetSize(A)-2] == State::S0)
-							A.remove(GetSize(A)-1, 1);
-					} else {
-						while (GetSize(A) > 0 && A[GetSize(A)-1] == State::S0)
-							A.remove(GetSize(A)-1, 1);
-					}
-					if (original_a_width != GetSize(A)) {
-						log("Removed top %d bits (of %d) from port A of cell %s.%s (%s).\n",
-								original_a_width-GetSize(A), original_a_width, log_id(module), log_id(c), log_id(c->type));
-						c->setPort(ID::A, A);
-						c->setParam(ID(A_WIDTH), GetSize(A));
-					}
-
-					SigSpec B = c->getPort(ID::B);
-					int original_b_width = GetSize(B);
-					if (c->getParam(ID(B_SIGNED)).as_bool()) {
-						while (GetSize(B) > 1 && B[GetSize(B)-1] == State::S0 && B[GetSize(B)-2] == State::S0)
-							B.remove(GetSize(B)-1, 1);
-					} else {
-						while (GetSize(B) > 0 && B[GetSize(B)-1] == State::S0)
-							B.remove(GetSize(B)-1, 1);
-					}
-					if (original_b_width != GetSize(B)) {
-						log("Removed top %d bits (of %d) from port B of cell %s.%s (%s).\n",
-								original_b_width-GetSize(B), original_b_width, log_id(module), log_id(c), log_id(c->type));
-						c->setPort(ID::B, B);
-						c->setParam(ID(B_WIDTH), GetSize(B));
-					}
+				SigSpec B = c->getPort(ID::B);
+				int original_b_width = GetSize(B);
+				if (c->getParam(ID(B_SIGNED)).as_bool()) {
+					while (GetSize(B) > 1 && B[GetSize(B)-1] == State::S0 && B[GetSize(B)-2] == State::S0)
+						B.remove(GetSize(B)-1, 1);
+				} else {
+					while (GetSize(B) > 0 && B[GetSize(B)-1] == State::S0)
+						B.remove(GetSize(B)-1, 1);
+				}
+				if (original_b_width != GetSize(B)) {
+					log("Removed top %d bits (of %d) from port B of cell %s.%s (%s).\n",
+							original_b_width-GetSize(B), original_b_width, log_id(module), log_id(c), log_id(c->type));
+					c->setPort(ID::B, B);
+					c->setParam(ID(B_WIDTH), GetSize(B));
 				}
+			}
 
-				if (!opt_memx && c->type.in(ID($memrd), ID($memwr), ID($meminit))) {
-					IdString memid = c->getParam(ID(MEMID)).decode_string();
-					RTLIL::Memory *mem = module->memories.at(memid);
-					if (mem->start_offset >= 0) {
-						int cur_addrbits = c->getParam(ID(ABITS)).as_int();
-						int max_addrbits = ceil_log2(mem->start_offset + mem->size);
-						if (cur_addrbits > max_addrbits) {
-							log("Removed top %d address bits (of %d) from memory %s port %s.%s (%s).\n",
-									cur_addrbits-max_addrbits, cur_addrbits,
-									c->type == ID($memrd) ? "read" : c->type == ID($memwr) ? "write" : "init",
-									log_id(module), log_id(c), log_id(memid));
-							c->setParam(ID(ABITS), max_addrbits);
-							c->setPort(ID(ADDR), c->getPort(ID(ADDR)).extract(0, max_addrbits));
-						}
+			if (!opt_memx && c->type.in(ID($memrd), ID($memwr), ID($meminit))) {
+				IdString memid = c->getParam(ID(MEMID)).decode_string();
+				RTLIL::Memory *mem = module->memories.at(memid);
+				if (mem->start_offset >= 0) {
+					int cur_addrbits = c->getParam(ID(ABITS)).as_int();
+					int max_addrbits = ceil_log2(mem->start_offset + mem->size);
+					if (cur_addrbits > max_addrbits) {
+						log("Removed top %d address bits (of %d) from memory %s port %s.%s (%s).\n",
+								cur_addrbits-max_addrbits, cur_addrbits,
+								c->type == ID($memrd) ? "read" : c->type == ID($memwr) ? "write" : "init",
+								log_id(module), log_id(c), log_id(memid));
+						c->setParam(ID(ABITS), max_addrbits);
+						c->setPort(ID(ADDR), c->getPort(ID(ADDR)).extract(0, max_addrbits));
 					}
 				}
 			}
-
-			WreduceWorker worker(&config, module);
-			worker.run();
 		}
+
+		WreduceWorker worker(&config, module);
+		worker.run();
 	}
 } WreducePass;
 
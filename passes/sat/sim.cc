@@ -20,6 +20,11 @@
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
 #include "kernel/celltypes.h"
+#include <random>
+
+#ifdef YOSYS_ENABLE_ZLIB
+#include <zlib.h>
+#endif
 
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
@@ -30,6 +35,7 @@ struct SimShared
 	bool hide_internal = true;
 	bool writeback = false;
 	bool zinit = false;
+	bool compiled = false;
 	int rstlen = 1;
 };
 
@@ -45,6 +51,1027 @@ void zinit(Const &v)
 		zinit(bit);
 }
 
+bool is_sim_ff(Cell *cell)
+{
+	return cell->type.in("$dff", "$_DFF_P_", "$_DFF_N_");
+}
+
+// $dff names its clock port \CLK, the $_DFF_P_ and $_DFF_N_ gates name it \C
+IdString ff_clock_port(Cell *cell)
+{
+	return cell->type == "$dff" ? "\\CLK" : "\\C";
+}
+
+bool ff_clock_polarity(Cell *cell)
+{
+	if (cell->type == "$dff")
+		return cell->getParam("\\CLK_POLARITY").as_bool();
+	return cell->type == "$_DFF_P_";
+}
+
+// Buffered VCD writer. Values are formatted straight into a buffer that is
+// written out in large blocks, gzip-compressed if the file name ends in .gz.
+struct SimVcdWriter
+{
+	std::string buffer;
+	bool compact = false;
+	FILE *f = nullptr;
+#ifdef YOSYS_ENABLE_ZLIB
+	gzFile gzf = nullptr;
+#endif
+
+	~SimVcdWriter()
+	{
+		close();
+	}
+
+	void open(const std::string &filename)
+	{
+		if (filename.size() > 3 && filename.compare(filename.size()-3, std::string::npos, ".gz") == 0) {
+#ifdef YOSYS_ENABLE_ZLIB
+			gzf = gzopen(filename.c_str(), "wb");
+			if (gzf == nullptr)
+				log_cmd_error("Can't open output file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+			return;
+#else
+			log_cmd_error("Yosys is compiled without zlib support, unable to write gzip output.\n");
+#endif
+		}
+		f = fopen(filename.c_str(), "wb");
+		if (f == nullptr)
+			log_cmd_error("Can't open output file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+	}
+
+	bool is_open() const
+	{
+#ifdef YOSYS_ENABLE_ZLIB
+		if (gzf != nullptr)
+			return true;
+#endif
+		return f != nullptr;
+	}
+
+	void flush()
+	{
+		if (buffer.empty())
+			return;
+#ifdef YOSYS_ENABLE_ZLIB
+		if (gzf != nullptr)
+			gzwrite(gzf, buffer.data(), unsigned(buffer.size()));
+#endif
+		if (f != nullptr)
+			fwrite(buffer.data(), 1, buffer.size(), f);
+		buffer.clear();
+	}
+
+	void close()
+	{
+		flush();
+#ifdef YOSYS_ENABLE_ZLIB
+		if (gzf != nullptr)
+			gzclose(gzf);
+		gzf = nullptr;
+#endif
+		if (f != nullptr)
+			fclose(f);
+		f = nullptr;
+	}
+
+	SimVcdWriter &operator<<(const std::string &str)
+	{
+		buffer += str;
+		if (buffer.size() >= (1 << 16))
+			flush();
+		return *this;
+	}
+
+	static char state_char(State s)
+	{
+		switch (s) {
+			case State::S0: return '0';
+			case State::S1: return '1';
+			case State::Sx: return 'x';
+			default: return 'z';
+		}
+	}
+
+	// Identifier for the id-th variable: "n<id>", or with -vcdcompact the
+	// short printable codes used by most VCD writers.
+	std::string id_code(int id) const
+	{
+		if (!compact)
+			return stringf("n%d", id);
+		std::string code;
+		do {
+			code.push_back('!' + id % 94);
+			id /= 94;
+		} while (id != 0);
+		return code;
+	}
+
+	// Write a value change. With -vcdcompact, 1-bit values are written
+	// without the 'b' prefix and the leading bits that VCD readers extend
+	// implicitly are left out.
+	void change(const Const &value, const std::string &code)
+	{
+		if (compact && GetSize(value) == 1) {
+			buffer.push_back(state_char(value[0]));
+		} else {
+			int i = GetSize(value)-1;
+			if (compact) {
+				while (i > 0 && value[i] == value[i-1] && value[i] != State::S1)
+					i--;
+				if (i > 0 && value[i] == State::S0 && value[i-1] == State::S1)
+					i--;
+			}
+			buffer.push_back('b');
+			for (; i >= 0; i--)
+				buffer.push_back(state_char(value[i]));
+			buffer.push_back(' ');
+		}
+		buffer += code;
+		buffer.push_back('\n');
+		if (buffer.size() >= (1 << 16))
+			flush();
+	}
+};
+
+// Streaming VCD reader for input stimulus. Only the variables in the top
+// scope that name an input port of the module are used, and only the
+// changes up to the current simulation time are read ahead.
+struct SimVcdReader
+{
+	std::string filename;
+	FILE *f = nullptr;
+#ifdef YOSYS_ENABLE_ZLIB
+	gzFile gzf = nullptr;
+#endif
+	std::vector<char> buffer;
+	int buffer_pos = 0, buffer_len = 0;
+
+	dict<std::string, vector<Wire*>> id_wires;
+	// time of the changes not applied yet, -1 at the end of the file
+	int64_t next_time = 0;
+
+	~SimVcdReader()
+	{
+#ifdef YOSYS_ENABLE_ZLIB
+		if (gzf != nullptr)
+			gzclose(gzf);
+#endif
+		if (f != nullptr)
+			fclose(f);
+	}
+
+	void open(const std::string &fn, Module *topmod)
+	{
+		filename = fn;
+#ifdef YOSYS_ENABLE_ZLIB
+		// zlib reads uncompressed files transparently
+		gzf = gzopen(filename.c_str(), "rb");
+		if (gzf == nullptr)
+#else
+		f = fopen(filename.c_str(), "rb");
+		if (f == nullptr)
+#endif
+			log_cmd_error("Can't open input file `%s' for reading: %s\n", filename.c_str(), strerror(errno));
+		buffer.resize(1 << 16);
+		read_header(topmod);
+	}
+
+	bool next_char(char &c)
+	{
+		if (buffer_pos == buffer_len) {
+#ifdef YOSYS_ENABLE_ZLIB
+			buffer_len = gzread(gzf, buffer.data(), GetSize(buffer));
+#else
+			buffer_len = fread(buffer.data(), 1, GetSize(buffer), f);
+#endif
+			buffer_pos = 0;
+			if (buffer_len <= 0) {
+				buffer_len = 0;
+				return false;
+			}
+		}
+		c = buffer[buffer_pos++];
+		return true;
+	}
+
+	bool next_token(std::string &token)
+	{
+		char c;
+		token.clear();
+		while (next_char(c))
+			if (!isspace(c)) {
+				token.push_back(c);
+				break;
+			}
+		while (next_char(c) && !isspace(c))
+			token.push_back(c);
+		return !token.empty();
+	}
+
+	void skip_to_end()
+	{
+		std::string token;
+		while (next_token(token) && token != "$end") { }
+	}
+
+	void read_header(Module *topmod)
+	{
+		std::string token;
+		int depth = 0;
+		while (next_token(token))
+		{
+			if (token == "$enddefinitions") {
+				skip_to_end();
+				break;
+			}
+			if (token == "$scope") {
+				depth++;
+				skip_to_end();
+				continue;
+			}
+			if (token == "$upscope") {
+				depth--;
+				skip_to_end();
+				continue;
+			}
+			if (token == "$var") {
+				std::string type, width, id, ref;
+				next_token(type), next_token(width), next_token(id), next_token(ref);
+				skip_to_end();
+				if (depth != 1)
+					continue;
+				if (!ref.empty() && ref[0] == '\\')
+					ref = ref.substr(1);
+				Wire *wire = topmod->wire(RTLIL::escape_id(ref));
+				if (wire != nullptr && wire->port_input)
+					id_wires[id].push_back(wire);
+				continue;
+			}
+			if (token[0] == '$')
+				skip_to_end();
+		}
+		if (id_wires.empty())
+			log_warning("No input of module %s found in `%s'.\n", log_id(topmod), filename.c_str());
+		read_time();
+	}
+
+	// Read up to the next time marker.
+	void read_time()
+	{
+		std::string token;
+		next_time = -1;
+		while (next_token(token)) {
+			if (token[0] == '#') {
+				next_time = atoll(token.c_str() + 1);
+				return;
+			}
+			if (token == "$comment")
+				skip_to_end();
+		}
+	}
+
+	static Const parse_value(const std::string &bits, int width)
+	{
+		Const value;
+		for (int i = GetSize(bits)-1; i >= 0; i--)
+			switch (bits[i]) {
+				case '0': value.bits.push_back(State::S0); break;
+				case '1': value.bits.push_back(State::S1); break;
+				case 'z': case 'Z': value.bits.push_back(State::Sz); break;
+				default: value.bits.push_back(State::Sx);
+			}
+		State ext = bits.empty() || value.bits.back() == State::S1 ? State::S0 : value.bits.back();
+		value.bits.resize(width, ext);
+		return value;
+	}
+
+	// Apply all changes up to and including time t.
+	template<typename F>
+	void advance(int64_t t, F set_state)
+	{
+		std::string token, id;
+		while (next_time >= 0 && next_time <= t)
+		{
+			while (next_token(token))
+			{
+				if (token[0] == '#') {
+					next_time = atoll(token.c_str() + 1);
+					break;
+				}
+				if (token[0] == '$') {
+					if (token == "$comment")
+						skip_to_end();
+					continue;
+				}
+				std::string bits;
+				if (token[0] == 'b' || token[0] == 'B') {
+					bits = token.substr(1);
+					next_token(id);
+				} else if (token[0] == 'r' || token[0] == 'R') {
+					next_token(id);
+					continue;
+				} else {
+					bits = token.substr(0, 1);
+					id = token.substr(1);
+				}
+				auto it = id_wires.find(id);
+				if (it != id_wires.end())
+					for (auto wire : it->second)
+						set_state(wire, parse_value(bits, GetSize(wire)));
+			}
+			if (token.empty() || token[0] != '#')
+				next_time = -1;
+		}
+	}
+};
+
+// Compiled simulation of a flat module: all nets live in one contiguous array
+// of packed two-bit 0/1/x/z values, 32 nets per word (indexes 0-3 hold the
+// constants, modules with 'Sa' or 'Sm' constants are not compiled), and the
+// combinational cells are levelized once into a schedule of typed bit-level
+// kernels. An op only runs when one of its inputs changed, so the results are
+// the same as with the event-driven SimInstance, but without any hashing in
+// the inner loop. Cells without a bit-level kernel fall back to
+// CellTypes::eval().
+struct SimCompiled
+{
+	enum op_kind_t : unsigned char {
+		OP_BUF, OP_NOT, OP_INV, OP_AND, OP_NAND, OP_OR, OP_NOR, OP_XOR,
+		OP_XNOR, OP_ANDNOT, OP_ORNOT, OP_MUX, OP_CELL
+	};
+
+	struct op_t
+	{
+		op_kind_t kind;
+		// for OP_CELL 'a' is the index into cell_ops
+		int y, a, b, s;
+	};
+
+	struct cell_op_t
+	{
+		Cell *cell;
+		bool has_a, has_b, has_c, has_s;
+		vector<int> a, b, c, s, y;
+	};
+
+	struct ff_t
+	{
+		Cell *cell;
+		bool clkpol;
+		int clk;
+		vector<int> d, q;
+		State past_clock;
+		vector<State> past_d;
+	};
+
+	struct formal_t
+	{
+		Cell *cell;
+		string label;
+		int a, en;
+	};
+
+	SimShared *shared;
+	Module *module;
+	const SigMap &sigmap;
+
+	dict<SigBit, int> net_index;
+	dict<Wire*, vector<int>> wire_nets;
+	vector<uint64_t> net_words;
+	int num_nets;
+	vector<vector<int>> readers;
+
+	vector<op_t> ops;
+	vector<cell_op_t> cell_ops;
+	vector<bool> dirty;
+	int first_dirty;
+
+	vector<ff_t> ffs;
+	dict<Cell*, int> ff_index;
+	vector<formal_t> formals;
+
+	SimCompiled(SimShared *shared, Module *module, const SigMap &sigmap) :
+			shared(shared), module(module), sigmap(sigmap), num_nets(State::Sm+1), first_dirty(0)
+	{
+		for (auto wire : module->wires())
+			for (auto bit : sigmap(wire))
+				if (bit.wire != nullptr && net_index.count(bit) == 0)
+					net_index[bit] = num_nets++;
+
+		net_words.resize((num_nets + 31) / 32);
+		for (int i = 0; i < num_nets; i++)
+			set_net(i, i <= State::Sz ? State(i) : State::Sx);
+	}
+
+	State get_net(int net) const
+	{
+		return State((net_words[net >> 5] >> (2 * (net & 31))) & 3);
+	}
+
+	void set_net(int net, State value)
+	{
+		log_assert(value <= State::Sz);
+		int shift = 2 * (net & 31);
+		uint64_t &word = net_words[net >> 5];
+		word = (word & ~(uint64_t(3) << shift)) | (uint64_t(value) << shift);
+	}
+
+	// Returns nullptr (and says why) if the module needs the event-driven
+	// simulator: hierarchy, memories, unsupported cells or combinational
+	// loops.
+	static SimCompiled *compile(SimShared *shared, Module *module, const SigMap &sigmap)
+	{
+		SimCompiled *sc = new SimCompiled(shared, module, sigmap);
+		string reason;
+
+		vector<op_t> unsorted_ops;
+		for (auto cell : module->cells())
+		{
+			if (module->design->module(cell->type) != nullptr) {
+				reason = stringf("cell %s is a module instance", log_id(cell));
+				break;
+			}
+			if (cell->type == "$mem") {
+				reason = stringf("cell %s is a memory", log_id(cell));
+				break;
+			}
+			for (auto &conn : cell->connections())
+				for (auto bit : conn.second)
+					if (bit.wire == nullptr && bit.data > State::Sz)
+						reason = stringf("cell %s is connected to a constant other than 0, 1, x and z", log_id(cell));
+			if (!reason.empty())
+				break;
+			if (is_sim_ff(cell)) {
+				ff_t ff;
+				ff.cell = cell;
+				ff.clkpol = ff_clock_polarity(cell);
+				ff.clk = sc->index(cell->getPort(ff_clock_port(cell)))[0];
+				ff.d = sc->index(cell->getPort("\\D"));
+				ff.q = sc->index(cell->getPort("\\Q"));
+				ff.past_clock = State::Sx;
+				ff.past_d = vector<State>(GetSize(ff.d), State::Sx);
+				sc->ff_index[cell] = GetSize(sc->ffs);
+				sc->ffs.push_back(ff);
+				continue;
+			}
+			if (cell->type.in("$assert", "$cover", "$assume")) {
+				formal_t formal;
+				formal.cell = cell;
+				formal.label = log_id(cell);
+				if (cell->attributes.count("\\src"))
+					formal.label = cell->attributes.at("\\src").decode_string();
+				formal.a = sc->index(cell->getPort("\\A"))[0];
+				formal.en = sc->index(cell->getPort("\\EN"))[0];
+				sc->formals.push_back(formal);
+				continue;
+			}
+			if (!sc->compile_cell(cell, unsorted_ops)) {
+				reason = stringf("cell %s has the unsupported type %s", log_id(cell), log_id(cell->type));
+				break;
+			}
+		}
+
+		if (reason.empty() && !sc->levelize(unsorted_ops))
+			reason = "it has combinational loops";
+
+		if (!reason.empty()) {
+			log("Using event-driven simulation for module %s: %s.\n", log_id(module), reason.c_str());
+			delete sc;
+			return nullptr;
+		}
+
+		log("Compiled module %s into %d ops on %d nets.\n", log_id(module), GetSize(sc->ops), sc->num_nets);
+		return sc;
+	}
+
+	int index(SigBit bit)
+	{
+		bit = sigmap(bit);
+		if (bit.wire == nullptr)
+			return int(bit.data);
+		return net_index.at(bit);
+	}
+
+	vector<int> index(const SigSpec &sig)
+	{
+		vector<int> result;
+		for (auto bit : sig)
+			result.push_back(index(bit));
+		return result;
+	}
+
+	bool compile_cell(Cell *cell, vector<op_t> &unsorted_ops)
+	{
+		auto add_op = [&](op_kind_t kind, int y, int a, int b, int s) {
+			unsorted_ops.push_back(op_t{kind, y, a, b, s});
+		};
+
+		static dict<IdString, op_kind_t> gate_ops = {
+			{"$_BUF_", OP_BUF}, {"$_NOT_", OP_NOT}, {"$_AND_", OP_AND}, {"$_NAND_", OP_NAND},
+			{"$_OR_", OP_OR}, {"$_NOR_", OP_NOR}, {"$_XOR_", OP_XOR}, {"$_XNOR_", OP_XNOR},
+			{"$_ANDNOT_", OP_ANDNOT}, {"$_ORNOT_", OP_ORNOT}, {"$_MUX_", OP_MUX}
+		};
+		static dict<IdString, op_kind_t> word_ops = {
+			{"$not", OP_INV}, {"$and", OP_AND}, {"$or", OP_OR}, {"$xor", OP_XOR}, {"$xnor", OP_XNOR}
+		};
+
+		if (gate_ops.count(cell->type)) {
+			op_kind_t kind = gate_ops.at(cell->type);
+			int a = index(cell->getPort("\\A")[0]);
+			int b = cell->hasPort("\\B") ? index(cell->getPort("\\B")[0]) : 0;
+			int s = cell->hasPort("\\S") ? index(cell->getPort("\\S")[0]) : 0;
+			add_op(kind, index(cell->getPort("\\Y")[0]), a, b, s);
+			return true;
+		}
+
+		if (cell->type == "$mux") {
+			vector<int> a = index(cell->getPort("\\A"));
+			vector<int> b = index(cell->getPort("\\B"));
+			vector<int> y = index(cell->getPort("\\Y"));
+			int s = index(cell->getPort("\\S")[0]);
+			for (int i = 0; i < GetSize(y); i++)
+				add_op(OP_MUX, y[i], a[i], b[i], s);
+			return true;
+		}
+
+		// bitwise word cells without any operand extension are split into
+		// one op per bit
+		if (word_ops.count(cell->type)) {
+			int y_width = cell->getParam("\\Y_WIDTH").as_int();
+			bool unary = cell->type == "$not";
+			if (cell->getParam("\\A_WIDTH").as_int() == y_width &&
+					(unary || cell->getParam("\\B_WIDTH").as_int() == y_width)) {
+				vector<int> a = index(cell->getPort("\\A"));
+				vector<int> b = unary ? vector<int>(y_width) : index(cell->getPort("\\B"));
+				vector<int> y = index(cell->getPort("\\Y"));
+				for (int i = 0; i < y_width; i++)
+					add_op(word_ops.at(cell->type), y[i], a[i], b[i], 0);
+				return true;
+			}
+		}
+
+		if (!yosys_celltypes.cell_evaluable(cell->type))
+			return false;
+
+		// same port patterns as SimInstance::update_cell()
+		cell_op_t cop;
+		cop.cell = cell;
+		cop.has_a = cell->hasPort("\\A");
+		cop.has_b = cell->hasPort("\\B");
+		cop.has_c = cell->hasPort("\\C");
+		cop.has_s = cell->hasPort("\\S");
+		bool has_d = cell->hasPort("\\D");
+		if (!cell->hasPort("\\Y") || !cop.has_a || has_d || (cop.has_c && cop.has_s))
+			return false;
+		if ((cop.has_c || cop.has_s) && !cop.has_b)
+			return false;
+
+		if (cop.has_a) cop.a = index(cell->getPort("\\A"));
+		if (cop.has_b) cop.b = index(cell->getPort("\\B"));
+		if (cop.has_c) cop.c = index(cell->getPort("\\C"));
+		if (cop.has_s) cop.s = index(cell->getPort("\\S"));
+		cop.y = index(cell->getPort("\\Y"));
+
+		int idx = GetSize(cell_ops);
+		cell_ops.push_back(cop);
+		add_op(OP_CELL, -1, idx, 0, 0);
+		return true;
+	}
+
+	// Sort the ops so that every op comes after the drivers of its inputs.
+	bool levelize(const vector<op_t> &unsorted_ops)
+	{
+		int num_ops = GetSize(unsorted_ops);
+		vector<vector<int>> op_inputs(num_ops), op_outputs(num_ops);
+		for (int i = 0; i < num_ops; i++) {
+			const op_t &op = unsorted_ops[i];
+			if (op.kind == OP_CELL) {
+				const cell_op_t &cop = cell_ops[op.a];
+				for (auto sig : {&cop.a, &cop.b, &cop.c, &cop.s})
+					op_inputs[i].insert(op_inputs[i].end(), sig->begin(), sig->end());
+				op_outputs[i] = cop.y;
+			} else {
+				op_inputs[i] = {op.a, op.b, op.s};
+				op_outputs[i] = {op.y};
+			}
+		}
+
+		vector<int> driver(num_nets, -1);
+		for (int i = 0; i < num_ops; i++)
+			for (int net : op_outputs[i])
+				driver[net] = i;
+
+		vector<vector<int>> fanout(num_ops);
+		vector<int> in_degree(num_ops);
+		for (int i = 0; i < num_ops; i++) {
+			pool<int> drivers;
+			for (int net : op_inputs[i])
+				if (driver[net] >= 0)
+					drivers.insert(driver[net]);
+			for (int j : drivers)
+				fanout[j].push_back(i);
+			in_degree[i] = GetSize(drivers);
+		}
+
+		vector<int> order;
+		for (int i = 0; i < num_ops; i++)
+			if (in_degree[i] == 0)
+				order.push_back(i);
+		for (int k = 0; k < GetSize(order); k++)
+			for (int j : fanout[order[k]])
+				if (--in_degree[j] == 0)
+					order.push_back(j);
+		if (GetSize(order) != num_ops)
+			return false;
+
+		readers.resize(num_nets);
+		for (int i : order) {
+			int pos = GetSize(ops);
+			ops.push_back(unsorted_ops[i]);
+			pool<int> inputs(op_inputs[i].begin(), op_inputs[i].end());
+			for (int net : inputs)
+				readers[net].push_back(pos);
+		}
+		dirty.resize(GetSize(ops));
+		first_dirty = GetSize(ops);
+		return true;
+	}
+
+	// Take over the initial values and dirty bits set up by SimInstance.
+	void load(const dict<SigBit, State> &state_nets, const pool<SigBit> &dirty_bits)
+	{
+		for (auto &it : state_nets)
+			set_net(index(it.first), it.second);
+		for (auto bit : dirty_bits)
+			mark_readers(index(bit));
+	}
+
+	void set_ff_state(Cell *cell, State past_clock, const Const &past_d)
+	{
+		ff_t &ff = ffs[ff_index.at(cell)];
+		ff.past_clock = past_clock;
+		ff.past_d = past_d.bits;
+	}
+
+	void mark_readers(int net)
+	{
+		for (int op : readers[net])
+			if (!dirty[op]) {
+				dirty[op] = true;
+				first_dirty = min(first_dirty, op);
+			}
+	}
+
+	bool write(int net, State value)
+	{
+		if (get_net(net) == value)
+			return false;
+		set_net(net, value);
+		mark_readers(net);
+		return true;
+	}
+
+	Const get_state(const SigSpec &sig)
+	{
+		Const value;
+		if (sig.is_wire()) {
+			Wire *wire = sig.as_wire();
+			auto it = wire_nets.find(wire);
+			if (it == wire_nets.end())
+				it = wire_nets.insert(make_pair(wire, index(sig))).first;
+			for (int net : it->second)
+				value.bits.push_back(get_net(net));
+		} else {
+			for (auto bit : sig)
+				value.bits.push_back(get_net(index(bit)));
+		}
+		return value;
+	}
+
+	bool set_state(const SigSpec &sig, const Const &value)
+	{
+		bool did_something = false;
+		for (int i = 0; i < GetSize(sig); i++)
+			if (write(index(sig[i]), value[i]))
+				did_something = true;
+		return did_something;
+	}
+
+	static State eval_not(State a)
+	{
+		return a == State::S0 ? State::S1 : a == State::S1 ? State::S0 : a;
+	}
+
+	static State eval_inv(State a)
+	{
+		return a == State::S0 ? State::S1 : a == State::S1 ? State::S0 : State::Sx;
+	}
+
+	static State eval_and(State a, State b)
+	{
+		if (a == State::S0 || b == State::S0)
+			return State::S0;
+		if (a != State::S1 || b != State::S1)
+			return State::Sx;
+		return State::S1;
+	}
+
+	static State eval_or(State a, State b)
+	{
+		if (a == State::S1 || b == State::S1)
+			return State::S1;
+		if (a != State::S0 || b != State::S0)
+			return State::Sx;
+		return State::S0;
+	}
+
+	static State eval_xor(State a, State b)
+	{
+		if (a > State::S1 || b > State::S1)
+			return State::Sx;
+		return a != b ? State::S1 : State::S0;
+	}
+
+	void eval_cell(const cell_op_t &cop)
+	{
+		auto get = [&](const vector<int> &sig) {
+			Const value;
+			for (int net : sig)
+				value.bits.push_back(get_net(net));
+			return value;
+		};
+
+		if (shared->debug)
+			log("[%s] eval %s (%s)\n", log_id(module), log_id(cop.cell), log_id(cop.cell->type));
+
+		Const y;
+		if (cop.has_c)
+			y = CellTypes::eval(cop.cell, get(cop.a), get(cop.b), get(cop.c));
+		else if (cop.has_s)
+			y = CellTypes::eval(cop.cell, get(cop.a), get(cop.b), get(cop.s));
+		else
+			y = CellTypes::eval(cop.cell, get(cop.a), get(cop.b));
+
+		for (int i = 0; i < GetSize(cop.y); i++)
+			write(cop.y[i], y[i]);
+	}
+
+	void update_ph1()
+	{
+		for (int i = first_dirty; i < GetSize(ops); i++)
+		{
+			if (!dirty[i])
+				continue;
+			dirty[i] = false;
+
+			const op_t &op = ops[i];
+			State a = get_net(op.a), b = get_net(op.b);
+			switch (op.kind)
+			{
+			case OP_BUF:    write(op.y, a); break;
+			case OP_NOT:    write(op.y, eval_not(a)); break;
+			case OP_INV:    write(op.y, eval_inv(a)); break;
+			case OP_AND:    write(op.y, eval_and(a, b)); break;
+			case OP_NAND:   write(op.y, eval_not(eval_and(a, b))); break;
+			case OP_OR:     write(op.y, eval_or(a, b)); break;
+			case OP_NOR:    write(op.y, eval_not(eval_or(a, b))); break;
+			case OP_XOR:    write(op.y, eval_xor(a, b)); break;
+			case OP_XNOR:   write(op.y, eval_not(eval_xor(a, b))); break;
+			case OP_ANDNOT: write(op.y, eval_and(a, eval_not(b))); break;
+			case OP_ORNOT:  write(op.y, eval_or(a, eval_not(b))); break;
+			case OP_MUX:    write(op.y, get_net(op.s) == State::S1 ? b : a); break;
+			case OP_CELL:   eval_cell(cell_ops[op.a]); break;
+			}
+		}
+		first_dirty = GetSize(ops);
+	}
+
+	bool update_ph2()
+	{
+		bool did_something = false;
+
+		for (auto &ff : ffs)
+		{
+			State current_clock = get_net(ff.clk);
+
+			if (ff.clkpol ? (ff.past_clock == State::S1 || current_clock != State::S1) :
+					(ff.past_clock == State::S0 || current_clock != State::S0))
+				continue;
+
+			for (int i = 0; i < GetSize(ff.q); i++)
+				if (write(ff.q[i], ff.past_d[i]))
+					did_something = true;
+		}
+
+		return did_something;
+	}
+
+	void update_ph3(const std::string &hiername)
+	{
+		for (auto &ff : ffs) {
+			ff.past_clock = get_net(ff.clk);
+			for (int i = 0; i < GetSize(ff.d); i++)
+				ff.past_d[i] = get_net(ff.d[i]);
+		}
+
+		for (auto &formal : formals)
+		{
+			Cell *cell = formal.cell;
+			State a = get_net(formal.a);
+			State en = get_net(formal.en);
+
+			if (cell->type == "$cover" && en == State::S1 && a != State::S1)
+				log("Cover %s.%s (%s) reached.\n", hiername.c_str(), log_id(cell), formal.label.c_str());
+
+			if (cell->type == "$assume" && en == State::S1 && a != State::S1)
+				log("Assumption %s.%s (%s) failed.\n", hiername.c_str(), log_id(cell), formal.label.c_str());
+
+			if (cell->type == "$assert" && en == State::S1 && a != State::S1)
+				log_warning("Assert %s.%s (%s) failed.\n", hiername.c_str(), log_id(cell), formal.label.c_str());
+		}
+	}
+};
+
+// Two-valued simulation of 64 independent stimuli at once on the schedule of
+// a SimCompiled: every net is one machine word with one bit per lane, and
+// every op is a bitwise word operation. Undefined initial values are zero.
+struct SimParallel
+{
+	static const int lanes = 64;
+
+	SimCompiled *sc;
+	vector<uint64_t> nets;
+	vector<uint64_t> past_clock;
+	vector<vector<uint64_t>> past_d;
+
+	// statistics, sampled once per cycle
+	vector<uint64_t> last_sample;
+	vector<int64_t> toggles;
+	vector<int> first_divergence;
+
+	SimParallel(SimCompiled *sc) : sc(sc)
+	{
+		nets.resize(sc->num_nets);
+		for (int i = 0; i < sc->num_nets; i++)
+			nets[i] = sc->get_net(i) == State::S1 ? ~uint64_t(0) : 0;
+
+		for (auto wire : sc->module->wires())
+			if (wire->attributes.count("\\init")) {
+				Const initval = wire->attributes.at("\\init");
+				vector<int> sig = sc->index(SigSpec(wire));
+				for (int i = 0; i < GetSize(sig) && i < GetSize(initval); i++)
+					if (initval[i] == State::S1)
+						nets[sig[i]] = ~uint64_t(0);
+			}
+
+		for (auto &ff : sc->ffs) {
+			past_clock.push_back(0);
+			past_d.push_back(vector<uint64_t>(GetSize(ff.d)));
+		}
+
+		last_sample = nets;
+		toggles.resize(GetSize(nets));
+		first_divergence.resize(GetSize(nets), -1);
+	}
+
+	~SimParallel()
+	{
+		delete sc;
+	}
+
+	void set_lane(int net, int lane, State value)
+	{
+		uint64_t mask = uint64_t(1) << lane;
+		if (value == State::S1)
+			nets[net] |= mask;
+		else
+			nets[net] &= ~mask;
+	}
+
+	void eval_cell(const SimCompiled::cell_op_t &cop)
+	{
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			auto get = [&](const vector<int> &sig) {
+				Const value;
+				for (int net : sig)
+					value.bits.push_back((nets[net] >> lane) & 1 ? State::S1 : State::S0);
+				return value;
+			};
+
+			Const y;
+			if (cop.has_c)
+				y = CellTypes::eval(cop.cell, get(cop.a), get(cop.b), get(cop.c));
+			else if (cop.has_s)
+				y = CellTypes::eval(cop.cell, get(cop.a), get(cop.b), get(cop.s));
+			else
+				y = CellTypes::eval(cop.cell, get(cop.a), get(cop.b));
+
+			for (int i = 0; i < GetSize(cop.y); i++)
+				set_lane(cop.y[i], lane, y[i]);
+		}
+	}
+
+	void update_ph1()
+	{
+		for (auto &op : sc->ops)
+		{
+			uint64_t a = nets[op.a], b = nets[op.b];
+			switch (op.kind)
+			{
+			case SimCompiled::OP_BUF:    nets[op.y] = a; break;
+			case SimCompiled::OP_NOT:
+			case SimCompiled::OP_INV:    nets[op.y] = ~a; break;
+			case SimCompiled::OP_AND:    nets[op.y] = a & b; break;
+			case SimCompiled::OP_NAND:   nets[op.y] = ~(a & b); break;
+			case SimCompiled::OP_OR:     nets[op.y] = a | b; break;
+			case SimCompiled::OP_NOR:    nets[op.y] = ~(a | b); break;
+			case SimCompiled::OP_XOR:    nets[op.y] = a ^ b; break;
+			case SimCompiled::OP_XNOR:   nets[op.y] = ~(a ^ b); break;
+			case SimCompiled::OP_ANDNOT: nets[op.y] = a & ~b; break;
+			case SimCompiled::OP_ORNOT:  nets[op.y] = a | ~b; break;
+			case SimCompiled::OP_MUX:    nets[op.y] = (a & ~nets[op.s]) | (b & nets[op.s]); break;
+			case SimCompiled::OP_CELL:   eval_cell(sc->cell_ops[op.a]); break;
+			}
+		}
+	}
+
+	bool update_ph2()
+	{
+		bool did_something = false;
+
+		for (int k = 0; k < GetSize(sc->ffs); k++)
+		{
+			auto &ff = sc->ffs[k];
+			uint64_t clock = nets[ff.clk];
+			uint64_t edge = ff.clkpol ? ~past_clock[k] & clock : past_clock[k] & ~clock;
+			if (edge == 0)
+				continue;
+
+			for (int i = 0; i < GetSize(ff.q); i++) {
+				uint64_t q = (nets[ff.q[i]] & ~edge) | (past_d[k][i] & edge);
+				if (q != nets[ff.q[i]]) {
+					nets[ff.q[i]] = q;
+					did_something = true;
+				}
+			}
+		}
+
+		return did_something;
+	}
+
+	void update_ph3(int cycle)
+	{
+		for (int k = 0; k < GetSize(sc->ffs); k++) {
+			auto &ff = sc->ffs[k];
+			past_clock[k] = nets[ff.clk];
+			for (int i = 0; i < GetSize(ff.d); i++)
+				past_d[k][i] = nets[ff.d[i]];
+		}
+
+		for (auto &formal : sc->formals)
+		{
+			Cell *cell = formal.cell;
+			uint64_t active = nets[formal.en] & ~nets[formal.a];
+			if (active == 0)
+				continue;
+			int lane = __builtin_ctzll(active);
+
+			if (cell->type == "$cover")
+				log("Cover %s.%s (%s) reached in cycle %d, lane %d.\n", log_id(sc->module), log_id(cell), formal.label.c_str(), cycle, lane);
+
+			if (cell->type == "$assume")
+				log("Assumption %s.%s (%s) failed in cycle %d, lane %d.\n", log_id(sc->module), log_id(cell), formal.label.c_str(), cycle, lane);
+
+			if (cell->type == "$assert")
+				log_warning("Assert %s.%s (%s) failed in cycle %d, lane %d.\n", log_id(sc->module), log_id(cell), formal.label.c_str(), cycle, lane);
+		}
+	}
+
+	void update(int cycle)
+	{
+		while (1) {
+			update_ph1();
+			if (!update_ph2())
+				break;
+		}
+		update_ph3(cycle);
+	}
+
+	void sample(int cycle)
+	{
+		for (int i = 0; i < GetSize(nets); i++) {
+			toggles[i] += __builtin_popcountll(nets[i] ^ last_sample[i]);
+			if (first_divergence[i] < 0 && nets[i] != 0 && ~nets[i] != 0)
+				first_divergence[i] = cycle;
+		}
+		last_sample = nets;
+	}
+};
+
 struct SimInstance
 {
 	SimShared *shared;
@@ -83,7 +1110,9 @@ struct SimInstance
 	dict<Cell*, mem_state_t> mem_database;
 	pool<Cell*> formal_database;
 
-	dict<Wire*, pair<int, Const>> vcd_database;
+	dict<Wire*, pair<std::string, Const>> vcd_database;
+
+	SimCompiled *compiled = nullptr;
 
 	SimInstance(SimShared *shared, Module *module, Cell *instance = nullptr, SimInstance *parent = nullptr) :
 			shared(shared), module(module), instance(instance), parent(parent), sigmap(module)
@@ -132,10 +1161,10 @@ struct SimInstance
 						upd_cells[bit].insert(cell);
 			}
 
-			if (cell->type.in("$dff")) {
+			if (is_sim_ff(cell)) {
 				ff_state_t ff;
 				ff.past_clock = State::Sx;
-				ff.past_d = Const(State::Sx, cell->getParam("\\WIDTH").as_int());
+				ff.past_d = Const(State::Sx, GetSize(cell->getPort("\\Q")));
 				ff_database[cell] = ff;
 			}
 
@@ -184,12 +1213,23 @@ struct SimInstance
 				zinit(mem.data);
 			}
 		}
+
+		if (shared->compiled && parent == nullptr)
+			compiled = SimCompiled::compile(shared, module, sigmap);
+
+		if (compiled) {
+			compiled->load(state_nets, dirty_bits);
+			dirty_bits.clear();
+			for (auto &it : ff_database)
+				compiled->set_ff_state(it.first, it.second.past_clock, it.second.past_d);
+		}
 	}
 
 	~SimInstance()
 	{
 		for (auto child : children)
 			delete child.second;
+		delete compiled;
 	}
 
 	IdString name() const
@@ -211,13 +1251,16 @@ struct SimInstance
 	{
 		Const value;
 
-		for (auto bit : sigmap(sig))
-			if (bit.wire == nullptr)
-				value.bits.push_back(bit.data);
-			else if (state_nets.count(bit))
-				value.bits.push_back(state_nets.at(bit));
-			else
-				value.bits.push_back(State::Sz);
+		if (compiled)
+			value = compiled->get_state(sig);
+		else
+			for (auto bit : sigmap(sig))
+				if (bit.wire == nullptr)
+					value.bits.push_back(bit.data);
+				else if (state_nets.count(bit))
+					value.bits.push_back(state_nets.at(bit));
+				else
+					value.bits.push_back(State::Sz);
 
 		if (shared->debug)
 			log("[%s] get %s: %s\n", hiername().c_str(), log_signal(sig), log_signal(value));
@@ -231,12 +1274,15 @@ struct SimInstance
 		sig = sigmap(sig);
 		log_assert(GetSize(sig) == GetSize(value));
 
-		for (int i = 0; i < GetSize(sig); i++)
-			if (state_nets.at(sig[i]) != value[i]) {
-				state_nets.at(sig[i]) = value[i];
-				dirty_bits.insert(sig[i]);
-				did_something = true;
-			}
+		if (compiled)
+			did_something = compiled->set_state(sig, value);
+		else
+			for (int i = 0; i < GetSize(sig); i++)
+				if (state_nets.at(sig[i]) != value[i]) {
+					state_nets.at(sig[i]) = value[i];
+					dirty_bits.insert(sig[i]);
+					did_something = true;
+				}
 
 		if (shared->debug)
 			log("[%s] set %s: %s\n", hiername().c_str(), log_signal(sig), log_signal(value));
@@ -346,6 +1392,11 @@ struct SimInstance
 
 	void update_ph1()
 	{
+		if (compiled) {
+			compiled->update_ph1();
+			return;
+		}
+
 		pool<Cell*> queue_cells;
 		pool<Wire*> queue_outports;
 
@@ -395,6 +1446,9 @@ struct SimInstance
 
 	bool update_ph2()
 	{
+		if (compiled)
+			return compiled->update_ph2();
+
 		bool did_something = false;
 
 		for (auto &it : ff_database)
@@ -402,10 +1456,10 @@ struct SimInstance
 			Cell *cell = it.first;
 			ff_state_t &ff = it.second;
 
-			if (cell->type.in("$dff"))
+			if (is_sim_ff(cell))
 			{
-				bool clkpol = cell->getParam("\\CLK_POLARITY").as_bool();
-				State current_clock = get_state(cell->getPort("\\CLK"))[0];
+				bool clkpol = ff_clock_polarity(cell);
+				State current_clock = get_state(cell->getPort(ff_clock_port(cell)))[0];
 
 				if (clkpol ? (ff.past_clock == State::S1 || current_clock != State::S1) :
 						(ff.past_clock == State::S0 || current_clock != State::S0))
@@ -479,13 +1533,18 @@ struct SimInstance
 
 	void update_ph3()
 	{
+		if (compiled) {
+			compiled->update_ph3(hiername());
+			return;
+		}
+
 		for (auto &it : ff_database)
 		{
 			Cell *cell = it.first;
 			ff_state_t &ff = it.second;
 
-			if (cell->type.in("$dff")) {
-				ff.past_clock = get_state(cell->getPort("\\CLK"))[0];
+			if (is_sim_ff(cell)) {
+				ff.past_clock = get_state(cell->getPort(ff_clock_port(cell)))[0];
 				ff.past_d = get_state(cell->getPort("\\D"));
 			}
 		}
@@ -570,7 +1629,7 @@ struct SimInstance
 			it.second->writeback(wbmods);
 	}
 
-	void write_vcd_header(std::ofstream &f, int &id)
+	void write_vcd_header(SimVcdWriter &f, int &id)
 	{
 		f << stringf("$scope module %s $end\n", log_id(name()));
 
@@ -579,8 +1638,9 @@ struct SimInstance
 			if (shared->hide_internal && wire->name[0] == '$')
 				continue;
 
-			f << stringf("$var wire %d n%d %s%s $end\n", GetSize(wire), id, wire->name[0] == '$' ? "\\" : "", log_id(wire));
-			vcd_database[wire] = make_pair(id++, Const());
+			std::string code = f.id_code(id++);
+			f << stringf("$var wire %d %s %s%s $end\n", GetSize(wire), code.c_str(), wire->name[0] == '$' ? "\\" : "", log_id(wire));
+			vcd_database[wire] = make_pair(code, Const());
 		}
 
 		for (auto child : children)
@@ -589,30 +1649,18 @@ struct SimInstance
 		f << stringf("$upscope $end\n");
 	}
 
-	void write_vcd_step(std::ofstream &f)
+	void write_vcd_step(SimVcdWriter &f)
 	{
 		for (auto &it : vcd_database)
 		{
 			Wire *wire = it.first;
 			Const value = get_state(wire);
-			int id = it.second.first;
 
 			if (it.second.second == value)
 				continue;
 
 			it.second.second = value;
-
-			f << "b";
-			for (int i = GetSize(value)-1; i >= 0; i--) {
-				switch (value[i]) {
-					case State::S0: f << "0"; break;
-					case State::S1: f << "1"; break;
-					case State::Sx: f << "x"; break;
-					default: f << "z";
-				}
-			}
-
-			f << stringf(" n%d\n", id);
+			f.change(value, it.second.first);
 		}
 
 		for (auto child : children)
@@ -623,9 +1671,24 @@ struct SimInstance
 struct SimWorker : SimShared
 {
 	SimInstance *top = nullptr;
-	std::ofstream vcdfile;
+	SimVcdWriter vcdfile;
+	SimVcdReader vcdin;
+	bool has_vcdin = false;
 	pool<IdString> clock, clockn, reset, resetn;
 
+	// -parallel mode
+	bool parallel = false;
+	bool random_inputs = false;
+	uint64_t seed = 0;
+	std::string stimulus_file;
+
+	struct stimulus_t
+	{
+		int lane;
+		Wire *port;
+		Const value;
+	};
+
 	~SimWorker()
 	{
 		delete top;
@@ -673,6 +1736,16 @@ struct SimWorker : SimShared
 		top->update_ph3();
 	}
 
+	void read_vcd_inputs(int t)
+	{
+		if (!has_vcdin)
+			return;
+
+		vcdin.advance(t, [&](Wire *wire, const Const &value) {
+			top->set_state(wire, value);
+		});
+	}
+
 	void set_inports(pool<IdString> ports, State value)
 	{
 		for (auto portname : ports)
@@ -702,6 +1775,7 @@ struct SimWorker : SimShared
 		set_inports(clock, State::Sx);
 		set_inports(clockn, State::Sx);
 
+		read_vcd_inputs(0);
 		update();
 
 		write_vcd_header();
@@ -715,6 +1789,7 @@ struct SimWorker : SimShared
 			set_inports(clock, State::S0);
 			set_inports(clockn, State::S1);
 
+			read_vcd_inputs(10*cycle + 5);
 			update();
 			write_vcd_step(10*cycle + 5);
 
@@ -731,17 +1806,137 @@ struct SimWorker : SimShared
 				set_inports(resetn, State::S1);
 			}
 
+			read_vcd_inputs(10*cycle + 10);
 			update();
 			write_vcd_step(10*cycle + 10);
 		}
 
 		write_vcd_step(10*numcycles + 2);
+		vcdfile.close();
 
 		if (writeback) {
 			pool<Module*> wbmods;
 			top->writeback(wbmods);
 		}
 	}
+
+	// Lines of the form "<cycle> <lane> <port> <binary value>", '#' starts
+	// a comment. A lane keeps the value of an input until it is set again.
+	dict<int, vector<stimulus_t>> read_stimulus(Module *topmod)
+	{
+		dict<int, vector<stimulus_t>> stimulus;
+		std::ifstream f(stimulus_file);
+		if (f.fail())
+			log_cmd_error("Can't open stimulus file `%s'.\n", stimulus_file.c_str());
+
+		std::string line;
+		for (int linenr = 1; std::getline(f, line); linenr++)
+		{
+			line = line.substr(0, line.find('#'));
+			std::istringstream ss(line);
+			int cycle, lane;
+			std::string portname, value;
+			if (!(ss >> cycle))
+				continue;
+			if (!(ss >> lane >> portname >> value) || lane < 0 || lane >= SimParallel::lanes)
+				log_cmd_error("Syntax error in stimulus file `%s', line %d.\n", stimulus_file.c_str(), linenr);
+			Wire *port = topmod->wire(RTLIL::escape_id(portname));
+			if (port == nullptr || !port->port_input)
+				log_cmd_error("Stimulus file `%s', line %d: %s is not an input of module %s.\n",
+						stimulus_file.c_str(), linenr, portname.c_str(), log_id(topmod));
+			Const c = Const::from_string(value);
+			c.bits.resize(GetSize(port), State::S0);
+			stimulus[cycle].push_back(stimulus_t{lane, port, c});
+		}
+		return stimulus;
+	}
+
+	void run_parallel(Module *topmod, int numcycles)
+	{
+		SigMap sigmap(topmod);
+		SimCompiled *sc = SimCompiled::compile(this, topmod, sigmap);
+		if (sc == nullptr)
+			log_cmd_error("Module %s can't be simulated with -parallel.\n", log_id(topmod));
+		SimParallel sp(sc);
+
+		dict<int, vector<stimulus_t>> stimulus;
+		if (!stimulus_file.empty())
+			stimulus = read_stimulus(topmod);
+
+		vector<vector<int>> data_inputs;
+		for (auto wire : topmod->wires())
+			if (wire->port_input && !clock.count(wire->name) && !clockn.count(wire->name) &&
+					!reset.count(wire->name) && !resetn.count(wire->name))
+				data_inputs.push_back(sc->index(SigSpec(wire)));
+
+		auto set_inports = [&](pool<IdString> ports, bool value) {
+			for (auto portname : ports) {
+				Wire *w = topmod->wire(portname);
+				if (w == nullptr)
+					log_error("Can't find port %s on module %s.\n", log_id(portname), log_id(topmod));
+				for (int net : sc->index(SigSpec(w)))
+					sp.nets[net] = value ? ~uint64_t(0) : 0;
+			}
+		};
+
+		std::mt19937_64 rng(seed);
+
+		log("Simulating %d cycles with %d lanes.\n", numcycles, SimParallel::lanes);
+
+		set_inports(reset, true);
+		set_inports(resetn, false);
+		sp.update(0);
+		sp.sample(0);
+
+		for (int cycle = 0; cycle < numcycles; cycle++)
+		{
+			if (random_inputs)
+				for (auto &sig : data_inputs)
+					for (int net : sig)
+						sp.nets[net] = rng();
+
+			if (stimulus.count(cycle))
+				for (auto &stim : stimulus.at(cycle)) {
+					vector<int> sig = sc->index(SigSpec(stim.port));
+					for (int i = 0; i < GetSize(sig); i++)
+						sp.set_lane(sig[i], stim.lane, stim.value[i]);
+				}
+
+			set_inports(clock, false);
+			set_inports(clockn, true);
+			sp.update(cycle);
+
+			set_inports(clock, true);
+			set_inports(clockn, false);
+
+			if (cycle+1 == rstlen) {
+				set_inports(reset, false);
+				set_inports(resetn, true);
+			}
+
+			sp.update(cycle+1);
+			sp.sample(cycle+1);
+		}
+
+		log("\n");
+		log("    %-40s %12s %10s\n", "net", "toggles", "diverged");
+		for (auto wire : topmod->wires())
+		{
+			if (hide_internal && wire->name[0] == '$')
+				continue;
+
+			int64_t wire_toggles = 0;
+			int wire_divergence = -1;
+			for (int net : sc->index(SigSpec(wire))) {
+				wire_toggles += sp.toggles[net];
+				if (sp.first_divergence[net] >= 0 && (wire_divergence < 0 || sp.first_divergence[net] < wire_divergence))
+					wire_divergence = sp.first_divergence[net];
+			}
+
+			log("    %-40s %12lld %10s\n", log_id(wire), (long long)wire_toggles,
+					wire_divergence < 0 ? "-" : stringf("%d", wire_divergence).c_str());
+		}
+	}
 };
 
 struct SimPass : public Pass {
@@ -755,7 +1950,20 @@ struct SimPass : public Pass {
 		log("This command simulates the circuit using the given top-level module.\n");
 		log("\n");
 		log("    -vcd <filename>\n");
-		log("        write the simulation results to the given VCD file\n");
+		log("        write the simulation results to the given VCD file. the output is\n");
+		log("        gzip-compressed if the file name ends in .gz.\n");
+		log("\n");
+		log("    -vcdcompact\n");
+		log("        write the VCD file with short identifiers, 1-bit values without the\n");
+		log("        'b' prefix and vector values without redundant leading bits, like\n");
+		log("        most other VCD writers. this makes large dumps considerably smaller.\n");
+		log("\n");
+		log("    -vcdin <filename>\n");
+		log("        drive top-level inputs from the variables of the same name in the\n");
+		log("        top scope of the given (optionally gzip-compressed) VCD file. the\n");
+		log("        file is read incrementally. changes are applied before the time\n");
+		log("        steps 0, 10*k+5 (falling clock) and 10*k+10 (rising clock) used\n");
+		log("        by this command, and take precedence over -clock and -reset.\n");
 		log("\n");
 		log("    -clock <portname>\n");
 		log("        name of top-level clock input\n");
@@ -787,18 +1995,49 @@ struct SimPass : public Pass {
 		log("    -d\n");
 		log("        enable debug output\n");
 		log("\n");
+		log("    -parallel\n");
+		log("        simulate 64 independent stimuli at once with two-valued logic on\n");
+		log("        the compiled schedule (see -compiled), and report the number of\n");
+		log("        toggles summed over all lanes and the first cycle at which the\n");
+		log("        lanes disagree for every net. $_DFF_P_ and $_DFF_N_ cells are\n");
+		log("        supported in this mode, undefined initial values are zero.\n");
+		log("\n");
+		log("    -seed <integer>\n");
+		log("        with -parallel: drive all data inputs with random values from a\n");
+		log("        generator with the given seed in every cycle\n");
+		log("\n");
+		log("    -stimulus <filename>\n");
+		log("        with -parallel: read input values from a file with lines of the\n");
+		log("        form '<cycle> <lane> <port> <binary value>'. a lane keeps the\n");
+		log("        value of an input until it is set again.\n");
+		log("\n");
+		log("    -compiled\n");
+		log("        levelize the top module once and simulate it with a schedule of\n");
+		log("        bit-level kernels on a flat net array. the results are the same as\n");
+		log("        without this option. designs with hierarchy, memories or\n");
+		log("        combinational loops are simulated without it.\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
 	{
 		SimWorker worker;
 		int numcycles = 20;
+		std::string vcdin_file;
 
 		log_header(design, "Executing SIM pass (simulate the circuit).\n");
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
 			if (args[argidx] == "-vcd" && argidx+1 < args.size()) {
-				worker.vcdfile.open(args[++argidx].c_str());
+				worker.vcdfile.open(args[++argidx]);
+				continue;
+			}
+			if (args[argidx] == "-vcdcompact") {
+				worker.vcdfile.compact = true;
+				continue;
+			}
+			if (args[argidx] == "-vcdin" && argidx+1 < args.size()) {
+				vcdin_file = args[++argidx];
 				continue;
 			}
 			if (args[argidx] == "-n" && argidx+1 < args.size()) {
@@ -841,6 +2080,23 @@ struct SimPass : public Pass {
 				worker.zinit = true;
 				continue;
 			}
+			if (args[argidx] == "-compiled") {
+				worker.compiled = true;
+				continue;
+			}
+			if (args[argidx] == "-parallel") {
+				worker.parallel = true;
+				continue;
+			}
+			if (args[argidx] == "-seed" && argidx+1 < args.size()) {
+				worker.random_inputs = true;
+				worker.seed = strtoull(args[++argidx].c_str(), nullptr, 0);
+				continue;
+			}
+			if (args[argidx] == "-stimulus" && argidx+1 < args.size()) {
+				worker.stimulus_file = args[++argidx];
+				continue;
+			}
 			break;
 		}
 		extra_args(args, argidx, design);
@@ -859,7 +2115,20 @@ struct SimPass : public Pass {
 			top_mod = mods.front();
 		}
 
-		worker.run(top_mod, numcycles);
+		if (!vcdin_file.empty()) {
+			worker.vcdin.open(vcdin_file, top_mod);
+			worker.has_vcdin = true;
+		}
+
+		if (worker.parallel) {
+			if (worker.vcdfile.is_open() || worker.has_vcdin || worker.writeback)
+				log_cmd_error("Options -vcd, -vcdin and -w are not supported with -parallel.\n");
+			worker.run_parallel(top_mod, numcycles);
+		} else {
+			if (worker.random_inputs || !worker.stimulus_file.empty())
+				log_cmd_error("Options -seed and -stimulus require -parallel.\n");
+			worker.run(top_mod, numcycles);
+		}
 	}
 } SimPass;
 
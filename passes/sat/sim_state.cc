@@ -62,9 +62,18 @@ struct SimPass : public Pass {
     log("    -zinit\n");
     log("        zero-initialize all uninitialized regs and memories\n");
     log("\n");
+    log("    -equiv\n");
+    log("        at the end of each cycle, use the solver to check nets whose "
+        "value\n");
+    log("        changed structurally and keep the old value where both are "
+        "equivalent\n");
+    log("\n");
     log("    -n <integer>\n");
     log("        number of cycles to simulate (default: 20)\n");
     log("\n");
+    log("    -set <portname> <value>\n");
+    log("        hold the given top-level input at a constant value\n");
+    log("\n");
     log("    -a\n");
     log("        include all nets in VCD output, not just those with public "
         "names\n");
@@ -76,11 +85,99 @@ struct SimPass : public Pass {
     log("    -d\n");
     log("        enable debug output\n");
     log("\n");
+    log("    -scenarios <filename>\n");
+    log("        run a batch of scenarios on a single elaboration of the "
+        "design. each\n");
+    log("        non-empty line of the file that does not start with '#' is "
+        "one\n");
+    log("        scenario:\n");
+    log("\n");
+    log("            <name> [options]\n");
+    log("\n");
+    log("        where options are -n, -rstlen, -clock, -clockn, -reset, "
+        "-resetn,\n");
+    log("        -set and -vcd as above, and -summary <filename> to write the "
+        "final\n");
+    log("        value of every net of this scenario. options given on the "
+        "command\n");
+    log("        line are the defaults for all scenarios. a merged per-net "
+        "summary is\n");
+    log("        printed at the end.\n");
+    log("\n");
+    log("    -j <integer>\n");
+    log("        number of scenarios simulated in parallel (default: 1)\n");
+    log("\n");
+    log("    -summary <filename>\n");
+    log("        with -scenarios, write the merged summary as a table with "
+        "one row\n");
+    log("        per net and one column per scenario\n");
+    log("\n");
   }
+
+  // Parse one line of a -scenarios file on top of the command line defaults.
+  static SimScenario parse_scenario(const SimScenario &defaults,
+                                    const std::string &line) {
+    SimScenario sc = defaults;
+    std::vector<std::string> tok = split_tokens(line);
+    sc.name = tok[0];
+    for (size_t i = 1; i < tok.size(); i++) {
+      bool has_arg = i + 1 < tok.size();
+      if (tok[i] == "-n" && has_arg) {
+        sc.numcycles = atoi(tok[++i].c_str());
+        continue;
+      }
+      if (tok[i] == "-rstlen" && has_arg) {
+        sc.rstlen = atoi(tok[++i].c_str());
+        continue;
+      }
+      if (tok[i] == "-clock" && has_arg) {
+        sc.clock.insert(RTLIL::escape_id(tok[++i]));
+        continue;
+      }
+      if (tok[i] == "-clockn" && has_arg) {
+        sc.clockn.insert(RTLIL::escape_id(tok[++i]));
+        continue;
+      }
+      if (tok[i] == "-reset" && has_arg) {
+        sc.reset.insert(RTLIL::escape_id(tok[++i]));
+        continue;
+      }
+      if (tok[i] == "-resetn" && has_arg) {
+        sc.resetn.insert(RTLIL::escape_id(tok[++i]));
+        continue;
+      }
+      if (tok[i] == "-set" && i + 2 < tok.size()) {
+        IdString port = RTLIL::escape_id(tok[++i]);
+        sc.pinned[port] = parse_value(tok[++i]);
+        continue;
+      }
+      if (tok[i] == "-vcd" && has_arg) {
+        sc.vcd_file = tok[++i];
+        continue;
+      }
+      if (tok[i] == "-summary" && has_arg) {
+        sc.summary_file = tok[++i];
+        continue;
+      }
+      log_cmd_error("Unknown option `%s' in scenario `%s'.\n", tok[i].c_str(),
+                    sc.name.c_str());
+    }
+    return sc;
+  }
+
+  static Const parse_value(const std::string &str) {
+    SigSpec sig;
+    if (!SigSpec::parse(sig, nullptr, str) || !sig.is_fully_const())
+      log_cmd_error("Invalid value `%s'.\n", str.c_str());
+    return sig.as_const();
+  }
+
   void execute(std::vector<std::string> args,
                RTLIL::Design *design) YS_OVERRIDE {
     SimStateWorker worker;
     int numcycles = 20;
+    std::string scenario_file, summary_file;
+    int jobs = 1;
 
     log_header(design, "Executing SIM pass (simulate the circuit).\n");
 
@@ -130,6 +227,27 @@ struct SimPass : public Pass {
         worker.zinit = true;
         continue;
       }
+      if (args[argidx] == "-equiv") {
+        worker.equiv_sweep = true;
+        continue;
+      }
+      if (args[argidx] == "-set" && argidx + 2 < args.size()) {
+        IdString port = RTLIL::escape_id(args[++argidx]);
+        worker.pinned[port] = parse_value(args[++argidx]);
+        continue;
+      }
+      if (args[argidx] == "-scenarios" && argidx + 1 < args.size()) {
+        scenario_file = args[++argidx];
+        continue;
+      }
+      if (args[argidx] == "-j" && argidx + 1 < args.size()) {
+        jobs = std::max(atoi(args[++argidx].c_str()), 1);
+        continue;
+      }
+      if (args[argidx] == "-summary" && argidx + 1 < args.size()) {
+        summary_file = args[++argidx];
+        continue;
+      }
       break;
     }
     extra_args(args, argidx, design);
@@ -145,7 +263,43 @@ struct SimPass : public Pass {
       top_mod = mods.front();
     }
 
-    worker.run(top_mod, numcycles);
+    if (scenario_file.empty()) {
+      worker.run(top_mod, numcycles);
+      return;
+    }
+
+    if (worker.writeback)
+      log_cmd_error("Option -w can't be used with -scenarios.\n");
+    if (worker.vcdfile.is_open())
+      log_cmd_error("Use -vcd inside the scenario file with -scenarios.\n");
+
+    SimScenario defaults;
+    defaults.numcycles = numcycles;
+    defaults.rstlen = worker.rstlen;
+    defaults.clock = worker.clock;
+    defaults.clockn = worker.clockn;
+    defaults.reset = worker.reset;
+    defaults.resetn = worker.resetn;
+    defaults.pinned = worker.pinned;
+
+    std::ifstream f(scenario_file.c_str());
+    if (f.fail())
+      log_cmd_error("Can't open scenario file `%s' for reading.\n",
+                    scenario_file.c_str());
+
+    std::vector<SimScenario> scenarios;
+    std::string line;
+    while (std::getline(f, line)) {
+      if (split_tokens(line).empty() || line[line.find_first_not_of(" \t")] == '#')
+        continue;
+      scenarios.push_back(parse_scenario(defaults, line));
+    }
+    if (scenarios.empty())
+      log_cmd_error("No scenarios in `%s'.\n", scenario_file.c_str());
+
+    log("Running %d scenarios with %d parallel jobs.\n", GetSize(scenarios),
+        jobs);
+    worker.run_scenarios(top_mod, scenarios, jobs, summary_file);
   }
 } SimPass;
 
@@ -21,26 +21,38 @@
 #include "kernel/log.h"
 #include "kernel/sigtools.h"
 #include "kernel/sym_celltypes.h"
+#include "kernel/sym_mem.h"
 #include "kernel/yosys.h"
+#include <algorithm>
+#include <fstream>
 #include <iostream> // std::cout
 #include <sstream>
 #include <string> // std::string
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 using RTLIL::StateSym;
 using RTLIL::SymConst;
+// per-cell and per-register progress of the simulation, see trace_channel
+YS_TRACE_CHANNEL(sim_state);
 struct SimShared {
   bool debug = false;
   bool hide_internal = true;
   bool writeback = false;
   bool zinit = false;
+  bool equiv_sweep = false;
   int rstlen = 1;
+  // symbolic values of all instances live in this session
+  SymSession *session = nullptr;
 };
 
 void zinit(SymConst &v) {
   for (int i = 0; i < v.size(); ++i) {
-    if (!RTLIL::is_true(v.bits[i]))
-      v.bits[i] = RTLIL::bit_val(0);
+    if (v.bits[i] != State::S1)
+      v.bits[i] = State::S0;
   }
 }
 
@@ -59,6 +71,10 @@ struct SimInstance {
   dict<SigBit, pool<Cell *>> upd_cells;
   dict<SigBit, pool<Wire *>> upd_outports;
 
+  // value of each bit before its first structural change in this cycle,
+  // checked for real changes by sweep_equiv()
+  dict<SigBit, RTLIL::StateSym> sweep_candidates;
+
   pool<SigBit> dirty_bits;
   pool<Cell *> dirty_cells;
   pool<SimInstance *, hash_ptr_ops> dirty_children;
@@ -73,7 +89,7 @@ struct SimInstance {
     SymConst past_wr_en;
     SymConst past_wr_addr;
     SymConst past_wr_data;
-    SymConst data;
+    SymMemory data;
   };
 
   dict<Cell *, ff_state_t> ff_database;
@@ -138,21 +154,17 @@ struct SimInstance {
       if (cell->type == "$mem") {
         mem_state_t mem;
 
-        mem.past_wr_clk = SymConst(cell->getPort("\\WR_CLK"));
-        mem.past_wr_en = SymConst(cell->getPort("\\WR_EN"));
-        mem.past_wr_addr = SymConst(cell->getPort("\\WR_ADDR"));
-        mem.past_wr_data = SymConst(cell->getPort("\\WR_DATA"));
-
-        mem.data = SymConst(cell->getParam("\\INIT"));
-        int sz = cell->getParam("\\SIZE").as_int() *
-                 cell->getParam("\\WIDTH").as_int();
+        mem.past_wr_clk = SymConst(State::Sx, GetSize(cell->getPort("\\WR_CLK")));
+        mem.past_wr_en = SymConst(State::Sx, GetSize(cell->getPort("\\WR_EN")));
+        mem.past_wr_addr = SymConst(State::Sx, GetSize(cell->getPort("\\WR_ADDR")));
+        mem.past_wr_data = SymConst(State::Sx, GetSize(cell->getPort("\\WR_DATA")));
 
-        if (GetSize(mem.data) > sz)
-          mem.data.bits.resize(sz);
-
-        while (GetSize(mem.data) < sz)
-          mem.data.push_back(StateSym(
-              State::Sx, cell->getPort("\\RD_DATA")[GetSize(mem.data)]));
+        mem.data = SymMemory(hiername() + "." + log_id(cell),
+                             cell->getParam("\\SIZE").as_int(),
+                             cell->getParam("\\OFFSET").as_int(),
+                             cell->getParam("\\ABITS").as_int(),
+                             cell->getParam("\\WIDTH").as_int(),
+                             cell->getParam("\\INIT"), shared->zinit);
 
         mem_database[cell] = mem;
       }
@@ -176,7 +188,6 @@ struct SimInstance {
       for (auto &it : mem_database) {
         mem_state_t &mem = it.second;
         zinit(mem.past_wr_en);
-        zinit(mem.data);
       }
     }
     //  std::cerr << "sim instance 4";
@@ -247,10 +258,11 @@ struct SimInstance {
     }
     log_assert(GetSize(sig) == GetSize(value));
     for (int i = 0; i < GetSize(sig); i++) {
-      if (!(state_nets.at(sig[i]) == value[i])) {
-        // log("%s, %s \n", state_nets.at(sig[i]).to_string().c_str(),
-        //    value[i].to_string().c_str());
-        state_nets.at(sig[i]) = value[i];
+      StateSym &current = state_nets.at(sig[i]);
+      if (current != value[i]) {
+        if (shared->equiv_sweep && sweep_candidates.count(sig[i]) == 0)
+          sweep_candidates.insert(std::make_pair(sig[i], current));
+        current = value[i];
         dirty_bits.insert(sig[i]);
 
         did_something = true;
@@ -263,8 +275,7 @@ struct SimInstance {
   }
 
   void update_cell(Cell *cell) {
-    //  log_cell(cell);
-    log("%s\n", log_id(cell->type));
+    log_trace(sim_state, "%s\n", log_id(cell->type));
     if (ff_database.count(cell))
       return;
 
@@ -276,8 +287,6 @@ struct SimInstance {
 
       int num_rd_ports = cell->getParam("\\RD_PORTS").as_int();
 
-      int size = cell->getParam("\\SIZE").as_int();
-      int offset = cell->getParam("\\OFFSET").as_int();
       int abits = cell->getParam("\\ABITS").as_int();
       int width = cell->getParam("\\WIDTH").as_int();
 
@@ -291,14 +300,8 @@ struct SimInstance {
 
       for (int port_idx = 0; port_idx < num_rd_ports; port_idx++) {
         SymConst addr = get_state(rd_addr_sig.extract(port_idx * abits, abits));
-        SymConst data = SymConst(State::Sx, width);
-
-        if (addr.is_fully_def()) {
-          int index = addr.as_int() - offset;
-          if (index >= 0 && index < size)
-            data = mem.data.extract(index * width, width);
-        }
-        set_state(rd_data_sig.extract(port_idx * width, width), data);
+        set_state(rd_data_sig.extract(port_idx * width, width),
+                  mem.data.read(addr));
       }
       return;
     }
@@ -394,10 +397,8 @@ struct SimInstance {
       dirty_bits.clear();
 
       if (!queue_cells.empty()) {
-        for (auto cell : queue_cells) {
+        for (auto cell : queue_cells)
           update_cell(cell);
-          std::cerr << "finish update cell\n";
-        }
         queue_cells.clear();
         continue;
       }
@@ -437,8 +438,9 @@ struct SimInstance {
           continue;
 
         if (set_state(cell->getPort("\\Q"), ff.past_d)) {
-          log("%s is changed to ", log_signal(cell->getPort("\\Q")));
-          log("%s\n", ff.past_d.as_string().c_str());
+          log_trace(sim_state, "%s is changed to %s\n",
+                    log_signal(cell->getPort("\\Q")),
+                    ff.past_d.as_string().c_str());
           did_something = true;
         }
       }
@@ -450,8 +452,6 @@ struct SimInstance {
 
       int num_wr_ports = cell->getParam("\\WR_PORTS").as_int();
 
-      int size = cell->getParam("\\SIZE").as_int();
-      int offset = cell->getParam("\\OFFSET").as_int();
       int abits = cell->getParam("\\ABITS").as_int();
       int width = cell->getParam("\\WIDTH").as_int();
 
@@ -480,18 +480,15 @@ struct SimInstance {
           addr = mem.past_wr_addr.extract(port_idx * abits, abits);
           data = mem.past_wr_data.extract(port_idx * width, width);
           enable = mem.past_wr_en.extract(port_idx * width, width);
+
+          // the edge is consumed by this write, the following settle passes
+          // of the same cycle must not repeat it
+          mem.past_wr_clk.bits[port_idx] = current_wr_clk[port_idx];
         }
 
-        if (addr.is_fully_def()) {
-          int index = addr.as_int() - offset;
-          if (index >= 0 && index < size)
-            for (int i = 0; i < width; i++)
-              if (enable[i] == State::S1 &&
-                  mem.data[index * width + i] != data[i]) {
-                mem.data.bits[index * width + i] = data.bits[i];
-                dirty_cells.insert(cell);
-                did_something = true;
-              }
+        if (mem.data.write(addr, data, enable)) {
+          dirty_cells.insert(cell);
+          did_something = true;
         }
       }
     }
@@ -505,7 +502,34 @@ struct SimInstance {
     return did_something;
   }
 
+  // Restore the previous value of every bit whose new value is only
+  // structurally different from it, so that equivalent values keep a single
+  // canonical literal across cycles. Restored bits are marked dirty, so that
+  // the next update_ph1() rebuilds their fanout from the restored literals.
+  // Returns the number of restored bits.
+  int sweep_equiv() {
+    int restored = 0;
+    for (auto &it : sweep_candidates) {
+      StateSym &current = state_nets.at(it.first);
+      if (current != it.second && current.equivalent(it.second)) {
+        current = it.second;
+        dirty_bits.insert(it.first);
+        restored++;
+      }
+    }
+    for (auto it : children) {
+      int child_restored = it.second->sweep_equiv();
+      if (child_restored > 0) {
+        dirty_children.insert(it.second);
+        restored += child_restored;
+      }
+    }
+    return restored;
+  }
+
   void update_ph3() {
+    sweep_candidates.clear();
+
     for (auto &it : ff_database) {
       Cell *cell = it.first;
       ff_state_t &ff = it.second;
@@ -579,12 +603,12 @@ struct SimInstance {
     for (auto &it : mem_database) {
       Cell *cell = it.first;
       mem_state_t &mem = it.second;
-      SymConst initval = mem.data;
+      SymConst initval = mem.data.contents();
 
       while (GetSize(initval) >= 2) {
-        if (initval[GetSize(initval) - 1] != State::Sx)
+        if (initval[GetSize(initval) - 1].is_const())
           break;
-        if (initval[GetSize(initval) - 2] != State::Sx)
+        if (initval[GetSize(initval) - 2].is_const())
           break;
         initval.bits.pop_back();
       }
@@ -635,17 +659,31 @@ struct SimInstance {
     for (auto child : children)
       outsize += child.second->write_vcd_step(f);
 
-    log("sim size= %d", outsize);
+    log_trace(sim_state, "sim size= %d\n", outsize);
     return outsize;
   }
 };
 
+// One run of a scenario batch (sim_state -scenarios), see SimPass::help().
+struct SimScenario {
+  string name;
+  int numcycles = 20;
+  int rstlen = 1;
+  pool<IdString> clock, clockn, reset, resetn;
+  dict<IdString, Const> pinned;
+  string vcd_file, summary_file;
+};
+
 struct SimStateWorker : SimShared {
   SimInstance *top = nullptr;
   bool update_dff = true;
   std::ofstream vcdfile;
   pool<IdString> clock, clockn, reset, resetn;
+  // top-level inputs held at a constant value for the whole run
+  dict<IdString, Const> pinned;
+  SymSession worker_session;
 
+  SimStateWorker() { session = &worker_session; }
   ~SimStateWorker() { delete top; }
 
   void write_vcd_header() {
@@ -669,14 +707,12 @@ struct SimStateWorker : SimShared {
 
   void update() {
     while (1) {
-      std::cerr << "ph1\n";
       if (debug)
         log("\n-- ph1 --\n");
       top->update_ph1();
       if (!update_dff) {
         break;
       }
-      std::cerr << "ph2\n";
       if (debug)
         log("\n-- ph2 --\n");
 
@@ -684,6 +720,19 @@ struct SimStateWorker : SimShared {
         break;
     }
 
+    if (equiv_sweep) {
+      // the sweep marks the fanout of restored bits dirty. restoring does not
+      // change any value, so settling the combinational logic again is
+      // enough, until there is nothing left to restore
+      int restored, total = 0;
+      while ((restored = top->sweep_equiv()) > 0) {
+        total += restored;
+        top->update_ph1();
+      }
+      if (debug)
+        log("\n-- equiv sweep: %d bits unchanged --\n", total);
+    }
+
     if (debug)
       log("\n-- ph3 --\n");
     top->update_ph3();
@@ -700,15 +749,32 @@ struct SimStateWorker : SimShared {
     }
   }
 
-  void run(Module *topmod, int numcycles) {
+  void build(Module *topmod) {
     log_assert(top == nullptr);
-    // std::cerr << "new instance";
     top = new SimInstance(this, topmod);
+  }
+
+  void run(Module *topmod, int numcycles) {
+    SymSession::Scope scope(*session);
+    build(topmod);
+    simulate(numcycles);
+  }
+
+  void simulate(int numcycles) {
+    for (auto &it : pinned) {
+      Wire *w = top->module->wire(it.first);
+      if (w == nullptr)
+        log_error("Can't find port %s on module %s.\n", log_id(it.first),
+                  log_id(top->module));
+      SymConst value(it.second);
+      value.bits.resize(w->width, State::S0);
+      top->set_state(w, value);
+    }
 
     if (debug)
       log("\n===== 0 =====\n");
     else
-      std::cerr << ("Simulating cycle 0.\n");
+      log("Simulating cycle 0.\n");
     set_inports(reset, State::S1);
     set_inports(resetn, State::S0);
     set_inports(clock, State::Sx);
@@ -726,7 +792,6 @@ struct SimStateWorker : SimShared {
 
       set_inports(clock, State::S0);
       set_inports(clockn, State::S1);
-      std::cerr << "update\n";
       update();
       // write_vcd_step(10 * cycle + 5);
 
@@ -753,6 +818,184 @@ struct SimStateWorker : SimShared {
       top->writeback(wbmods);
     }
   }
+
+  // Final value of every net in the hierarchy, keyed by hierarchical name.
+  void get_summary(SimInstance *inst, std::vector<pair<string, string>> &out) {
+    for (auto wire : inst->module->wires()) {
+      if (hide_internal && wire->name[0] == '$')
+        continue;
+      string value = inst->get_state(wire).as_string();
+      std::replace(value.begin(), value.end(), '\n', ' ');
+      out.push_back(make_pair(inst->hiername() + "." + log_id(wire), value));
+    }
+    for (auto child : inst->children)
+      get_summary(child.second, out);
+  }
+
+  // Run one scenario on the (private) hierarchy of this worker and store its
+  // log and per-net summary next to 'prefix'. Returns the exit status.
+  int run_scenario(const SimScenario &sc, const string &prefix) {
+    std::ofstream logf(prefix + ".log");
+    log_files.clear();
+    log_streams.clear();
+    log_streams.push_back(&logf);
+
+    rstlen = sc.rstlen;
+    clock = sc.clock;
+    clockn = sc.clockn;
+    reset = sc.reset;
+    resetn = sc.resetn;
+    pinned = sc.pinned;
+    if (!sc.vcd_file.empty()) {
+      vcdfile.open(sc.vcd_file.c_str());
+      if (vcdfile.fail())
+        log_error("Can't open VCD file `%s' for writing.\n",
+                  sc.vcd_file.c_str());
+    }
+
+    simulate(sc.numcycles);
+
+    std::vector<pair<string, string>> summary;
+    get_summary(top, summary);
+    std::ofstream sumf(prefix + ".sum");
+    for (auto &it : summary)
+      sumf << it.first << "\t" << it.second << "\n";
+    if (!sc.summary_file.empty()) {
+      std::ofstream f(sc.summary_file.c_str());
+      for (auto &it : summary)
+        f << it.first << " " << it.second << "\n";
+    }
+
+    vcdfile.close();
+    log_flush();
+    return sumf.good() ? 0 : 1;
+  }
+
+  // Elaborate the hierarchy once, then fork one worker process per scenario
+  // (at most 'jobs' at a time). Every child starts from a copy-on-write image
+  // of the initial state_nets/ff_database/mem_database and the Z3 session, so
+  // scenarios neither re-elaborate the design nor share mutable state.
+  void run_scenarios(Module *topmod, const std::vector<SimScenario> &scenarios,
+                     int jobs, const string &merged_file) {
+#ifdef _WIN32
+    log_cmd_error("Scenario batches are not supported on this platform.\n");
+#else
+    SymSession::Scope scope(*session);
+    build(topmod);
+
+    string tmpdir = make_temp_dir("/tmp/yosys_sim_state_XXXXXX");
+    std::vector<int> status(GetSize(scenarios), -1);
+    dict<int, int> running;
+    int next = 0;
+
+    while (next < GetSize(scenarios) || !running.empty()) {
+      if (next < GetSize(scenarios) && GetSize(running) < jobs) {
+        log_flush();
+        pid_t pid = fork();
+        if (pid < 0)
+          log_error("fork() failed: %s\n", strerror(errno));
+        if (pid == 0) {
+          // errors of a scenario end up in its log, they must neither run the
+          // exit handlers of the parent nor unwind into its copy of the pass
+          // stack
+          log_errfile = nullptr;
+          log_error_atexit = nullptr;
+          int rc = 1;
+          try {
+            rc = run_scenario(scenarios[next], stringf("%s/%d", tmpdir.c_str(), next));
+          } catch (...) {
+          }
+          _exit(rc);
+        }
+        running[pid] = next++;
+        continue;
+      }
+      int wstatus = 0;
+      pid_t pid = waitpid(-1, &wstatus, 0);
+      if (pid < 0)
+        log_error("waitpid() failed: %s\n", strerror(errno));
+      if (running.count(pid) == 0)
+        continue;
+      int idx = running.at(pid);
+      running.erase(pid);
+      status[idx] = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128;
+    }
+
+    // merge the per-scenario results in scenario order
+    std::vector<string> nets;
+    dict<string, std::vector<string>> values;
+    int failed = 0;
+    for (int idx = 0; idx < GetSize(scenarios); idx++) {
+      const SimScenario &sc = scenarios[idx];
+      string prefix = stringf("%s/%d", tmpdir.c_str(), idx);
+      if (status[idx] != 0) {
+        failed++;
+        log("Scenario %s failed:\n", sc.name.c_str());
+        std::ifstream f(prefix + ".log");
+        string line;
+        while (std::getline(f, line))
+          log("  %s\n", line.c_str());
+        continue;
+      }
+      if (debug) {
+        std::ifstream f(prefix + ".log");
+        string line;
+        log("\n-- scenario %s --\n", sc.name.c_str());
+        while (std::getline(f, line))
+          log("%s\n", line.c_str());
+      }
+      log("Scenario %s: simulated %d cycles.\n", sc.name.c_str(), sc.numcycles);
+      std::ifstream f(prefix + ".sum");
+      string line;
+      while (std::getline(f, line)) {
+        size_t tab = line.find('\t');
+        if (tab == string::npos)
+          continue;
+        string net = line.substr(0, tab);
+        auto &v = values[net];
+        if (v.empty())
+          nets.push_back(net);
+        v.resize(idx, "-");
+        v.push_back(line.substr(tab + 1));
+      }
+    }
+    remove_directory(tmpdir);
+
+    log("\nMerged summary over %d scenarios:\n", GetSize(scenarios) - failed);
+    for (auto &net : nets) {
+      auto &v = values.at(net);
+      v.resize(GetSize(scenarios), "-");
+      pool<string> distinct;
+      for (int idx = 0; idx < GetSize(scenarios); idx++)
+        if (status[idx] == 0)
+          distinct.insert(v[idx]);
+      if (GetSize(distinct) == 1)
+        log("  %s = %s\n", net.c_str(), distinct.begin()->c_str());
+      else
+        log("  %s: %d distinct values\n", net.c_str(), GetSize(distinct));
+    }
+
+    if (!merged_file.empty()) {
+      std::ofstream f(merged_file.c_str());
+      if (f.fail())
+        log_error("Can't open summary file `%s' for writing.\n",
+                  merged_file.c_str());
+      f << "net";
+      for (auto &sc : scenarios)
+        f << "\t" << sc.name;
+      f << "\n";
+      for (auto &net : nets) {
+        f << net;
+        for (auto &val : values.at(net))
+          f << "\t" << val;
+        f << "\n";
+      }
+    }
+
+    if (failed)
+      log_error("%d of %d scenarios failed.\n", failed, GetSize(scenarios));
+#endif
+  }
 };
 
 PRIVATE_NAMESPACE_END
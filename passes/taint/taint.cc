@@ -22,6 +22,7 @@
 #include "kernel/rtlil.h"
 #include "kernel/sigtools.h"
 #include "passes/taint/taint_worker.h"
+#include <algorithm>
 #include <assert.h>
 #include <queue>
 #include <string>
@@ -132,6 +133,28 @@ struct TaintBackend : public Pass {
     log("\n");
     log("Options:\n");
     log("\n");
+    log("    -taint <wire>\n");
+    log("        taint source. can be given multiple times, every source is "
+        "tracked\n");
+    log("        as its own label and the summary lists which sources reach "
+        "each wire\n");
+    log("        and at which cycle.\n");
+    log("\n");
+    log("    -cycles <n>\n");
+    log("        maximum number of cycles to propagate (default: 2)\n");
+    log("\n");
+    log("    -summary <file>\n");
+    log("        also write a binary summary with an index by wire name, one "
+        "record\n");
+    log("        per tainted bit with its first cycle and the labels reaching "
+        "it. use\n");
+    log("        taint_query to read it.\n");
+    log("\n");
+    log("    -first_cycle\n");
+    log("        also write a table with one line per tainted bit and the "
+        "first cycle\n");
+    log("        it was tainted at.\n");
+    log("\n");
     log("    -verbose\n");
     log("        this will print the recursive walk used to export the "
         "modules.\n");
@@ -277,21 +300,33 @@ struct TaintBackend : public Pass {
   }
   void execute(std::vector<std::string> args,
                RTLIL::Design *design) YS_OVERRIDE {
-    pool<IdString> taint_vars;
+    std::vector<IdString> taint_vars;
     std::string filename;
     std::ostream *f = nullptr;
     int cycles = 2;
+    bool first_cycles = false;
+    std::string summary_file;
     size_t argidx;
     for (argidx = 1; argidx < args.size(); argidx++) {
       if (args[argidx] == "-taint" && argidx + 1 < args.size()) {
-        string var_name = args[++argidx];
-        taint_vars.insert("\\" + var_name);
+        IdString var_name = "\\" + args[++argidx];
+        if (std::find(taint_vars.begin(), taint_vars.end(), var_name) ==
+            taint_vars.end())
+          taint_vars.push_back(var_name);
         continue;
       }
       if (args[argidx] == "-cycles" && argidx + 1 < args.size()) {
         cycles = std::stoi(args[++argidx]);
         continue;
       }
+      if (args[argidx] == "-summary" && argidx + 1 < args.size()) {
+        summary_file = args[++argidx];
+        continue;
+      }
+      if (args[argidx] == "-first_cycle") {
+        first_cycles = true;
+        continue;
+      }
       break;
     }
     extra_args(f, filename, args, argidx);
@@ -305,9 +340,20 @@ struct TaintBackend : public Pass {
     TaintWorker taint_worker(module, taint_vars);
     cycles = taint_worker.Run(cycles);
     taint_worker.SumarizeTaint(f, 0, cycles);
+    if (first_cycles)
+      taint_worker.WriteFirstCycles(f);
+    if (!summary_file.empty()) {
+      std::ofstream sf(summary_file.c_str(), std::ios::binary);
+      if (sf.fail())
+        log_cmd_error("Can't open output file `%s' for writing: %s\n",
+                      summary_file.c_str(), strerror(errno));
+      taint_worker.WriteSummary(sf, cycles);
+    }
     TaintAnalyzer ta(module);
     ta.Summarize(f, taint_worker.GetTaintedWires());
     log("filename=%s", filename.c_str());
+    if (f != &std::cout)
+      delete f;
   }
 } TaintBackend;
 
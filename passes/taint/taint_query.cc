@@ -0,0 +1,153 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+#include "kernel/log.h"
+#include "kernel/register.h"
+#include "passes/taint/taint_summary.h"
+#include <fstream>
+#include <string>
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+using Yosys::backend::taint::TaintSummary;
+struct TaintQueryPass : public Pass {
+  TaintQueryPass()
+      : Pass("taint_query", "query a binary taint summary") {}
+  void help() YS_OVERRIDE {
+    //   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+    log("\n");
+    log("    taint_query [options] <summary file> [wire ...]\n");
+    log("\n");
+    log("Read a summary written by 'taint -summary' and print the tainted "
+        "bits of the\n");
+    log("given wires, or of all wires if none are given. One line is printed "
+        "per bit:\n");
+    log("\n");
+    log("    <wire>[<bit>] <first cycle> <label>@<cycle> ...\n");
+    log("\n");
+    log("Only the index of the summary is loaded, the bits of a wire are read "
+        "when\n");
+    log("the wire is queried.\n");
+    log("\n");
+    log("    -label <name>\n");
+    log("        only print bits reached by this taint source\n");
+    log("\n");
+    log("    -cycle <n>\n");
+    log("        only print bits tainted at cycle n or earlier (by the given "
+        "source\n");
+    log("        with -label)\n");
+    log("\n");
+    log("    -stats\n");
+    log("        only print the number of cycles, labels, wires and tainted "
+        "bits\n");
+    log("\n");
+  }
+  void execute(std::vector<std::string> args,
+               RTLIL::Design *design) YS_OVERRIDE {
+    std::string label_name;
+    int max_cycle = -1;
+    bool stats = false;
+
+    log_header(design, "Executing TAINT_QUERY pass.\n");
+
+    size_t argidx;
+    for (argidx = 1; argidx < args.size(); argidx++) {
+      if (args[argidx] == "-label" && argidx + 1 < args.size()) {
+        label_name = args[++argidx];
+        continue;
+      }
+      if (args[argidx] == "-cycle" && argidx + 1 < args.size()) {
+        max_cycle = std::stoi(args[++argidx]);
+        continue;
+      }
+      if (args[argidx] == "-stats") {
+        stats = true;
+        continue;
+      }
+      break;
+    }
+    if (argidx >= args.size())
+      cmd_error(args, argidx, "Missing summary file.");
+    std::string filename = args[argidx++];
+
+    std::ifstream f(filename.c_str(), std::ios::binary);
+    if (f.fail())
+      log_cmd_error("Can't open summary file `%s': %s\n", filename.c_str(),
+                    strerror(errno));
+    TaintSummary summary;
+    if (!summary.ReadIndex(f))
+      log_error("`%s' is not a taint summary.\n", filename.c_str());
+
+    if (stats) {
+      int num_tainted = 0;
+      for (auto &w : summary.wires)
+        num_tainted += w.num_bits;
+      log("cycles %d, labels %d, wires %d, tainted bits %d\n",
+          summary.num_cycles, GetSize(summary.labels),
+          GetSize(summary.wires), num_tainted);
+      return;
+    }
+
+    int label = -1;
+    if (!label_name.empty()) {
+      for (int i = 0; i < GetSize(summary.labels); i++)
+        if (label_name == summary.String(summary.labels[i]))
+          label = i;
+      if (label < 0)
+        log_cmd_error("No taint source `%s' in the summary.\n",
+                      label_name.c_str());
+    }
+
+    std::vector<int> wires;
+    for (; argidx < args.size(); argidx++) {
+      int wire = summary.FindWire(args[argidx]);
+      if (wire < 0)
+        log_cmd_error("No wire `%s' in the summary.\n", args[argidx].c_str());
+      wires.push_back(wire);
+    }
+    if (wires.empty())
+      for (int i = 0; i < GetSize(summary.wires); i++)
+        if (summary.wires[i].num_bits != 0)
+          wires.push_back(i);
+
+    std::vector<TaintSummary::BitEntry> bits;
+    std::vector<TaintSummary::HitEntry> hits;
+    for (int wire : wires) {
+      if (!summary.ReadWire(f, wire, bits, hits))
+        log_error("`%s' is truncated or corrupted.\n", filename.c_str());
+      const char *name = summary.String(summary.wires[wire].name);
+      for (auto &b : bits) {
+        if (max_cycle >= 0 && b.first_cycle > max_cycle)
+          continue;
+        std::string line = stringf("%s[%d] %d", name, b.bit, b.first_cycle);
+        bool found = label < 0;
+        for (uint32_t i = b.first_hit; i < b.first_hit + b.num_hits; i++) {
+          if (int(hits[i].label) == label &&
+              (max_cycle < 0 || hits[i].cycle <= max_cycle))
+            found = true;
+          line += stringf(" %s@%d", summary.String(summary.labels[hits[i].label]),
+                          hits[i].cycle);
+        }
+        if (found)
+          log("%s\n", line.c_str());
+      }
+    }
+  }
+} TaintQueryPass;
+
+PRIVATE_NAMESPACE_END
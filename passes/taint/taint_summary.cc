@@ -0,0 +1,193 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "passes/taint/taint_summary.h"
+#include <algorithm>
+#include <string.h>
+namespace Yosys {
+namespace backend {
+namespace taint {
+namespace {
+static const char kMagic[8] = {'Y', 'T', 'S', 'U', 'M', '0', '0', '1'};
+static const int kHeaderWords = 6;
+
+static void PutWord(std::string &buf, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    buf.push_back(char((v >> (8 * i)) & 0xff));
+}
+static uint32_t GetWord(const char *p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++)
+    v |= uint32_t(uint8_t(p[i])) << (8 * i);
+  return v;
+}
+// read 'count' records of 'words' words each
+static bool ReadWords(std::istream &f, size_t count, int words,
+                      std::vector<uint32_t> &out) {
+  std::string buf(count * words * 4, '\0');
+  if (!buf.empty() && !f.read(&buf[0], buf.size()))
+    return false;
+  out.resize(count * words);
+  for (size_t i = 0; i < out.size(); i++)
+    out[i] = GetWord(buf.data() + 4 * i);
+  return true;
+}
+} // namespace
+
+uint32_t TaintSummary::AddString(const std::string &str) {
+  uint32_t offset = strtab.size();
+  strtab += str;
+  strtab.push_back('\0');
+  return offset;
+}
+
+void TaintSummary::Write(std::ostream &f) const {
+  std::string buf(kMagic, sizeof(kMagic));
+  PutWord(buf, num_cycles);
+  PutWord(buf, labels.size());
+  PutWord(buf, wires.size());
+  PutWord(buf, bits.size());
+  PutWord(buf, hits.size());
+  PutWord(buf, strtab.size());
+  for (auto label : labels)
+    PutWord(buf, label);
+  for (auto &w : wires) {
+    PutWord(buf, w.name);
+    PutWord(buf, w.width);
+    PutWord(buf, w.first_bit);
+    PutWord(buf, w.num_bits);
+  }
+  f.write(buf.data(), buf.size());
+
+  // bits and hits can be large, write them in chunks
+  buf.clear();
+  for (auto &b : bits) {
+    PutWord(buf, b.bit);
+    PutWord(buf, b.first_cycle);
+    PutWord(buf, b.first_hit);
+    PutWord(buf, b.num_hits);
+    if (buf.size() >= 65536) {
+      f.write(buf.data(), buf.size());
+      buf.clear();
+    }
+  }
+  for (auto &h : hits) {
+    PutWord(buf, h.label);
+    PutWord(buf, h.cycle);
+    if (buf.size() >= 65536) {
+      f.write(buf.data(), buf.size());
+      buf.clear();
+    }
+  }
+  f.write(buf.data(), buf.size());
+  f.write(strtab.data(), strtab.size());
+}
+
+bool TaintSummary::ReadIndex(std::istream &f) {
+  char magic[sizeof(kMagic)];
+  if (!f.read(magic, sizeof(magic)) ||
+      memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    return false;
+  std::vector<uint32_t> header;
+  if (!ReadWords(f, 1, kHeaderWords, header))
+    return false;
+  num_cycles = header[0];
+  num_bits_ = header[3];
+  num_hits_ = header[4];
+
+  if (!ReadWords(f, header[1], 1, labels))
+    return false;
+  std::vector<uint32_t> words;
+  if (!ReadWords(f, header[2], 4, words))
+    return false;
+  wires.resize(header[2]);
+  for (size_t i = 0; i < wires.size(); i++)
+    wires[i] = WireEntry{words[4 * i], words[4 * i + 1], words[4 * i + 2],
+                         words[4 * i + 3]};
+
+  bits_offset_ = f.tellg();
+  hits_offset_ = bits_offset_ + std::streamoff(num_bits_) * 16;
+  f.seekg(hits_offset_ + std::streamoff(num_hits_) * 8);
+  strtab.assign(header[5], '\0');
+  if (!strtab.empty() && !f.read(&strtab[0], strtab.size()))
+    return false;
+  if (!strtab.empty() && strtab.back() != '\0')
+    return false;
+
+  for (auto label : labels)
+    if (label >= strtab.size())
+      return false;
+  for (auto &w : wires)
+    if (w.name >= strtab.size() ||
+        uint64_t(w.first_bit) + w.num_bits > num_bits_)
+      return false;
+  return true;
+}
+
+int TaintSummary::FindWire(const std::string &name) const {
+  auto it = std::lower_bound(wires.begin(), wires.end(), name,
+                             [&](const WireEntry &w, const std::string &n) {
+                               return strcmp(String(w.name), n.c_str()) < 0;
+                             });
+  if (it == wires.end() || name != String(it->name))
+    return -1;
+  return it - wires.begin();
+}
+
+bool TaintSummary::ReadWire(std::istream &f, int wire,
+                            std::vector<BitEntry> &bits,
+                            std::vector<HitEntry> &hits) const {
+  const WireEntry &w = wires.at(wire);
+  bits.clear();
+  hits.clear();
+  if (w.num_bits == 0)
+    return true;
+
+  std::vector<uint32_t> words;
+  f.clear();
+  f.seekg(bits_offset_ + std::streamoff(w.first_bit) * 16);
+  if (!ReadWords(f, w.num_bits, 4, words))
+    return false;
+  for (size_t i = 0; i < w.num_bits; i++)
+    bits.push_back(BitEntry{words[4 * i], int32_t(words[4 * i + 1]),
+                            words[4 * i + 2], words[4 * i + 3]});
+
+  // the hits of consecutive bits are consecutive as well
+  uint32_t first_hit = bits.front().first_hit;
+  uint32_t end_hit = bits.back().first_hit + bits.back().num_hits;
+  if (end_hit < first_hit || end_hit > num_hits_)
+    return false;
+  f.seekg(hits_offset_ + std::streamoff(first_hit) * 8);
+  if (!ReadWords(f, end_hit - first_hit, 2, words))
+    return false;
+  for (size_t i = 0; i < end_hit - first_hit; i++)
+    hits.push_back(HitEntry{words[2 * i], int32_t(words[2 * i + 1])});
+  for (auto &b : bits) {
+    if (b.first_hit < first_hit || b.first_hit + b.num_hits > end_hit)
+      return false;
+    b.first_hit -= first_hit;
+  }
+  for (auto &h : hits)
+    if (h.label >= labels.size())
+      return false;
+  return true;
+}
+} // namespace taint
+} // namespace backend
+} // namespace Yosys
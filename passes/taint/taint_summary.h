@@ -0,0 +1,90 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef _TAINT_SUMMARY_HEADER
+#define _TAINT_SUMMARY_HEADER
+#include "kernel/yosys.h"
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+namespace Yosys {
+namespace backend {
+namespace taint {
+// Binary taint summary written by 'taint -summary' and read by taint_query.
+// All integers are 32-bit little endian. The file is made of six tables:
+//
+//   header  "YTSUM001", num_cycles, num_labels, num_wires, num_bits,
+//           num_hits, strtab_size
+//   labels  num_labels x {name}
+//   wires   num_wires x {name, width, first bit, number of bits}, sorted
+//           by name
+//   bits    num_bits x {bit, first cycle, first hit, number of hits}, the
+//           tainted bits of each wire in one consecutive range
+//   hits    num_hits x {label, cycle}, the labels reaching a bit and the
+//           first cycle each of them did
+//   strtab  zero-terminated names, 'name' fields are offsets into it
+//
+// The header, labels, wires and names form an index that is read on its
+// own; the bits and hits of a wire are then read with a single seek.
+class TaintSummary {
+public:
+  struct WireEntry {
+    uint32_t name, width, first_bit, num_bits;
+  };
+  struct BitEntry {
+    uint32_t bit;
+    int32_t first_cycle;
+    uint32_t first_hit, num_hits;
+  };
+  struct HitEntry {
+    uint32_t label;
+    int32_t cycle;
+  };
+
+  int num_cycles = 0;
+  std::vector<uint32_t> labels;
+  // must be sorted by name, FindWire() relies on it
+  std::vector<WireEntry> wires;
+  std::vector<BitEntry> bits;
+  std::vector<HitEntry> hits;
+  std::string strtab;
+
+  uint32_t AddString(const std::string &str);
+  const char *String(uint32_t offset) const { return strtab.c_str() + offset; }
+  void Write(std::ostream &f) const;
+
+  // Read everything but the bits and hits. Returns false on a malformed
+  // file or a format version mismatch.
+  bool ReadIndex(std::istream &f);
+  // Binary search in the wire index, -1 if there is no such wire.
+  int FindWire(const std::string &name) const;
+  // Read the bits and hits of one wire into 'bits' and 'hits', hit
+  // indexes of the returned bits are relative to 'hits'.
+  bool ReadWire(std::istream &f, int wire, std::vector<BitEntry> &bits,
+                std::vector<HitEntry> &hits) const;
+
+private:
+  uint32_t num_bits_ = 0, num_hits_ = 0;
+  std::streamoff bits_offset_ = 0, hits_offset_ = 0;
+};
+} // namespace taint
+} // namespace backend
+} // namespace Yosys
+#endif
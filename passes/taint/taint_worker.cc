@@ -1,9 +1,11 @@
 #include "passes/taint/taint_worker.h"
+#include "passes/taint/taint_summary.h"
 #include "kernel/celltypes.h"
 #include "kernel/log.h"
 #include "kernel/register.h"
 #include "kernel/rtlil.h"
 #include "kernel/sigtools.h"
+#include <algorithm>
 #include <assert.h>
 #include <queue>
 #include <string>
@@ -21,188 +23,385 @@ static bool IsBitOp(Cell *cell) {
                        "$logic_or", "$not", "$neg", "$mux") ||
          IsClockCell(cell);
 }
+static uint64_t low_mask(int len) {
+  return len >= 64 ? ~uint64_t(0) : (uint64_t(1) << len) - 1;
+}
+static uint64_t get_bits(const uint64_t *v, int offset, int len) {
+  int word = offset >> 6, shift = offset & 63;
+  uint64_t bits = v[word] >> shift;
+  if (shift != 0 && shift + len > 64)
+    bits |= v[word + 1] << (64 - shift);
+  return bits & low_mask(len);
+}
 } // namespace
-vector<Cell *> TaintWorker::SortCell(RTLIL::Module *module) {
-  vector<Cell *> sorted_cells;
-  std::map<RTLIL::Cell *, std::set<RTLIL::Cell *>> cell_deps;
-  std::map<RTLIL::SigBit, RTLIL::Cell *> port_cells;
+// debug output of taint setup and cell splitting, see trace_channel
+YS_TRACE_CHANNEL(taint);
+CellGraph::CellGraph(RTLIL::Module *module, const SigMap &sigmap,
+                     bool cut_at_clock_cells)
+    : sigmap_(sigmap) {
   for (auto cell : module->cells())
-    if (!IsClockCell(cell))
-      for (auto conn : cell->connections())
-        if (cell->output(conn.first))
-          for (auto bit : conn.second) {
-            sigmap.apply(bit);
-            assert(port_cells.count(bit) == 0);
-            port_cells[bit] = cell;
-          }
-
-  std::queue<RTLIL::Cell *> cell_queue;
-  for (auto cell : module->cells()) {
+    cells_.push_back(cell);
+  fanin_.resize(cells_.size());
+  fanout_.resize(cells_.size());
+
+  for (int i = 0; i < Size(); i++) {
+    Cell *cell = cells_[i];
+    if (cut_at_clock_cells && IsClockCell(cell))
+      continue;
+    for (auto conn : cell->connections())
+      if (cell->output(conn.first))
+        for (auto bit : sigmap_(conn.second)) {
+          assert(driver_.count(bit) == 0);
+          driver_[bit] = i;
+        }
+  }
+
+  // stamp[j] == i if the edge j -> i was already added
+  std::vector<int> stamp(cells_.size(), -1);
+  for (int i = 0; i < Size(); i++) {
+    Cell *cell = cells_[i];
     for (auto conn : cell->connections())
       if (cell->input(conn.first))
-        for (auto bit : conn.second) {
-          sigmap.apply(bit);
-          if (port_cells.count(bit) > 0)
-            cell_deps[cell].insert(port_cells[bit]);
+        for (auto bit : sigmap_(conn.second)) {
+          auto it = driver_.find(bit);
+          if (it == driver_.end() || stamp[it->second] == i)
+            continue;
+          stamp[it->second] = i;
+          fanin_[i].push_back(it->second);
+          fanout_[it->second].push_back(i);
         }
+  }
+}
 
-    if (cell_deps.count(cell) == 0) {
-      cell_queue.push(cell);
-    }
+int CellGraph::Driver(const RTLIL::SigBit &bit) const {
+  auto it = driver_.find(sigmap_(bit));
+  return it == driver_.end() ? -1 : it->second;
+}
+
+std::vector<RTLIL::Cell *> CellGraph::TopologicalSort() const {
+  std::vector<RTLIL::Cell *> sorted_cells;
+  std::vector<int> in_degree(cells_.size());
+  std::queue<int> cell_queue;
+  sorted_cells.reserve(cells_.size());
+  for (int i = 0; i < Size(); i++) {
+    in_degree[i] = GetSize(fanin_[i]);
+    if (in_degree[i] == 0)
+      cell_queue.push(i);
   }
-  while (cell_queue.size() > 0) {
-    auto cell = cell_queue.front();
-    cell_deps.erase(cell);
+  while (!cell_queue.empty()) {
+    int i = cell_queue.front();
     cell_queue.pop();
-    sorted_cells.push_back(cell);
-    vector<RTLIL::Cell *> remove_cells;
-    for (auto &dep : cell_deps) {
-      dep.second.erase(cell);
-      if (dep.second.size() == 0) {
-        cell_queue.push(dep.first);
-        remove_cells.push_back(dep.first);
-      }
-    }
-    for (auto c : remove_cells) {
-      cell_deps.erase(c);
-    }
+    sorted_cells.push_back(cells_[i]);
+    for (int j : fanout_[i])
+      if (--in_degree[j] == 0)
+        cell_queue.push(j);
+  }
+  if (GetSize(sorted_cells) == Size())
+    return sorted_cells;
+
+  // The remaining cells are on a loop or driven from one. Peel off the ones
+  // that drive no remaining cell to report only the loops themselves.
+  std::vector<int> out_degree(cells_.size());
+  for (int i = 0; i < Size(); i++)
+    if (in_degree[i] > 0)
+      for (int j : fanout_[i])
+        if (in_degree[j] > 0)
+          out_degree[i]++;
+  for (int i = 0; i < Size(); i++)
+    if (in_degree[i] > 0 && out_degree[i] == 0)
+      cell_queue.push(i);
+  std::vector<bool> on_loop(cells_.size());
+  for (int i = 0; i < Size(); i++)
+    on_loop[i] = in_degree[i] > 0;
+  while (!cell_queue.empty()) {
+    int i = cell_queue.front();
+    cell_queue.pop();
+    on_loop[i] = false;
+    for (int j : fanin_[i])
+      if (on_loop[j] && --out_degree[j] == 0)
+        cell_queue.push(j);
   }
+
+  int num_loop_cells = 0;
+  std::string loop_cells;
+  for (int i = 0; i < Size(); i++)
+    if (on_loop[i] && num_loop_cells++ < 10)
+      loop_cells += stringf(" %s", log_id(cells_[i]));
+  log_warning("Found %d cells on combinational loops:%s%s\n", num_loop_cells,
+              loop_cells.c_str(), num_loop_cells > 10 ? " ..." : "");
+
+  for (int i = 0; i < Size(); i++)
+    if (in_degree[i] > 0)
+      sorted_cells.push_back(cells_[i]);
   return sorted_cells;
 }
-TaintWorker::TaintWorker(RTLIL::Module *module,
-                         const pool<IdString> &secret_vars)
-    : module_(module), increased_taint_(false) {
-  InitTaint(secret_vars);
-}
 
-void TaintWorker::SetTaint(const SigSpec &sig, int val, int cycle) {
-  for (auto bit : sig) {
-    // log("set taint %s at %d: %d\n", log_signal(bit), cycle, val);
-    if (val > 0 && taint_[bit].size() == 0) {
-      taint_[sigmap(bit)][cycle] = val;
-      increased_taint_ = true;
-    }
-  }
+vector<Cell *> TaintWorker::SortCell(RTLIL::Module *module) {
+  return CellGraph(module, sigmap, true).TopologicalSort();
 }
+TaintEngine::TaintEngine(RTLIL::Module *module, const SigMap &sigmap,
+                         const std::vector<RTLIL::Cell *> &sorted_cells,
+                         int num_labels)
+    : sigmap_(sigmap), num_labels_(num_labels), num_tainted_(0) {
+  // number bits wire by wire so that words get consecutive ids
+  for (auto wire : module->wires())
+    for (auto bit : sigmap_(wire))
+      if (bit.wire != nullptr && bit_ids_.count(bit) == 0) {
+        int id = GetSize(bit_ids_);
+        bit_ids_[bit] = id;
+      }
 
-void TaintWorker::SetTaints(const SigSpec &sig, vector<int> vals, int cycle) {
-  int i = 0;
-  for (auto bit : sig) {
-    // log("set taint %s at %d: %d\n", log_signal(bit), cycle, vals[i]);
-    if (vals[i] > 0 && taint_[bit].size() == 0) {
-      taint_[sigmap(bit)][cycle] = vals[i];
-      increased_taint_ = true;
-    }
-    ++i;
+  // one spare word per label so that runs can always touch word + 1
+  plane_words_ = GetSize(bit_ids_) / 64 + 2;
+  seen_.resize(size_t(num_labels_) * plane_words_);
+  cur_.resize(size_t(num_labels_) * plane_words_);
+  next_.resize(size_t(num_labels_) * plane_words_);
+  label_active_.resize(num_labels_);
+  first_cycle_.resize(bit_ids_.size(), -1);
+  label_cycles_.resize(bit_ids_.size());
+
+  for (auto cell : sorted_cells)
+    Compile(cell);
+
+  readers_.resize(bit_ids_.size());
+  queued_.resize(kernels_.size());
+  for (int k = 0; k < GetSize(kernels_); k++) {
+    const Kernel &kernel = kernels_[k];
+    for (auto runs : {&kernel.bitwise, &kernel.any_src})
+      for (auto &run : *runs)
+        for (int i = 0; i < run.len; i++) {
+          auto &readers = readers_[run.src + i];
+          if (readers.empty() || readers.back() != k)
+            readers.push_back(k);
+        }
   }
 }
-int TaintWorker::GetTaint(const SigBit &c_bit, int cycle) {
-  SigBit bit = c_bit;
-  sigmap.apply(bit);
-  if (taint_.count(bit) > 0 && taint_[bit].count(cycle) > 0) {
-    return taint_[sigmap(bit)][cycle];
-  }
-  return 0;
+
+int TaintEngine::BitId(const RTLIL::SigBit &bit) const {
+  auto it = bit_ids_.find(sigmap_(bit));
+  return it == bit_ids_.end() ? -1 : it->second;
 }
-vector<int> TaintWorker::GetTaints(const SigSpec &sig, int cycle) {
-  vector<int> taints;
-  for (auto bit : sig) {
-    taints.push_back(GetTaint(bit, cycle));
-    // log("%s: %d\t",log_signal(bit),taint_[bit]);
-  }
-  // log("\n");
-  return taints;
+
+int TaintEngine::FirstCycle(const RTLIL::SigBit &bit) const {
+  int id = BitId(bit);
+  return id < 0 ? -1 : first_cycle_[id];
 }
-void TaintWorker::InitTaint(const pool<IdString> &taint_vars) {
-  // merge signals ini sigmap
-  for (auto conn : module_->connections()) {
-    // log("connection %s %s\n", log_signal(conn.first),
-    // log_signal(conn.second));
-    sigmap.add(conn.second, conn.first);
-  }
-  // log("####module= %s\n", log_id(module_->name));
-  for (auto wire : module_->wires()) {
-    // log("wire %s %d %d\n", log_id(wire->name), wire->port_input,
-    // wire->port_output);
-    if (wire->name.in(taint_vars)) {
-      SetTaint(wire, 1, 0);
-      log("set initial taint %s", log_signal(RTLIL::SigSpec(wire)));
-    }
-  }
+
+const std::vector<std::pair<int, int>> &
+TaintEngine::LabelCycles(const RTLIL::SigBit &bit) const {
+  static const std::vector<std::pair<int, int>> empty;
+  int id = BitId(bit);
+  return id < 0 ? empty : label_cycles_[id];
 }
-void TaintWorker::TaintSigOp(Cell *cell, int cycle) {
-  // log_cell(cell);
-  pool<IdString> data_signals({"\\A", "\\B", "\\C", "\\D"});
-  pool<IdString> out_signals({"\\Y", "\\Q"});
-  int taint_cycle = cycle;
-  int taint = 0;
-  vector<SigSpec> outputs;
-  for (auto conn : cell->connections()) {
-    if (conn.first.in(data_signals)) {
-      auto taints = GetTaints(conn.second, cycle);
-      taint = max(taint, *max_element(taints.begin(), taints.end()));
-    } else if (conn.first.in(out_signals)) {
-      outputs.push_back(conn.second);
+
+std::vector<TaintEngine::BitRun>
+TaintEngine::MakeRuns(const std::vector<std::pair<int, int>> &bits) {
+  std::vector<BitRun> runs;
+  for (auto &it : bits) {
+    if (!runs.empty()) {
+      BitRun &last = runs.back();
+      if (last.len < 64 && (last.dst < 0 || it.first == last.dst + last.len) &&
+          (last.src < 0 || it.second == last.src + last.len)) {
+        last.len++;
+        continue;
+      }
     }
+    runs.push_back(BitRun{it.first, it.second, 1});
   }
-  if (IsClockCell(cell)) {
-    taint_cycle++;
-  }
-  for (auto output : outputs) {
-    SetTaint(output, taint, taint_cycle);
-  }
+  return runs;
 }
-void TaintWorker::TaintBitOp(Cell *cell, int cycle) {
-  // log_cell(cell);
+
+void TaintEngine::Compile(RTLIL::Cell *cell) {
   pool<IdString> data_signals({"\\A", "\\B", "\\C", "\\D"});
   pool<IdString> out_signals({"\\Y", "\\Q"});
   pool<IdString> condition_signals({"\\S", "\\E"});
-  int taint_cycle = cycle;
-  vector<SigSpec> outputs;
+  Kernel kernel;
+  kernel.clocked = IsClockCell(cell);
+  std::vector<std::pair<int, int>> bitwise, any_src, any_dst;
+
   if (IsBitOp(cell)) {
+    // output bit i gets the taint of bit i of every data input, plus the
+    // implicit taint of the branch condition
+    if (!cell->hasPort("\\Y") && !cell->hasPort("\\Q"))
+      return;
     auto output =
         cell->hasPort("\\Y") ? cell->getPort("\\Y") : cell->getPort("\\Q");
-    int size = output.size();
-    int implicit_taint = 0;
-    // port "\\S" is the branch condition.
-    for (auto condiction_port : condition_signals) {
-      if (cell->hasPort(condiction_port)) {
-        auto taints = GetTaints(cell->getPort(condiction_port), cycle);
-        assert(taints.size() == 1);
-        implicit_taint = max(implicit_taint, taints[0]);
-      }
-    }
-    std::vector<int> final_taints(size, implicit_taint);
+    for (auto port : condition_signals)
+      if (cell->hasPort(port))
+        for (auto bit : cell->getPort(port))
+          if (BitId(bit) >= 0)
+            any_src.push_back(std::make_pair(-1, BitId(bit)));
     for (auto conn : cell->connections()) {
-      if (conn.first.in(data_signals) && !conn.second.is_fully_const()) {
-        auto taints = GetTaints(conn.second, cycle);
-        for (int i = 0; i < min(int(taints.size()), size); ++i) {
-          final_taints[i] = max(final_taints[i], taints[i]);
-        }
+      if (!conn.first.in(data_signals) || conn.second.is_fully_const())
+        continue;
+      for (int i = 0; i < min(GetSize(conn.second), GetSize(output)); ++i)
+        if (BitId(output[i]) >= 0 && BitId(conn.second[i]) >= 0)
+          bitwise.push_back(
+              std::make_pair(BitId(output[i]), BitId(conn.second[i])));
+    }
+    if (!any_src.empty())
+      for (auto bit : output)
+        if (BitId(bit) >= 0)
+          any_dst.push_back(std::make_pair(BitId(bit), -1));
+  } else {
+    // any tainted data input taints all outputs
+    for (auto conn : cell->connections())
+      for (auto bit : conn.second) {
+        if (BitId(bit) < 0)
+          continue;
+        if (conn.first.in(data_signals))
+          any_src.push_back(std::make_pair(-1, BitId(bit)));
+        else if (conn.first.in(out_signals))
+          any_dst.push_back(std::make_pair(BitId(bit), -1));
       }
+    if (any_dst.empty())
+      any_src.clear();
+  }
+
+  // sort the bitwise pairs by destination to get long runs
+  std::sort(bitwise.begin(), bitwise.end());
+  kernel.bitwise = MakeRuns(bitwise);
+  kernel.any_src = MakeRuns(any_src);
+  kernel.any_dst = MakeRuns(any_dst);
+  if (!kernel.bitwise.empty() || !kernel.any_src.empty())
+    kernels_.push_back(kernel);
+}
+
+void TaintEngine::Schedule(int kernel) {
+  if (queued_[kernel])
+    return;
+  queued_[kernel] = true;
+  worklist_.push(kernel);
+}
+
+void TaintEngine::Mark(int label, int word, uint64_t bits, int cycle) {
+  int k = label * plane_words_ + word;
+  if (cur_[k] == 0)
+    cur_words_.push_back(k);
+  cur_[k] |= bits;
+  seen_[k] |= bits;
+  if (!label_active_[label]) {
+    label_active_[label] = true;
+    cur_labels_.push_back(label);
+  }
+
+  while (bits != 0) {
+    int id = word * 64 + __builtin_ctzll(bits);
+    bits &= bits - 1;
+    for (int r : readers_[id])
+      Schedule(r);
+    if (first_cycle_[id] < 0) {
+      first_cycle_[id] = cycle;
+      num_tainted_++;
     }
-    if (IsClockCell(cell)) {
-      taint_cycle++;
+    label_cycles_[id].push_back(std::make_pair(label, cycle));
+  }
+}
+
+void TaintEngine::Apply(int label, int dst, int len, uint64_t bits,
+                        bool clocked, int cycle) {
+  int base = label * plane_words_;
+  int word = dst >> 6, shift = dst & 63;
+  if (!clocked)
+    bits &= ~get_bits(&seen_[base], dst, len);
+  // the run covers bits of 'word' and, if it crosses a word boundary, of
+  // the next one
+  uint64_t parts[2] = {bits << shift, shift != 0 ? bits >> (64 - shift) : 0};
+  for (int i = 0; i < 2; i++) {
+    if (parts[i] == 0)
+      continue;
+    if (!clocked) {
+      Mark(label, word + i, parts[i], cycle);
+      continue;
     }
-    SetTaints(output, final_taints, taint_cycle);
+    int k = base + word + i;
+    if (next_[k] == 0)
+      next_words_.push_back(k);
+    next_[k] |= parts[i];
   }
 }
-int TaintWorker::Run(int cycles) {
-  auto cells = SortCell(module_);
-  int cycle = 0;
-  for (; cycle < cycles; ++cycle) {
-    if (!NeedNewCycle())
-      break;
-    NewCycle();
-    for (auto cell : cells) {
-      if (IsBitOp(cell)) {
-        TaintBitOp(cell, cycle);
-      } else {
-        TaintSigOp(cell, cycle);
+
+void TaintEngine::Propagate(const Kernel &kernel, int cycle) {
+  // Apply() only marks bits of the label it is given, so cur_labels_ does
+  // not change in this loop
+  for (int label : cur_labels_) {
+    const uint64_t *cur = &cur_[label * plane_words_];
+    for (auto &run : kernel.bitwise) {
+      uint64_t bits = get_bits(cur, run.src, run.len);
+      if (bits != 0)
+        Apply(label, run.dst, run.len, bits, kernel.clocked, cycle);
+    }
+
+    bool any = false;
+    for (auto &run : kernel.any_src)
+      if (get_bits(cur, run.src, run.len) != 0) {
+        any = true;
+        break;
       }
+    if (any)
+      for (auto &run : kernel.any_dst)
+        Apply(label, run.dst, run.len, low_mask(run.len), kernel.clocked,
+              cycle);
+  }
+}
+
+void TaintEngine::SetTaint(const RTLIL::SigSpec &sig, int label, int cycle) {
+  log_assert(0 <= label && label < num_labels_);
+  for (auto bit : sig) {
+    int id = BitId(bit);
+    if (id >= 0)
+      Apply(label, id, 1, 1, false, cycle);
+  }
+}
+
+int TaintEngine::Run(int cycles) {
+  int cycle = 0;
+  for (; cycle < cycles && !worklist_.empty(); ++cycle) {
+    // a kernel on a combinational loop can be scheduled again after it ran,
+    // since labels only ever get added this still reaches a fixpoint
+    while (!worklist_.empty()) {
+      int k = worklist_.top();
+      worklist_.pop();
+      queued_[k] = false;
+      Propagate(kernels_[k], cycle);
+    }
+    for (int k : cur_words_)
+      cur_[k] = 0;
+    cur_words_.clear();
+    for (int label : cur_labels_)
+      label_active_[label] = false;
+    cur_labels_.clear();
+
+    // labels produced by clocked cells become the new taint of next cycle
+    std::vector<int> next_words;
+    next_words.swap(next_words_);
+    for (int k : next_words) {
+      uint64_t new_bits = next_[k] & ~seen_[k];
+      next_[k] = 0;
+      if (new_bits != 0)
+        Mark(k / plane_words_, k % plane_words_, new_bits, cycle + 1);
     }
   }
-  log("taint size %d used cycles=%d", int(taint_.size()), cycle);
+  return cycle;
+}
+
+TaintWorker::TaintWorker(RTLIL::Module *module,
+                         const std::vector<IdString> &secret_vars)
+    : module_(module), sigmap(module), labels_(secret_vars),
+      engine_(module, sigmap, SortCell(module), GetSize(secret_vars)) {
+  for (int label = 0; label < GetSize(labels_); label++) {
+    Wire *wire = module_->wire(labels_[label]);
+    if (wire == nullptr)
+      continue;
+    engine_.SetTaint(wire, label, 0);
+    log_trace(taint, "set initial taint %s\n",
+              log_signal(RTLIL::SigSpec(wire)));
+  }
+}
+
+int TaintWorker::Run(int cycles) {
+  int cycle = engine_.Run(cycles);
+  log("taint size %d used cycles=%d\n", engine_.NumTainted(), cycle);
   return cycle;
 }
 void TaintWorker::SumarizeTaint(std::ostream *&f, int start_cycle,
@@ -247,6 +446,73 @@ void TaintWorker::SumarizeTaint(std::ostream *&f, int start_cycle,
       *f << GetTaint(bit, cycle) << " ";
     *f << "\n";
   }
+  // secrets reaching each wire, with the first cycle any bit of the wire
+  // was reached
+  for (auto wire : module_->selected_wires()) {
+    if (wire->name[0] == '$' || wire->port_input)
+      continue;
+    std::map<int, int> label_cycle;
+    for (auto bit : sigmap(wire))
+      for (auto &it : engine_.LabelCycles(bit))
+        if (label_cycle.count(it.first) == 0 ||
+            label_cycle.at(it.first) > it.second)
+          label_cycle[it.first] = it.second;
+    if (label_cycle.empty())
+      continue;
+    *f << "Labels: " << log_id(wire);
+    for (auto &it : label_cycle)
+      *f << " " << log_id(labels_[it.first]) << "@" << it.second;
+    *f << "\n";
+  }
+}
+void TaintWorker::WriteFirstCycles(std::ostream *&f) {
+  for (auto wire : module_->selected_wires()) {
+    if (wire->name[0] == '$' || wire->port_input)
+      continue;
+    SigSpec sig = sigmap(wire);
+    for (int i = 0; i < GetSize(sig); i++) {
+      int cycle = engine_.FirstCycle(sig[i]);
+      if (cycle >= 0)
+        *f << log_id(wire) << "[" << i << "] " << cycle << "\n";
+    }
+  }
+}
+void TaintWorker::WriteSummary(std::ostream &f, int num_cycles) {
+  TaintSummary summary;
+  summary.num_cycles = num_cycles;
+  for (auto label : labels_)
+    summary.labels.push_back(summary.AddString(log_id(label)));
+
+  // sorted by the exact names stored in the index, log_id() only strips the
+  // backslash of some names (not of e.g. \\$foo)
+  std::vector<std::pair<std::string, RTLIL::Wire *>> wires;
+  for (auto wire : module_->selected_wires())
+    if (wire->name[0] != '$' && !wire->port_input)
+      wires.push_back(std::make_pair(std::string(log_id(wire)), wire));
+  std::sort(wires.begin(), wires.end());
+
+  for (auto &it : wires) {
+    RTLIL::Wire *wire = it.second;
+    TaintSummary::WireEntry entry{summary.AddString(it.first),
+                                  uint32_t(wire->width),
+                                  uint32_t(summary.bits.size()), 0};
+    SigSpec sig = sigmap(wire);
+    for (int i = 0; i < GetSize(sig); i++) {
+      int cycle = engine_.FirstCycle(sig[i]);
+      if (cycle < 0)
+        continue;
+      const auto &label_cycles = engine_.LabelCycles(sig[i]);
+      summary.bits.push_back(TaintSummary::BitEntry{
+          uint32_t(i), cycle, uint32_t(summary.hits.size()),
+          uint32_t(label_cycles.size())});
+      for (auto &it : label_cycles)
+        summary.hits.push_back(
+            TaintSummary::HitEntry{uint32_t(it.first), it.second});
+      entry.num_bits++;
+    }
+    summary.wires.push_back(entry);
+  }
+  summary.Write(f);
 }
 TaintAnalyzer::TaintAnalyzer(RTLIL::Module *module)
     : module_(module), sigmap(module_) {}
@@ -319,9 +585,8 @@ RTLIL::SigSpec ComposeSigSpecByIndexes(const RTLIL::SigSpec &sig,
 RTLIL::Cell *
 TaintAnalyzer::SplitCellByOutput(IdString output_name, RTLIL::Cell *cell,
                                  const std::set<RTLIL::SigBit> &used_output) {
-  log("split------:%s\n", log_id(output_name));
+  log_trace(taint, "split------:%s\n", log_id(output_name));
   auto outputs = cell->getPort(output_name);
-  log("split2\n");
   vector<int> used_index, unused_index;
   std::string used_index_str = " ";
   std::string unused_index_str = " ";
@@ -341,18 +606,17 @@ TaintAnalyzer::SplitCellByOutput(IdString output_name, RTLIL::Cell *cell,
   RTLIL::Cell *newcell = module_->addCell(unused_cell_name, cell);
   auto conns = cell->connections();
   for (auto conn : conns) {
-    log("new signal %s", log_id(conn.first));
     if (conn.first.in("\\A", "\\B", "\\D", "\\Y", "\\C", "\\Q")) {
-      log("= %s\n",
-          log_signal(ComposeSigSpecByIndexes(conn.second, unused_index)));
       auto new_sig = ComposeSigSpecByIndexes(conn.second, unused_index);
+      log_trace(taint, "new signal %s = %s\n", log_id(conn.first),
+                log_signal(new_sig));
       newcell->setPort(conn.first, new_sig);
       auto update_sig = ComposeSigSpecByIndexes(conn.second, used_index);
       cell->setPort(conn.first, update_sig);
       if (conn.first.in("\\A", "\\B", "\\Y")) {
         std::string port_name = conn.first.str() + "_WIDTH";
-        log("param %s = %d %d\n", port_name.c_str(), new_sig.size(),
-            update_sig.size());
+        log_trace(taint, "param %s = %d %d\n", port_name.c_str(),
+                  new_sig.size(), update_sig.size());
         if (cell->hasParam(port_name)) {
           newcell->setParam(port_name, new_sig.size());
           cell->setParam(port_name, update_sig.size());
@@ -361,7 +625,7 @@ TaintAnalyzer::SplitCellByOutput(IdString output_name, RTLIL::Cell *cell,
     }
   }
   if (cell->hasParam("\\WIDTH")) {
-    log("width=%d", used_index.size());
+    log_trace(taint, "width=%d\n", GetSize(used_index));
     newcell->setParam("\\WIDTH", unused_index.size());
     cell->setParam("\\WIDTH", used_index.size());
   }
@@ -370,87 +634,28 @@ TaintAnalyzer::SplitCellByOutput(IdString output_name, RTLIL::Cell *cell,
 }
 std::set<RTLIL::Cell *> TaintAnalyzer::BackwardCells(
     const std::set<RTLIL::SigSpec> &observable_signals) {
-  std::map<RTLIL::SigBit, RTLIL::Cell *> port_cells;
+  CellGraph graph(module_, sigmap, false);
   std::set<RTLIL::Cell *> backward_cells;
-  std::queue<RTLIL::Cell *> cell_queue;
-  std::map<Cell *, std::pair<RTLIL::IdString, RTLIL::SigSpec>> cell_sig;
-  std::set<RTLIL::SigBit> used_bits;
-  std::cerr << "before process 2\n";
+  std::vector<bool> visited(graph.Size());
+  std::queue<int> cell_queue;
 
-  IdString output_name = "\\Y";
-  for (auto cell : module_->cells())
-    for (auto conn : cell->connections())
-      if (cell->output(conn.first)) {
-        for (auto bit : conn.second) {
-          sigmap.apply(bit);
-          assert(port_cells.count(bit) == 0);
-          port_cells[bit] = cell;
-          cell_sig[cell] = conn;
-        }
+  for (auto sig : observable_signals)
+    for (auto bit : sig) {
+      int i = graph.Driver(bit);
+      if (i >= 0 && !visited[i]) {
+        visited[i] = true;
+        cell_queue.push(i);
       }
-  for (auto sig : observable_signals) {
-    sigmap.apply(sig);
-    auto bitset = sig.to_sigbit_set();
-    used_bits.insert(sig.begin(), sig.end());
-    for (auto bit : sig)
-      if (port_cells.count(bit) > 0)
-        if (cell_sig.count(port_cells[bit]) > 0) {
-          RTLIL::Cell *cell = port_cells[bit];
-          cell_queue.push(cell);
-          for (auto b : cell_sig[cell].second) {
-            log("erase cell %s for %s\n", log_id(port_cells[b]), log_signal(b));
-            port_cells.erase(b);
-          }
-        }
-  }
+    }
   while (!cell_queue.empty()) {
-    auto cell = cell_queue.front();
-    // log("pop cell %lx\n", cell);
-    // log_cell(cell);
+    int i = cell_queue.front();
     cell_queue.pop();
-    //  log("old cell:");
-    //  log_cell(cell);
-    RTLIL::Cell *newcell = nullptr;
-    auto output_name = cell_sig[cell].first;
-    cell_sig.erase(cell);
-  /*  if (IsClockCell(cell)) {
-      newcell = SplitCellByOutput(output_name, cell, used_bits);
-    } else if (IsBitOp(cell)) {
-      newcell = SplitCellByOutput(output_name, cell, used_bits);
-    } else {
-      // log("sig cell\n");
-      // log_cell(cell);
-    }*/
-    if (newcell != nullptr) {
-      cell_sig[newcell] =
-          std::make_pair(output_name, sigmap(newcell->getPort(output_name)));
-      log("new cell:");
-      log_cell(newcell);
-      log("old cell is changed to\n");
-      log_cell(cell);
-    } else {
-      log("empty new cell\n");
-    }
-    for (auto conn : cell->connections()) {
-      used_bits.insert(conn.second.begin(), conn.second.end());
-    }
-    //  log("add cell");
-    //  log_cell(cell);
-    backward_cells.insert(cell);
-
-    std::set<RTLIL::Cell *> cells_to_add;
-    for (auto conn : cell->connections()) {
-      if (cell->input(conn.first))
-        for (auto bit : conn.second)
-          if (port_cells.count(bit) > 0)
-            if (cell_sig.count(port_cells[bit]) > 0) {
-              auto c = port_cells[bit];
-              cell_queue.push(c);
-            //  backward_cells.insert(c);
-              for (auto b : cell_sig[c].second)
-                port_cells.erase(b);
-            }
-    }
+    backward_cells.insert(graph.GetCell(i));
+    for (int j : graph.Fanin(i))
+      if (!visited[j]) {
+        visited[j] = true;
+        cell_queue.push(j);
+      }
   }
   return backward_cells;
 }
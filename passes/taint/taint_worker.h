@@ -3,12 +3,38 @@
 #include "kernel/celltypes.h"
 #include "kernel/rtlil.h"
 #include "kernel/sigtools.h"
+#include <functional>
 #include <queue>
 #include <string>
 namespace Yosys {
 namespace backend {
 namespace taint {
 class TaintWorker;
+// Cell dependency graph of a module with dense cell indexes. Fanout(i) lists
+// the cells reading an output of GetCell(i), Fanin(i) the cells driving one
+// of its inputs. With cut_at_clock_cells, clocked cells drive no edges, so
+// the graph only holds the combinational dependencies.
+class CellGraph {
+public:
+  CellGraph(RTLIL::Module *module, const SigMap &sigmap,
+            bool cut_at_clock_cells);
+  int Size() const { return GetSize(cells_); }
+  RTLIL::Cell *GetCell(int i) const { return cells_[i]; }
+  // Index of the cell driving a bit, -1 for undriven bits.
+  int Driver(const RTLIL::SigBit &bit) const;
+  const std::vector<int> &Fanin(int i) const { return fanin_[i]; }
+  const std::vector<int> &Fanout(int i) const { return fanout_[i]; }
+  // Kahn's algorithm in O(cells + edges). Cells that can't be ordered
+  // because of combinational loops are reported and appended in module
+  // order.
+  std::vector<RTLIL::Cell *> TopologicalSort() const;
+
+private:
+  const SigMap &sigmap_;
+  std::vector<RTLIL::Cell *> cells_;
+  dict<RTLIL::SigBit, int> driver_;
+  std::vector<std::vector<int>> fanin_, fanout_;
+};
 class TaintAnalyzer {
 public:
   TaintAnalyzer(TaintWorker *taint_worker);
@@ -30,33 +56,100 @@ private:
   RTLIL::Module *module_;
   SigMap sigmap;
 };
+// Compiled taint propagation. Every canonical SigBit of the module gets a
+// dense id and every taint source (label) has its own packed set of bit
+// ids. Each cell is compiled once into runs of at most 64 consecutive bit
+// ids, propagation ORs a whole word of bits per run and active label. A
+// label reaches a bit once, at the first cycle one of the bit's sources
+// carries it as new taint; combinational cells propagate within a cycle,
+// clocked cells into the next one. Only kernels reading a bit that received
+// new labels are scheduled, in topological order, so a cycle costs the size
+// of the tainted fanout rather than the size of the module.
+class TaintEngine {
+public:
+  TaintEngine(RTLIL::Module *module, const SigMap &sigmap,
+              const std::vector<RTLIL::Cell *> &sorted_cells, int num_labels);
+  // Dense id of a bit, -1 for constants.
+  int BitId(const RTLIL::SigBit &bit) const;
+  void SetTaint(const RTLIL::SigSpec &sig, int label, int cycle = 0);
+  // Propagate for at most 'cycles' cycles, stops early when no kernel is
+  // left to schedule. Returns the number of simulated cycles.
+  int Run(int cycles);
+  // First cycle any label reached the bit, -1 if none did.
+  int FirstCycle(const RTLIL::SigBit &bit) const;
+  // (label, first cycle) of every label that reached the bit.
+  const std::vector<std::pair<int, int>> &
+  LabelCycles(const RTLIL::SigBit &bit) const;
+  int NumLabels() const { return num_labels_; }
+  int NumTainted() const { return num_tainted_; }
+
+private:
+  struct BitRun {
+    // bit ids dst..dst+len-1 and src..src+len-1, for reductions only the
+    // side the run is used for is meaningful
+    int dst, src, len;
+  };
+  struct Kernel {
+    bool clocked;
+    // dst[i] gets the labels of src[i]
+    std::vector<BitRun> bitwise;
+    // all any_dst bits get the union of the labels of the any_src bits
+    std::vector<BitRun> any_src, any_dst;
+  };
+  static std::vector<BitRun>
+  MakeRuns(const std::vector<std::pair<int, int>> &bits);
+  void Compile(RTLIL::Cell *cell);
+  void Propagate(const Kernel &kernel, int cycle);
+  void Apply(int label, int dst, int len, uint64_t bits, bool clocked,
+             int cycle);
+  void Mark(int label, int word, uint64_t bits, int cycle);
+  void Schedule(int kernel);
+
+  const SigMap &sigmap_;
+  dict<RTLIL::SigBit, int> bit_ids_;
+  std::vector<Kernel> kernels_;
+  // kernels reading each bit id
+  std::vector<std::vector<int>> readers_;
+  // kernels to run in the current cycle, smallest (topological) index first
+  std::priority_queue<int, std::vector<int>, std::greater<int>> worklist_;
+  std::vector<bool> queued_;
+  int num_labels_, plane_words_;
+  // bit sets stored label by label, plane_words_ per label. seen_: reached
+  // in any cycle, cur_: new in the current cycle, next_: produced by clocked
+  // cells for the next cycle
+  std::vector<uint64_t> seen_, cur_, next_;
+  // non-zero words of cur_ and next_
+  std::vector<int> cur_words_, next_words_;
+  // labels with bits in cur_
+  std::vector<int> cur_labels_;
+  std::vector<bool> label_active_;
+  std::vector<int> first_cycle_;
+  std::vector<std::vector<std::pair<int, int>>> label_cycles_;
+  int num_tainted_;
+};
 class TaintWorker {
 public:
-  TaintWorker(RTLIL::Module *module, const pool<IdString> &secret_vars);
-  void ListTaint(std::ostream *&f, int start_cycle = 0, int end_cycle = 3);
+  // every secret variable is tracked as its own label
+  TaintWorker(RTLIL::Module *module, const std::vector<IdString> &secret_vars);
   int Run(int cycles);
-  void NewCycle() { increased_taint_ = false; };
-  bool NeedNewCycle() { return increased_taint_; };
   void SumarizeTaint(std::ostream *&f, int start_cycle, int end_cycle);
+  // one line per tainted bit with the first cycle it was tainted at
+  void WriteFirstCycles(std::ostream *&f);
+  // binary summary with a per-wire index, see taint_summary.h
+  void WriteSummary(std::ostream &f, int num_cycles);
   std::set<RTLIL::Wire *> GetTaintedWires() { return tainted_wires_; }
   friend TaintAnalyzer;
 
 private:
   vector<Cell *> SortCell(RTLIL::Module *module);
-  void InitTaint(const pool<IdString> &taint_vars);
-  void SetTaint(const SigSpec &sig, int val, int cycle = 0);
-  void SetTaints(const SigSpec &sig, vector<int> vals, int cycle = 0);
-  bool IsTainted(const SigBit &bit) { return taint_.count(bit) > 0; }
-  int GetTaint(const SigBit &c_bit, int cycle = 0);
-  vector<int> GetTaints(const SigSpec &sig, int cycle = 0);
-  void TaintBitOp(Cell *cell, int cycle);
-  void TaintSigOp(Cell *cell, int cycle);
-  std::vector<RTLIL::Cell *> BackwardCell();
-  dict<SigBit, std::map<int, int>> taint_;
-  dict<SigBit, std::map<int, int>> control_;
-  SigMap sigmap;
+  bool IsTainted(const SigBit &bit) { return engine_.FirstCycle(bit) >= 0; }
+  int GetTaint(const SigBit &bit, int cycle = 0) {
+    return engine_.FirstCycle(bit) == cycle ? 1 : 0;
+  }
   RTLIL::Module *module_;
-  bool increased_taint_;
+  SigMap sigmap;
+  std::vector<IdString> labels_;
+  TaintEngine engine_;
   std::set<RTLIL::Wire *> tainted_wires_;
   std::set<RTLIL::SigBit> tainted_bits_;
   std::set<RTLIL::Wire *> untainted_wires_;
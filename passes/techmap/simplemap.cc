@@ -573,8 +573,10 @@ void simplemap(RTLIL::Module *module, RTLIL::Cell *cell)
 YOSYS_NAMESPACE_END
 PRIVATE_NAMESPACE_BEGIN
 
-struct SimplemapPass : public Pass {
-	SimplemapPass() : Pass("simplemap", "mapping simple coarse-grain cells") { }
+struct SimplemapPass : public ModulePass {
+	std::map<RTLIL::IdString, void(*)(RTLIL::Module*, RTLIL::Cell*)> mappers;
+
+	SimplemapPass() : ModulePass("simplemap", "mapping simple coarse-grain cells") { }
 	void help() YS_OVERRIDE
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -590,27 +592,27 @@ struct SimplemapPass : public Pass {
 		log("  $sr, $ff, $dff, $dffsr, $adff, $dlatch\n");
 		log("\n");
 	}
-	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
+	std::vector<RTLIL::Module*> setup(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
 	{
 		log_header(design, "Executing SIMPLEMAP pass (map simple cells to gate primitives).\n");
 		extra_args(args, 1, design);
 
-		std::map<RTLIL::IdString, void(*)(RTLIL::Module*, RTLIL::Cell*)> mappers;
+		mappers.clear();
 		simplemap_get_mappers(mappers);
 
-		for (auto mod : design->modules()) {
-			if (!design->selected(mod) || mod->get_blackbox_attribute())
+		return design->selected_modules();
+	}
+	void execute_module(RTLIL::Module *mod) YS_OVERRIDE
+	{
+		std::vector<RTLIL::Cell*> cells = mod->cells();
+		for (auto cell : cells) {
+			if (mappers.count(cell->type) == 0)
 				continue;
-			std::vector<RTLIL::Cell*> cells = mod->cells();
-			for (auto cell : cells) {
-				if (mappers.count(cell->type) == 0)
-					continue;
-				if (!design->selected(mod, cell))
-					continue;
-				log("Mapping %s.%s (%s).\n", log_id(mod), log_id(cell), log_id(cell->type));
-				mappers.at(cell->type)(mod, cell);
-				mod->remove(cell);
-			}
+			if (!mod->design->selected(mod, cell))
+				continue;
+			log("Mapping %s.%s (%s).\n", log_id(mod), log_id(cell), log_id(cell->type));
+			mappers.at(cell->type)(mod, cell);
+			mod->remove(cell);
 		}
 	}
 } SimplemapPass;
@@ -0,0 +1,260 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Clifford Wolf <clifford@clifford.at>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+static uint32_t xorshift32_state = 123456789;
+
+static uint32_t xorshift32(uint32_t limit) {
+	xorshift32_state ^= xorshift32_state << 13;
+	xorshift32_state ^= xorshift32_state >> 17;
+	xorshift32_state ^= xorshift32_state << 5;
+	return xorshift32_state % limit;
+}
+
+struct HashlibWorkload
+{
+	// bits driven by wires (the keys) and bits used by cell ports (the queries)
+	std::vector<SigBit> keys, queries;
+};
+
+static void collect_workload(HashlibWorkload &wl, Module *module)
+{
+	for (auto wire : module->wires())
+		for (int i = 0; i < wire->width; i++)
+			wl.keys.push_back(SigBit(wire, i));
+
+	for (auto cell : module->cells())
+		for (auto &conn : cell->connections())
+			for (auto bit : conn.second)
+				wl.queries.push_back(bit);
+}
+
+static void synthetic_workload(HashlibWorkload &wl, Design *design, int num_bits)
+{
+	Module *module = design->addModule("\\test_hashlib");
+	std::vector<Wire*> wires;
+
+	for (int bits = 0; bits < num_bits;) {
+		int width = xorshift32(4) == 0 ? 1 + xorshift32(64) : 1;
+		wires.push_back(module->addWire(NEW_ID, width));
+		bits += width;
+	}
+
+	for (int i = 0; i < num_bits; i++) {
+		Wire *a = wires[xorshift32(GetSize(wires))];
+		Wire *y = wires[xorshift32(GetSize(wires))];
+		module->addAnd(NEW_ID, SigBit(a, xorshift32(a->width)), xorshift32(8) ? State::S1 : State::S0,
+				SigBit(y, xorshift32(y->width)));
+	}
+
+	collect_workload(wl, module);
+}
+
+struct HashlibResult
+{
+	float seconds;
+	unsigned int checksum;
+
+	HashlibResult(float seconds = 0, unsigned int checksum = 0) : seconds(seconds), checksum(checksum) { }
+};
+
+template<typename Dict>
+static void bench_dict(const HashlibWorkload &wl, int rounds, dict<string, HashlibResult> &results, const string &prefix)
+{
+	PerformanceTimer t_insert, t_lookup, t_iterate, t_erase;
+	unsigned int c_insert = 0, c_lookup = 0, c_iterate = 0, c_erase = 0;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		Dict db;
+
+		t_insert.begin();
+		for (int i = 0; i < GetSize(wl.keys); i++)
+			db[wl.keys[i]] = i;
+		t_insert.end();
+		c_insert += db.size();
+
+		t_lookup.begin();
+		for (auto &bit : wl.queries) {
+			auto it = db.find(bit);
+			if (it != db.end())
+				c_lookup += it->second;
+		}
+		t_lookup.end();
+
+		t_iterate.begin();
+		for (auto &it : db)
+			c_iterate = mkhash(c_iterate, it.second);
+		t_iterate.end();
+
+		t_erase.begin();
+		for (int i = 0; i < GetSize(wl.keys); i += 2)
+			db.erase(wl.keys[i]);
+		for (int i = 0; i < GetSize(wl.keys); i += 4)
+			db[wl.keys[i]] = i;
+		for (auto &bit : wl.queries)
+			c_erase += db.count(bit);
+		t_erase.end();
+	}
+
+	results[prefix + "insert"] = HashlibResult(t_insert.sec(), c_insert);
+	results[prefix + "lookup"] = HashlibResult(t_lookup.sec(), c_lookup);
+	results[prefix + "iterate"] = HashlibResult(t_iterate.sec(), c_iterate);
+	results[prefix + "erase"] = HashlibResult(t_erase.sec(), c_erase);
+}
+
+template<typename Pool>
+static void bench_pool(const HashlibWorkload &wl, int rounds, dict<string, HashlibResult> &results, const string &prefix)
+{
+	PerformanceTimer t_insert, t_lookup, t_erase;
+	unsigned int c_insert = 0, c_lookup = 0, c_erase = 0;
+
+	for (int r = 0; r < rounds; r++)
+	{
+		Pool db;
+
+		// the queries contain many duplicates, like a pool of visited bits
+		t_insert.begin();
+		for (auto &bit : wl.queries)
+			db.insert(bit);
+		t_insert.end();
+		c_insert += db.size();
+
+		t_lookup.begin();
+		for (auto &bit : wl.keys)
+			c_lookup += db.count(bit);
+		t_lookup.end();
+
+		t_erase.begin();
+		while (!db.empty())
+			c_erase = mkhash(c_erase, db.pop().hash());
+		t_erase.end();
+	}
+
+	results[prefix + "insert"] = HashlibResult(t_insert.sec(), c_insert);
+	results[prefix + "lookup"] = HashlibResult(t_lookup.sec(), c_lookup);
+	results[prefix + "erase"] = HashlibResult(t_erase.sec(), c_erase);
+}
+
+struct TestHashlibPass : public Pass {
+	TestHashlibPass() : Pass("test_hashlib", "compare performance of dict/pool and flat_dict/flat_pool") { }
+	void help() YS_OVERRIDE
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    test_hashlib [options] [selection]\n");
+		log("\n");
+		log("Run a microbenchmark on SigBit keys that compares dict<> with flat_dict<> and\n");
+		log("pool<> with flat_pool<>. The keys are the bits of all selected wires and the\n");
+		log("queries are the bits connected to the selected cells. When nothing is selected\n");
+		log("a random netlist is generated instead.\n");
+		log("\n");
+		log("    -n {integer}\n");
+		log("        repeat each workload this number of times (default = 10).\n");
+		log("\n");
+		log("    -size {integer}\n");
+		log("        number of wire bits in the random netlist (default = 100000).\n");
+		log("\n");
+		log("    -s {positive_integer}\n");
+		log("        use this value as rng seed value (default = 123456789).\n");
+		log("\n");
+	}
+	void execute(std::vector<std::string> args, RTLIL::Design *design) YS_OVERRIDE
+	{
+		int rounds = 10;
+		int num_bits = 100000;
+		xorshift32_state = 123456789;
+
+		log_header(design, "Executing TEST_HASHLIB pass.\n");
+
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-n" && argidx+1 < args.size()) {
+				rounds = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-size" && argidx+1 < args.size()) {
+				num_bits = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-s" && argidx+1 < args.size()) {
+				xorshift32_state = atoi(args[++argidx].c_str());
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		if (rounds < 1 || num_bits < 1 || xorshift32_state == 0)
+			log_cmd_error("Invalid argument value.\n");
+
+		HashlibWorkload wl;
+		Design *random_design = nullptr;
+
+		for (auto module : design->selected_modules())
+			collect_workload(wl, module);
+
+		if (wl.keys.empty()) {
+			log("No selected wires, using a random netlist with %d bits.\n", num_bits);
+			random_design = new Design;
+			synthetic_workload(wl, random_design, num_bits);
+		}
+
+		log("Using %d keys and %d queries, %d rounds.\n", GetSize(wl.keys), GetSize(wl.queries), rounds);
+
+		dict<string, HashlibResult> results;
+		bench_dict<dict<SigBit, int>>(wl, rounds, results, "dict:");
+		bench_dict<flat_dict<SigBit, int>>(wl, rounds, results, "flat_dict:");
+		bench_pool<pool<SigBit>>(wl, rounds, results, "pool:");
+		bench_pool<flat_pool<SigBit>>(wl, rounds, results, "flat_pool:");
+
+		log("\n");
+		log("  %-10s %-8s %10s %10s %8s\n", "container", "workload", "hashlib", "flat", "speedup");
+
+		bool found_error = false;
+		for (auto &it : results)
+		{
+			if (it.first.compare(0, 5, "flat_") == 0)
+				continue;
+
+			const HashlibResult &ref = it.second;
+			const HashlibResult &flat = results.at("flat_" + it.first);
+			size_t pos = it.first.find(':');
+
+			log("  %-10s %-8s %9.3fs %9.3fs %7.2fx%s\n", it.first.substr(0, pos).c_str(), it.first.substr(pos+1).c_str(),
+					ref.seconds, flat.seconds, flat.seconds > 0 ? ref.seconds / flat.seconds : 0.0f,
+					ref.checksum == flat.checksum ? "" : "  CHECKSUM MISMATCH");
+
+			if (ref.checksum != flat.checksum)
+				found_error = true;
+		}
+
+		delete random_design;
+
+		if (found_error)
+			log_error("Found mismatch between hashlib and flat containers.\n");
+	}
+} TestHashlibPass;
+
+PRIVATE_NAMESPACE_END
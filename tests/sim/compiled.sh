@@ -0,0 +1,14 @@
+#!/bin/bash
+# Simulate a design of coarse-grain cells with the interpreted and the
+# compiled engine, the VCD output must be identical.
+set -ex
+
+prep='read_verilog lfsr_acc.v; proc; opt_clean; select -assert-any t:$dff'
+simopts="-clock clk -reset rst -rstlen 2 -n 40"
+
+../../yosys -q -p "$prep; sim $simopts -vcd compiled_interp.vcd"
+../../yosys -ql compiled.log -p "$prep; sim $simopts -compiled -vcd compiled_compiled.vcd"
+grep -q "Compiled module top into" compiled.log
+cmp compiled_interp.vcd compiled_compiled.vcd
+
+rm -f compiled_interp.vcd compiled_compiled.vcd compiled.log
@@ -0,0 +1,22 @@
+#!/bin/bash
+# Simulate a netlist of $_DFF_P_ and $_DFF_N_ gates with the interpreted, the
+# compiled and the 64-lane parallel engine and compare the results.
+set -ex
+source vcd_toggles.inc
+
+prep='read_verilog dff_gates.v; proc; techmap; opt_clean; select -assert-any t:$_DFF_P_; select -assert-any t:$_DFF_N_'
+simopts="-clock clk -reset rst -zinit -n 20"
+
+../../yosys -q -p "$prep; sim $simopts -vcd dff_gates_interp.vcd"
+../../yosys -q -p "$prep; sim $simopts -compiled -vcd dff_gates_compiled.vcd"
+cmp dff_gates_interp.vcd dff_gates_compiled.vcd
+
+# all lanes see the same stimulus, so every lane must match the interpreted run
+../../yosys -ql dff_gates_parallel.log -p "$prep; sim $simopts -parallel"
+for port in cnt shadow; do
+	toggles=$(vcd_toggles dff_gates_interp.vcd $port)
+	test $toggles -gt 0
+	grep -E "^ +$port +$((toggles * 64)) +- *$" dff_gates_parallel.log
+done
+
+rm -f dff_gates_interp.vcd dff_gates_compiled.vcd dff_gates_parallel.log
@@ -0,0 +1,10 @@
+module top(input clk, rst, output reg [3:0] cnt, output reg [3:0] shadow);
+	always @(posedge clk)
+		if (rst)
+			cnt <= 0;
+		else
+			cnt <= cnt + 1;
+
+	always @(negedge clk)
+		shadow <= cnt ^ {2{cnt[1:0]}};
+endmodule
@@ -0,0 +1,15 @@
+module top(input clk, rst, output reg [7:0] lfsr, acc, output [7:0] y, output reg hit);
+	always @(posedge clk)
+		if (rst) begin
+			lfsr <= 8'h5a;
+			acc <= 0;
+		end else begin
+			lfsr <= {lfsr[6:0], lfsr[7] ^ lfsr[5] ^ lfsr[4] ^ lfsr[3]};
+			acc <= lfsr[0] ? acc + lfsr : acc - 1;
+		end
+
+	assign y = (acc << lfsr[1:0]) ^ {lfsr[3:0], lfsr[7:4]};
+
+	always @(negedge clk)
+		hit <= acc > lfsr;
+endmodule
@@ -0,0 +1,28 @@
+#!/bin/bash
+# sim -parallel with different inputs per lane, from a stimulus file and
+# from the random generator
+set -ex
+
+prep='read_verilog parallel_lanes.v; proc; techmap; opt_clean; select -assert-any t:$_DFF_P_'
+simopts="-clock clk -n 10"
+
+# lane 7 drives 1010 from cycle 2 to 4, lane 63 drives 0001 from cycle 4, so q
+# diverges after the first rising edge with a different d and toggles 2+1+2
+# times over all lanes
+../../yosys -ql parallel_lanes_stim.log -p "$prep; sim $simopts -parallel -stimulus parallel_lanes.stim"
+grep -E '^ +d +5 +3 *$' parallel_lanes_stim.log
+grep -E '^ +q +5 +3 *$' parallel_lanes_stim.log
+
+# the random inputs only depend on the seed
+../../yosys -ql parallel_lanes_seed1.log -p "$prep; sim $simopts -parallel -seed 1"
+../../yosys -ql parallel_lanes_seed1b.log -p "$prep; sim $simopts -parallel -seed 1"
+../../yosys -ql parallel_lanes_seed2.log -p "$prep; sim $simopts -parallel -seed 2"
+for s in seed1 seed1b seed2; do
+	grep -E '^ +[a-z]+ +[0-9]+ +[-0-9]+ *$' parallel_lanes_$s.log > parallel_lanes_$s.tab
+done
+cmp parallel_lanes_seed1.tab parallel_lanes_seed1b.tab
+if cmp -s parallel_lanes_seed1.tab parallel_lanes_seed2.tab; then exit 1; fi
+# with 64 random lanes q differs between lanes right after the first edge
+grep -E '^ +q +[1-9][0-9]* +1 *$' parallel_lanes_seed1.tab
+
+rm -f parallel_lanes_stim.log parallel_lanes_seed{1,1b,2}.{log,tab}
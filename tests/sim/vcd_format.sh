@@ -0,0 +1,27 @@
+#!/bin/bash
+# The default VCD output keeps the "n<id>" identifiers and full-width 'b'
+# values, -vcdcompact writes the same waveforms in the short form.
+set -ex
+source vcd_toggles.inc
+
+prep='read_verilog lfsr_acc.v; proc; opt_clean'
+simopts="-clock clk -reset rst -rstlen 2 -n 40"
+
+../../yosys -q -p "$prep; sim $simopts -vcd vcd_format_default.vcd"
+../../yosys -q -p "$prep; sim $simopts -vcdcompact -vcd vcd_format_compact.vcd"
+
+grep -qE '^\$var wire 8 n[0-9]+ lfsr \$end$' vcd_format_default.vcd
+grep -qE '^\$var wire 1 n[0-9]+ hit \$end$' vcd_format_default.vcd
+test $(grep -cvE '^(\$|#|b[01xz]+ n[0-9]+$)' vcd_format_default.vcd) -eq 0
+# hit is undefined until the first falling clock edge
+grep -qE '^bx n[0-9]+$' vcd_format_default.vcd
+
+test $(grep -cE ' n[0-9]+$' vcd_format_compact.vcd) -eq 0
+grep -qE '^x[!-~]+$' vcd_format_compact.vcd
+for wire in lfsr acc y hit; do
+	toggles=$(vcd_toggles vcd_format_default.vcd $wire)
+	test $toggles -gt 0
+	test $toggles -eq $(vcd_toggles vcd_format_compact.vcd $wire)
+done
+
+rm -f vcd_format_default.vcd vcd_format_compact.vcd
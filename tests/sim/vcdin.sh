@@ -0,0 +1,17 @@
+#!/bin/bash
+# Replay the inputs of a VCD file written by sim with -vcdin, plain and
+# gzip-compressed, the replayed trace must be identical to the original.
+set -ex
+
+prep='read_verilog lfsr_acc.v; proc; opt_clean'
+
+../../yosys -q -p "$prep; sim -clock clk -reset rst -rstlen 2 -n 40 -vcd vcdin_ref.vcd"
+grep -q '^\$var wire 1 .* clk \$end$' vcdin_ref.vcd
+
+../../yosys -q -p "$prep; sim -vcdin vcdin_ref.vcd -n 40 -vcd vcdin_replay.vcd.gz"
+gzip -dc vcdin_replay.vcd.gz | cmp - vcdin_ref.vcd
+
+../../yosys -q -p "$prep; sim -vcdin vcdin_replay.vcd.gz -n 40 -compiled -vcd vcdin_replay.vcd"
+cmp vcdin_replay.vcd vcdin_ref.vcd
+
+rm -f vcdin_ref.vcd vcdin_replay.vcd vcdin_replay.vcd.gz
@@ -0,0 +1,67 @@
+#!/usr/bin/env bash
+#
+# Measure emission time and output size of every write_smt2 encoding.
+#
+# usage: smt2_bench.sh [-y <yosys>] [-r <repeat>] [design.v|design.il ...]
+#
+# Designs default to tests/simple/*.v and tests/sat/*.v. Each design is
+# prepared once and saved as RTLIL. Then it is written with each encoding.
+# The emission time is the best run time of reading and writing minus the
+# best run time of only reading the prepared design. One line per design
+# and encoding is printed:
+#
+#   <design> <encoding> <seconds> <bytes>
+#
+
+set -e
+
+toolsdir="$(cd $(dirname $0); pwd)"
+yosys="$toolsdir/../../yosys"
+repeat=3
+
+while getopts "y:r:" opt; do
+	case "$opt" in
+		y) yosys="$OPTARG" ;;
+		r) repeat="$OPTARG" ;;
+		*) echo "usage: $0 [-y <yosys>] [-r <repeat>] [design ...]" >&2; exit 1 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ]; then
+	set -- $toolsdir/../simple/*.v $toolsdir/../sat/*.v
+fi
+
+encodings="plain simplified next trans"
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+# best wall time of 'repeat' runs of the given yosys script
+best_time() {
+	local best="" t0 t1
+	for ((i = 0; i < repeat; i++)); do
+		t0=$(date +%s.%N)
+		"$yosys" -q -p "$1" > /dev/null 2>&1 || return 1
+		t1=$(date +%s.%N)
+		best=$(awk "BEGIN { t = $t1 - $t0; print (\"$best\" == \"\" || t < 0$best) ? t : 0$best }")
+	done
+	echo $best
+}
+
+printf "%-32s %-10s %10s %12s\n" design encoding seconds bytes
+for design in "$@"; do
+	name=$(basename ${design%.*})
+	il=$workdir/$name.il
+	case "$design" in
+		*.il) cp "$design" $il ;;
+		*) "$yosys" -q -p "read_verilog $design; prep -auto-top -nordff; write_ilang $il" \
+				> /dev/null 2>&1 || continue ;;
+	esac
+
+	base=$(best_time "read_ilang $il") || continue
+	for enc in $encodings; do
+		out=$workdir/$name.$enc.smt2
+		t=$(best_time "read_ilang $il; write_smt2 -encoding $enc $out") || continue
+		printf "%-32s %-10s %10.4f %12d\n" $name $enc $(awk "BEGIN { print $t - $base }") $(wc -c < $out)
+	done
+done
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+static uint32_t hashlib_test_rng(uint32_t &state, uint32_t limit)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state % limit;
+}
+
+template<typename A, typename B>
+static void expect_same_entries(const A &a, const B &b)
+{
+	ASSERT_EQ(a.size(), b.size());
+	auto ait = a.begin();
+	auto bit = b.begin();
+	for (; ait != a.end(); ++ait, ++bit) {
+		ASSERT_TRUE(bit != b.end());
+		EXPECT_EQ(*ait, *bit);
+	}
+	EXPECT_TRUE(bit == b.end());
+}
+
+TEST(KernelHashlibTest, flatDictMatchesDict)
+{
+	uint32_t state = 123456789;
+	dict<int, int> ref;
+	flat_dict<int, int> db;
+
+	for (int i = 0; i < 100000; i++) {
+		int key = hashlib_test_rng(state, 5000);
+		switch (hashlib_test_rng(state, 4)) {
+		case 0:
+			EXPECT_EQ(ref.erase(key), db.erase(key));
+			break;
+		case 1:
+			EXPECT_EQ(ref.count(key), db.count(key));
+			break;
+		default:
+			ref[key] = i;
+			db[key] = i;
+			break;
+		}
+	}
+
+	expect_same_entries(ref, db);
+
+	for (int key = 0; key < 5000; key++)
+		EXPECT_EQ(ref.at(key, -1), db.at(key, -1));
+}
+
+TEST(KernelHashlibTest, flatDictEraseIterator)
+{
+	flat_dict<std::string, int> db;
+	for (int i = 0; i < 1000; i++)
+		db[stringf("k%d", i)] = i;
+
+	for (auto it = db.begin(); it != db.end();)
+		if (it->second % 3 == 0)
+			it = db.erase(it);
+		else
+			++it;
+
+	EXPECT_EQ(db.size(), 666u);
+	for (int i = 0; i < 1000; i++)
+		EXPECT_EQ(db.count(stringf("k%d", i)), i % 3 == 0 ? 0 : 1);
+}
+
+TEST(KernelHashlibTest, flatDictCopySortSwap)
+{
+	flat_dict<int, int> a = {{3, 30}, {1, 10}, {2, 20}};
+	flat_dict<int, int> b = a;
+
+	EXPECT_TRUE(a == b);
+	b.sort();
+	EXPECT_TRUE(a == b);
+	EXPECT_EQ(b.begin()->first, 1);
+	EXPECT_EQ(b.at(2), 20);
+
+	b[4] = 40;
+	EXPECT_TRUE(a != b);
+
+	a.swap(b);
+	EXPECT_EQ(a.size(), 4u);
+	EXPECT_EQ(b.size(), 3u);
+	EXPECT_THROW(b.at(4), std::out_of_range);
+}
+
+TEST(KernelHashlibTest, flatPoolMatchesPool)
+{
+	uint32_t state = 987654321;
+	pool<int> ref;
+	flat_pool<int> db;
+
+	for (int i = 0; i < 100000; i++) {
+		int key = hashlib_test_rng(state, 2000);
+		if (hashlib_test_rng(state, 3) == 0)
+			EXPECT_EQ(ref.erase(key), db.erase(key));
+		else
+			EXPECT_EQ(ref.insert(key).second, db.insert(key).second);
+	}
+
+	expect_same_entries(ref, db);
+
+	while (!ref.empty())
+		EXPECT_EQ(ref.pop(), db.pop());
+	EXPECT_TRUE(db.empty());
+}
+
+YOSYS_NAMESPACE_END
@@ -3,6 +3,8 @@
 #include "kernel/yosys.h"
 #include "kernel/rtlil.h"
 
+#include <thread>
+
 YOSYS_NAMESPACE_BEGIN
 
 TEST(KernelRtlilTest, getReferenceValid)
@@ -11,4 +13,55 @@ TEST(KernelRtlilTest, getReferenceValid)
 	EXPECT_EQ(33, 33);
 }
 
+TEST(KernelRtlilTest, idStringConcurrentStress)
+{
+	const int num_threads = 8, num_iter = 20000, num_shared = 97;
+	std::vector<std::vector<int>> shared_idx(num_threads, std::vector<int>(num_shared, -1));
+	std::vector<int> errors(num_threads);
+
+	auto worker = [&](int t) {
+		for (int i = 0; i < num_iter; i++) {
+			// names shared by all threads
+			std::string shared_name = stringf("\\shared_%d", i % num_shared);
+			RTLIL::IdString a(shared_name);
+			RTLIL::IdString b = a;
+			if (a.str() != shared_name || b != a)
+				errors[t]++;
+			if (i >= num_iter - num_shared)
+				shared_idx[t][i % num_shared] = a.index_;
+
+			// names private to one thread, created and freed every time
+			std::string own_name = stringf("$own_%d_%d", t, i % 13);
+			RTLIL::IdString c(own_name);
+			if (c.str() != own_name || c == a)
+				errors[t]++;
+		}
+	};
+
+	// the shared names stay alive, so their indices must not change
+	std::vector<RTLIL::IdString> keep;
+	for (int k = 0; k < num_shared; k++)
+		keep.push_back(stringf("\\shared_%d", k));
+	{
+		RTLIL::IdString::threads_guard_t guard;
+		std::vector<std::thread> threads;
+		for (int t = 0; t < num_threads; t++)
+			threads.emplace_back(worker, t);
+		for (auto &it : threads)
+			it.join();
+	}
+
+	for (int t = 0; t < num_threads; t++) {
+		EXPECT_EQ(0, errors[t]);
+		for (int k = 0; k < num_shared; k++)
+			EXPECT_EQ(keep[k].index_, shared_idx[t][k]);
+	}
+	// the private names are freed again with their last reference
+	for (int t = 0; t < num_threads; t++)
+		for (int k = 0; k < 13; k++) {
+			std::string name = stringf("$own_%d_%d", t, k);
+			EXPECT_EQ(0, RTLIL::IdString::index_shard(name.c_str()).index.count((char*)name.c_str()));
+		}
+}
+
 YOSYS_NAMESPACE_END
@@ -0,0 +1,25 @@
+#!/bin/bash
+# write_smt2 -coi and write_btor -coi with only one of two independent
+# asserts selected must drop the cone of the other one
+set -ex
+
+prep='read_verilog -formal coi_slice.v; prep -top top'
+
+../../yosys -q -p "$prep; write_smt2 coi_slice_full.smt2; write_btor coi_slice_full.btor"
+../../yosys -q -p "$prep; select top/cnt_ok; write_smt2 -coi-map coi_slice.map coi_slice.smt2; write_btor -coi coi_slice.btor"
+
+test $(grep -c "^; yosys-smt2-assert " coi_slice_full.smt2) -eq 2
+test $(grep -c "^; yosys-smt2-register " coi_slice_full.smt2) -eq 2
+test $(grep -c "^; yosys-smt2-assert " coi_slice.smt2) -eq 1
+test $(grep -c "^; yosys-smt2-register " coi_slice.smt2) -eq 1
+grep -q "^; yosys-smt2-register cnt 4$" coi_slice.smt2
+
+test $(grep -c "^[0-9]* bad " coi_slice_full.btor) -eq 2
+test $(grep -c "^[0-9]* bad " coi_slice.btor) -eq 1
+test $(grep -c "^[0-9]* state " coi_slice.btor) -lt $(grep -c "^[0-9]* state " coi_slice_full.btor)
+
+grep -q '^keep cell \\cnt_ok \$assert' coi_slice.map
+grep -q '^drop cell \\data_ok \$assert' coi_slice.map
+grep -q '^drop cell .* \$dff' coi_slice.map
+
+rm -f coi_slice_full.smt2 coi_slice_full.btor coi_slice.smt2 coi_slice.btor coi_slice.map
@@ -0,0 +1,13 @@
+module top(input clk, input [7:0] din, output reg [3:0] cnt, output reg [7:0] data);
+	initial cnt = 0;
+
+	always @(posedge clk)
+		cnt <= cnt == 9 ? 0 : cnt + 1;
+
+	// unrelated to cnt_ok, dropped by -coi when only cnt_ok is selected
+	always @(posedge clk)
+		data <= data + din;
+
+	cnt_ok: assert property (cnt <= 9);
+	data_ok: assert property (data != 8'hff);
+endmodule
@@ -0,0 +1,20 @@
+#!/bin/bash
+# module-local passes on worker threads: the log and the resulting design of
+# yosys -j 4 must be the same as those of the serial run
+set -ex
+
+script="read_verilog module_pass_threads.v; hierarchy -top top; proc; opt_clean; wreduce; simplemap; write_ilang"
+
+../../yosys -ql module_pass_threads_1.log -p "$script module_pass_threads_1.il"
+../../yosys -j 4 -ql module_pass_threads_4.log -p "$script module_pass_threads_4.il"
+
+# the last lines of the log contain timing information
+for j in 1 4; do
+	sed -e '/^End of script/,$d' -e "s/module_pass_threads_$j\.il/module_pass_threads.il/" module_pass_threads_$j.log > module_pass_threads_$j.txt
+done
+grep -q "Executing WREDUCE pass" module_pass_threads_1.txt
+grep -q "Executing SIMPLEMAP pass" module_pass_threads_1.txt
+cmp module_pass_threads_1.txt module_pass_threads_4.txt
+cmp module_pass_threads_1.il module_pass_threads_4.il
+
+rm -f module_pass_threads_{1,4}.{log,txt,il}
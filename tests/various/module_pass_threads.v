@@ -0,0 +1,28 @@
+module add8(input [7:0] a, b, output [15:0] y);
+	assign y = a + b;
+endmodule
+
+module mul4(input [3:0] a, b, output [15:0] y);
+	assign y = a * b;
+endmodule
+
+module cmp(input [7:0] a, input [3:0] b, output [7:0] y);
+	assign y = {7'b0, a < b};
+endmodule
+
+module shift(input [7:0] a, input [2:0] s, output [15:0] y);
+	assign y = a << s;
+endmodule
+
+module mix(input [15:0] a, input [3:0] b, output [15:0] x, y);
+	assign x = (a & 16'h00ff) | b;
+	assign y = a[7:0] - b;
+endmodule
+
+module top(input [7:0] a, b, output [15:0] y0, y1, y2, y3, y4);
+	add8 u0 (.a(a), .b(b), .y(y0));
+	mul4 u1 (.a(a[3:0]), .b(b[3:0]), .y(y1));
+	cmp u2 (.a(a), .b(b[3:0]), .y(y2));
+	shift u3 (.a(a), .s(b[2:0]), .y(y3));
+	mix u4 (.a({a, b}), .b(a[3:0]), .x(y4));
+endmodule
@@ -0,0 +1,16 @@
+#!/bin/bash
+# sim_state builds its values in a hash-consed AIG: commuted operands give
+# the same node, and a & ~a and a | ~a fold to constants
+set -ex
+
+echo "aig -n 1 -summary sim_state_aig.sum" > sim_state_aig.scn
+
+../../yosys -ql sim_state_aig.log -p "read_verilog sim_state_aig.v; sim_state -scenarios sim_state_aig.scn"
+y=$(sed -n 's/^top\.y //p' sim_state_aig.sum)
+z=$(sed -n 's/^top\.z //p' sim_state_aig.sum)
+test -n "$y"
+test "$y" = "$z"
+grep -qx 'top\.w #x0' sim_state_aig.sum
+grep -qx 'top\.v #xf' sim_state_aig.sum
+
+rm -f sim_state_aig.scn sim_state_aig.sum sim_state_aig.log
@@ -0,0 +1,6 @@
+module top(input [3:0] a, b, output [3:0] y, z, w, v);
+	assign y = a & b;
+	assign z = b & a;
+	assign w = a & ~a;
+	assign v = a | ~a;
+endmodule
@@ -0,0 +1,16 @@
+#!/bin/bash
+# sim_state -equiv: r only changes structurally and keeps its literal. q is
+# computed from r and a counter, so it really changes and must be built from
+# the restored literal of r, without any trace of secret
+set -ex
+
+echo "equiv -n 4 -clock clk -summary sim_state_equiv.sum" > sim_state_equiv.scn
+
+../../yosys -ql sim_state_equiv.log -p "read_verilog sim_state_equiv.v; proc; sim_state -equiv -scenarios sim_state_equiv.scn"
+grep -q "^top\.r " sim_state_equiv.sum
+grep -q "^top\.q " sim_state_equiv.sum
+if grep -E "^top\.(r|q) .*secret" sim_state_equiv.sum; then
+	exit 1
+fi
+
+rm -f sim_state_equiv.scn sim_state_equiv.sum sim_state_equiv.log
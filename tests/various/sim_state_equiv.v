@@ -0,0 +1,9 @@
+module top(input clk, input [3:0] secret, output reg [3:0] r, q, cnt);
+	initial cnt = 0;
+
+	always @(posedge clk) begin
+		r <= (r & secret) | (r & ~secret);
+		cnt <= cnt + 4'd1;
+		q <= r ^ cnt;
+	end
+endmodule
@@ -0,0 +1,11 @@
+#!/bin/bash
+# sim_state on a $mem with a symbolic write enable on two clocked write ports:
+# each port must write once per clock edge, not again on every settle pass
+set -ex
+
+echo "mem -n 3 -clock clk -summary sim_state_mem_wren.sum" > sim_state_mem_wren.scn
+
+../../yosys -ql sim_state_mem_wren.log -p "read_verilog sim_state_mem_wren.v; proc; memory -nomap; sim_state -scenarios sim_state_mem_wren.scn"
+grep -q "^top\.q " sim_state_mem_wren.sum
+
+rm -f sim_state_mem_wren.scn sim_state_mem_wren.sum sim_state_mem_wren.log
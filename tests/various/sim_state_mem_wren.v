@@ -0,0 +1,8 @@
+module top(input clk, we0, we1, input [1:0] wa, ra, input [3:0] d0, d1, output [3:0] q);
+	reg [3:0] mem [0:3];
+	always @(posedge clk) begin
+		if (we0) mem[1] <= d0;
+		if (we1) mem[wa] <= d1;
+	end
+	assign q = mem[ra];
+endmodule
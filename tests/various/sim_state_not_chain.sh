@@ -0,0 +1,15 @@
+#!/bin/bash
+# sim_state on $add -> $not -> $add with symbolic inputs: the complemented
+# bits of the first sum must stay complemented when the second $add lowers
+# them back to a word
+set -ex
+
+echo "chain -n 1 -summary sim_state_not_chain.sum" > sim_state_not_chain.scn
+
+../../yosys -ql sim_state_not_chain.log -p "read_verilog sim_state_not_chain.v; sim_state -scenarios sim_state_not_chain.scn"
+grep -q "^top\.y .*bvnot" sim_state_not_chain.sum
+if grep -q "^top\.z .*bvnot" sim_state_not_chain.sum; then
+	exit 1
+fi
+
+rm -f sim_state_not_chain.scn sim_state_not_chain.sum sim_state_not_chain.log
@@ -0,0 +1,6 @@
+module top(input [7:0] a, b, c, output [7:0] y, z);
+	wire [7:0] s = a + b;
+	wire [7:0] t = ~s;
+	assign y = t + c;
+	assign z = s + c;
+endmodule
@@ -0,0 +1,29 @@
+#!/bin/bash
+# sim_state -scenarios: every scenario starts from the same initial state, and
+# the merged summary is the same with one job and with one job per scenario
+set -ex
+
+cat > sim_state_scenarios.scn <<'EOT'
+# name options
+one -set inc 4'd1
+two -set inc 4'd2
+free -n 6
+EOT
+
+prep="read_verilog sim_state_scenarios.v; proc"
+simopts="-clock clk -reset rst -n 4 -scenarios sim_state_scenarios.scn"
+
+../../yosys -ql sim_state_scenarios_1.log -p "$prep; sim_state $simopts -j 1 -summary sim_state_scenarios_1.tsv"
+../../yosys -ql sim_state_scenarios_3.log -p "$prep; sim_state $simopts -j 3 -summary sim_state_scenarios_3.tsv"
+cmp sim_state_scenarios_1.tsv sim_state_scenarios_3.tsv
+
+head -n 1 sim_state_scenarios_1.tsv | grep -qx "$(printf 'net\tone\ttwo\tfree')"
+for log in sim_state_scenarios_{1,3}.log; do
+	grep -q "^Scenario one: simulated 4 cycles\.$" $log
+	grep -q "^Scenario two: simulated 4 cycles\.$" $log
+	grep -q "^Scenario free: simulated 6 cycles\.$" $log
+	grep -q "^  top\.cnt: 3 distinct values$" $log
+	grep -q "^  top\.rst = " $log
+done
+
+rm -f sim_state_scenarios.scn sim_state_scenarios_{1,3}.{log,tsv}
@@ -0,0 +1,7 @@
+module top(input clk, rst, input [3:0] inc, output reg [3:0] cnt);
+	always @(posedge clk)
+		if (rst)
+			cnt <= 0;
+		else
+			cnt <= cnt + inc;
+endmodule
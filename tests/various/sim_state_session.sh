@@ -0,0 +1,14 @@
+#!/bin/bash
+# every sim_state run has its own symbolic session: the fresh symbols of the
+# x constants are numbered from zero again in the second run of the same
+# process, so both runs give the same summary
+set -ex
+
+echo "first -n 3 -clock clk -summary sim_state_session_1.sum" > sim_state_session_1.scn
+echo "second -n 3 -clock clk -summary sim_state_session_2.sum" > sim_state_session_2.scn
+
+../../yosys -ql sim_state_session.log -p "read_verilog sim_state_session.v; proc; sim_state -scenarios sim_state_session_1.scn; sim_state -scenarios sim_state_session_2.scn"
+grep -q "^top\.q .*auto#" sim_state_session_1.sum
+cmp sim_state_session_1.sum sim_state_session_2.sum
+
+rm -f sim_state_session_{1,2}.{scn,sum} sim_state_session.log
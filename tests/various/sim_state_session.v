@@ -0,0 +1,4 @@
+module top(input clk, sel, input [3:0] a, output reg [3:0] q);
+	always @(posedge clk)
+		q <= sel ? a : 4'bx;
+endmodule
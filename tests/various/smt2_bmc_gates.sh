@@ -0,0 +1,14 @@
+#!/bin/bash
+# smt2_bmc on a netlist of $_DFF_P_ and $_DFF_N_ gates
+set -ex
+
+prep='prep -top top; techmap; opt_clean; select -assert-any t:$_DFF_P_; select -assert-any t:$_DFF_N_'
+
+../../yosys -ql smt2_bmc_gates_pass.log -p "read_verilog -formal smt2_bmc_gates.v; $prep; smt2_bmc -t 8"
+grep -q "Status: PASSED (8 steps)" smt2_bmc_gates_pass.log
+
+../../yosys -ql smt2_bmc_gates_fail.log -p "read_verilog -formal -DFAIL smt2_bmc_gates.v; $prep; smt2_bmc -t 8"
+grep -q "Assert failed in top" smt2_bmc_gates_fail.log
+grep -q "Status: FAILED (step 5)" smt2_bmc_gates_fail.log
+
+rm -f smt2_bmc_gates_pass.log smt2_bmc_gates_fail.log
@@ -0,0 +1,17 @@
+module top(input clk, output reg [3:0] cnt, output reg [3:0] even);
+	initial cnt = 0;
+	initial even = 0;
+
+	always @(posedge clk)
+		cnt <= cnt + 1;
+
+	always @(negedge clk)
+		even <= even + 2;
+
+	always @* begin
+		assert (!even[0]);
+`ifdef FAIL
+		assert (cnt != 5);
+`endif
+	end
+endmodule
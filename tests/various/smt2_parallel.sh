@@ -0,0 +1,11 @@
+#!/bin/bash
+# write_smt2 -j emits the modules in worker processes, the output must be
+# the same as the serial output byte for byte
+set -ex
+
+for opts in "" "-stbv" "-stdt" "-share -wires"; do
+	../../yosys -q -p "read_verilog -formal smt2_parallel.v; hierarchy -top top; proc; opt_clean; write_smt2 $opts smt2_parallel_serial.smt2; write_smt2 -j 4 $opts smt2_parallel_j4.smt2"
+	cmp smt2_parallel_serial.smt2 smt2_parallel_j4.smt2
+done
+
+rm -f smt2_parallel_serial.smt2 smt2_parallel_j4.smt2
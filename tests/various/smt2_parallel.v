@@ -0,0 +1,21 @@
+module acc(input clk, input [3:0] a, output reg [3:0] q);
+	initial q = 0;
+	always @(posedge clk)
+		q <= q + a;
+endmodule
+
+module shift(input clk, input [3:0] a, output reg [3:0] q);
+	always @(posedge clk)
+		q <= {q[2:0], ^a};
+endmodule
+
+module pair(input clk, input [3:0] a, output [3:0] x, y);
+	acc u_acc (.clk(clk), .a(a), .q(x));
+	shift u_shift (.clk(clk), .a(x), .q(y));
+endmodule
+
+module top(input clk, input [3:0] a, b, output [3:0] x, y, z);
+	pair u0 (.clk(clk), .a(a), .x(x), .y(y));
+	acc u1 (.clk(clk), .a(b), .q(z));
+	always @* assert (z != 4'hf || x != 4'hf);
+endmodule
@@ -0,0 +1,21 @@
+#!/bin/bash
+# write_smt2 -share output must be accepted by yosys-smtbmc and keep the
+# results of the plain output
+set -ex
+
+prep='hierarchy -top top; proc; opt_clean'
+
+../../yosys -q -p "read_verilog -formal smt2_share.v; $prep; write_smt2 smt2_share_plain.smt2; write_smt2 -share smt2_share.smt2"
+test $(grep -c bvadd smt2_share_plain.smt2) -eq 2
+test $(grep -c bvadd smt2_share.smt2) -eq 1
+../../yosys-smtbmc -s z3 -t 8 smt2_share_plain.smt2 > smt2_share_plain.log
+../../yosys-smtbmc -s z3 -t 8 smt2_share.smt2 > smt2_share.log
+grep -q "Status: PASSED" smt2_share_plain.log
+grep -q "Status: PASSED" smt2_share.log
+
+../../yosys -q -p "read_verilog -formal -DFAIL smt2_share.v; $prep; write_smt2 -share smt2_share_fail.smt2"
+../../yosys-smtbmc -s z3 -t 8 smt2_share_fail.smt2 > smt2_share_fail.log || true
+grep -q "Status: FAILED" smt2_share_fail.log
+
+rm -f smt2_share_plain.smt2 smt2_share.smt2 smt2_share_fail.smt2
+rm -f smt2_share_plain.log smt2_share.log smt2_share_fail.log
@@ -0,0 +1,18 @@
+module top(input clk, input [7:0] a, b, output reg [7:0] x, y);
+	initial x = 0;
+	initial y = 0;
+
+	// two cells computing a + b, -share emits them once
+	always @(posedge clk) begin
+		x <= (a + b) ^ x;
+		y <= (a + b) ^ y;
+	end
+
+	always @* begin
+`ifdef FAIL
+		assert (x != 8'h3c);
+`else
+		assert (x == y);
+`endif
+	end
+endmodule
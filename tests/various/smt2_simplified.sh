@@ -0,0 +1,18 @@
+#!/bin/bash
+# write_smt2 -encoding simplified takes the next state of the registers from
+# the symbolic simulator, the output must keep the results of the plain output
+set -ex
+
+prep='hierarchy -top top; proc; opt_clean'
+
+../../yosys -ql smt2_simplified.ylog -p "read_verilog -formal smt2_simplified.v; $prep; write_smt2 -encoding simplified smt2_simplified.smt2"
+grep -q "Took the next state of 2 \$dff cells in module top from the symbolic simulator" smt2_simplified.ylog
+../../yosys-smtbmc -s z3 -t 8 smt2_simplified.smt2 > smt2_simplified.log
+grep -q "Status: PASSED" smt2_simplified.log
+
+../../yosys -q -p "read_verilog -formal -DFAIL smt2_simplified.v; $prep; write_smt2 -encoding simplified smt2_simplified_fail.smt2"
+../../yosys-smtbmc -s z3 -t 8 smt2_simplified_fail.smt2 > smt2_simplified_fail.log || true
+grep -q "Status: FAILED" smt2_simplified_fail.log
+
+rm -f smt2_simplified.ylog smt2_simplified.smt2 smt2_simplified_fail.smt2
+rm -f smt2_simplified.log smt2_simplified_fail.log
@@ -0,0 +1,19 @@
+module top(input clk, en, output reg [7:0] cnt, dbl);
+	initial cnt = 0;
+	initial dbl = 0;
+
+	wire [7:0] nxt = en ? cnt + 8'd1 : cnt;
+
+	always @(posedge clk) begin
+		cnt <= nxt;
+		dbl <= nxt + nxt;
+	end
+
+	always @* begin
+`ifdef FAIL
+		assert (cnt != 8'd5);
+`else
+		assert (dbl == cnt + cnt);
+`endif
+	end
+endmodule
@@ -0,0 +1,30 @@
+#!/bin/bash
+# smt2_z3 builds the relations of a module once, reuses them while the module
+# is unchanged and rebuilds them after a change
+set -ex
+
+../../yosys -ql smt2_z3.log -p "read_verilog -formal smt2_z3.v; proc; opt_clean
+smt2_z3 -check -dump smt2_z3.smt2
+smt2_z3 -check
+setattr -set init 4'd5 w:cnt
+smt2_z3 -check"
+
+grep -E "^(Built|Reusing cached) relations of module top|^  assertions of top" smt2_z3.log | sed 's/:.*//' > smt2_z3.out
+cat > smt2_z3.exp <<'EOT'
+Built relations of module top
+  assertions of top hold in the initial state.
+Reusing cached relations of module top
+  assertions of top hold in the initial state.
+Built relations of module top
+  assertions of top can fail in the initial state.
+EOT
+diff smt2_z3.exp smt2_z3.out
+
+grep -q "^; yosys-smt2-module top$" smt2_z3.smt2
+grep -q "^(declare-const |top cnt| (_ BitVec 4))$" smt2_z3.smt2
+grep -q "^(declare-const |top cnt'| (_ BitVec 4))$" smt2_z3.smt2
+for rel in t i a u; do
+	grep -q "^(define-fun |top_$rel| () Bool$" smt2_z3.smt2
+done
+
+rm -f smt2_z3.log smt2_z3.out smt2_z3.exp smt2_z3.smt2
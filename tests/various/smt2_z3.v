@@ -0,0 +1,9 @@
+module top(input clk, output reg [3:0] cnt);
+	initial cnt = 0;
+
+	always @(posedge clk)
+		cnt <= cnt + 4'd1;
+
+	always @*
+		assert (cnt != 4'd5);
+endmodule
@@ -0,0 +1,38 @@
+#!/bin/bash
+# stat -alloc: the live counts of the wire and cell pools match the object
+# counts of each module, the total adds up the modules, and removing a cell
+# frees its slot without giving back the slab
+set -ex
+
+../../yosys -ql stat_alloc.log -p 'read_verilog stat_alloc.v; hierarchy -top top; proc; opt_clean
+	tee -q -o stat_alloc_1.txt stat -alloc; delete top/t:$add; tee -q -o stat_alloc_2.txt stat -alloc top'
+
+# prints "<module> <wires> <live wires> <cells> <live cells>" per module and
+# "total <live wires> <live cells>" for the allocation total
+stat_alloc_table() {
+	awk '/^=== /{m=$2} /Number of wires:/{nw[m]=$4} /Number of cells:/{nc[m]=$4}
+		/^ +Wires +[0-9]+ live/{lw[m]=$2} /^ +Cells +[0-9]+ live/{lc[m]=$2}
+		END{for (m in lw) if (m == "allocation") print "total", lw[m], lc[m]; else print m, nw[m], lw[m], nc[m], lc[m]}' "$1" | LC_ALL=C sort
+}
+stat_alloc_table stat_alloc_1.txt > stat_alloc_1.got
+
+grep -q '^child ' stat_alloc_1.got
+grep -q '^top ' stat_alloc_1.got
+awk '$1 != "total" && ($2 != $3 || $4 != $5) {exit 1}' stat_alloc_1.got
+awk '$1 == "total" {tw=$2; tc=$3} $1 != "total" {w+=$3; c+=$5} END{exit !(tw == w && tc == c && tw > 0)}' stat_alloc_1.got
+grep -q '=== allocation total ===' stat_alloc_1.txt
+test $(grep -c '=== allocation total ===' stat_alloc_2.txt) -eq 0
+
+# the deleted $add leaves one live cell less, but the same slots and the same
+# number of allocations
+top_cells() {
+	sed -n '/^=== top ===/,/^===/p' "$1" | grep -E '^ +Cells +[0-9]+ live'
+}
+set -- $(top_cells stat_alloc_1.txt)
+live1=$2 rest1="${*:4}"
+set -- $(top_cells stat_alloc_2.txt)
+live2=$2 rest2="${*:4}"
+test $live2 -eq $((live1 - 1))
+test "$rest1" = "$rest2"
+
+rm -f stat_alloc.log stat_alloc_{1,2}.txt stat_alloc_1.got
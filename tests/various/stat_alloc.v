@@ -0,0 +1,11 @@
+module child(input [3:0] a, b, output [3:0] y);
+	assign y = a + b;
+endmodule
+
+module top(input clk, input [3:0] a, b, c, output reg [3:0] q);
+	wire [3:0] s, t;
+	child u0 (.a(a), .b(b), .y(s));
+	child u1 (.a(s), .b(c), .y(t));
+	always @(posedge clk)
+		q <= t + c;
+endmodule
@@ -0,0 +1,19 @@
+#!/bin/bash
+# taint -first_cycle on a two-stage pipeline: the registers get the taint of
+# a one cycle after their input, the combinational c in the same cycle as r1
+# and u, which only depends on b, is never tainted
+set -ex
+
+../../yosys -q -p 'read_verilog taint_first_cycle.v; proc; taint -taint a -cycles 4 -first_cycle taint_first_cycle.out'
+grep -E '^[a-z0-9]+\[[0-9]+\] [0-9]+$' taint_first_cycle.out | sort > taint_first_cycle.got
+cat > taint_first_cycle.exp <<'EOT'
+c[0] 1
+c[1] 1
+r1[0] 1
+r1[1] 1
+r2[0] 2
+r2[1] 2
+EOT
+diff taint_first_cycle.exp taint_first_cycle.got
+
+rm -f taint_first_cycle.out taint_first_cycle.got taint_first_cycle.exp
@@ -0,0 +1,8 @@
+module top(input clk, input [1:0] a, b, output reg [1:0] r1, r2, u, output [1:0] c);
+	always @(posedge clk) begin
+		r1 <= a;
+		r2 <= r1;
+		u <= b;
+	end
+	assign c = r1 & b;
+endmodule
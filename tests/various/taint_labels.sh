@@ -0,0 +1,17 @@
+#!/bin/bash
+# taint with two sources: every wire lists the labels reaching it with the
+# first cycle of each label on its own, c gets b in cycle 0 and a only in
+# cycle 1
+set -ex
+
+../../yosys -q -p 'read_verilog taint_first_cycle.v; proc; taint -taint a -taint b -cycles 4 taint_labels.out'
+grep '^Labels: ' taint_labels.out | sort > taint_labels.got
+cat > taint_labels.exp <<'EOT'
+Labels: c a@1 b@0
+Labels: r1 a@1
+Labels: r2 a@2
+Labels: u b@1
+EOT
+diff taint_labels.exp taint_labels.got
+
+rm -f taint_labels.out taint_labels.got taint_labels.exp
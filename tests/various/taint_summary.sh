@@ -0,0 +1,13 @@
+#!/bin/bash
+# taint -summary and taint_query round trip. log_id() keeps the backslash of
+# \$foo but strips it from \Z, the summary index must still find both.
+set -ex
+
+../../yosys -ql taint_summary.log -p 'read_verilog taint_summary.v; proc; taint -taint s -cycles 4 -summary taint_summary.sum taint_summary.out; taint_query taint_summary.sum Z \$foo; taint_query -stats taint_summary.sum'
+grep -qx 'Z\[0\] 1 s@1' taint_summary.log
+grep -qx 'Z\[1\] 1 s@1' taint_summary.log
+grep -qxF '\$foo[0] 0 s@0' taint_summary.log
+grep -qxF '\$foo[1] 0 s@0' taint_summary.log
+grep -qx 'cycles [0-9]*, labels 1, wires 2, tainted bits 4' taint_summary.log
+
+rm -f taint_summary.log taint_summary.sum taint_summary.out
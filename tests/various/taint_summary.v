@@ -0,0 +1,5 @@
+module top(input clk, input [1:0] s, output reg [1:0] Z);
+	wire [1:0] \$foo = s ^ 2'b01;
+	always @(posedge clk)
+		Z <= \$foo ;
+endmodule
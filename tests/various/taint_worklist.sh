@@ -0,0 +1,23 @@
+#!/bin/bash
+# the worklist only visits the fanout of a: acc feeds back into its own adder
+# without adding new taint, cnt and the upper bits of z stay untainted
+set -ex
+
+../../yosys -ql taint_worklist.log -p 'read_verilog taint_worklist.v; proc; taint -taint a -cycles 8 -first_cycle taint_worklist.out'
+grep -E '^[a-z0-9]+\[[0-9]+\] [0-9]+$' taint_worklist.out | LC_ALL=C sort > taint_worklist.got
+cat > taint_worklist.exp <<'EOT'
+acc[0] 1
+acc[1] 1
+acc[2] 1
+acc[3] 1
+z[0] 1
+z[1] 1
+EOT
+diff taint_worklist.exp taint_worklist.got
+grep -qx 'Labels: acc a@1' taint_worklist.out
+grep -qx 'Labels: z a@1' taint_worklist.out
+test $(grep -c '^Labels: cnt' taint_worklist.out) -eq 0
+# the fixpoint is reached long before the cycle limit
+grep -q 'used cycles=2$' taint_worklist.log
+
+rm -f taint_worklist.log taint_worklist.out taint_worklist.got taint_worklist.exp
@@ -0,0 +1,7 @@
+module top(input clk, input [3:0] a, b, output reg [3:0] acc, cnt, output [3:0] z);
+	always @(posedge clk) begin
+		acc <= acc + a;
+		cnt <= cnt + b;
+	end
+	assign z = {cnt[3:2], acc[1:0]};
+endmodule